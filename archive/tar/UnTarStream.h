@@ -143,9 +143,6 @@ namespace K {
 			unsigned int padding = TarHelper::getPadding(sizeof(TarEntryHeader), TarHelper::BLOCKSIZE);
 			is->skip(padding);
 
-			std::cout << "read: " << read << std::endl;
-			std::cout << "padding: " << padding << std::endl;
-
 			// check for an empty chunk -> EOF
 			static const char EMPTY_MAGIC[6] = {0};
 			if ( memcmp( EMPTY_MAGIC, curHeader.magic, 6 ) == 0 ) {
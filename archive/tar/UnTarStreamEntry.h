@@ -55,14 +55,29 @@ namespace K {
 
 		virtual ssize_t read(uint8_t* data, const size_t len) override {
 
+			// anything to read?
+			if (remaining == 0) {return ERR_FAILED;}
+
 			size_t max = (len < remaining) ? (len) : (remaining);
-			size_t numRead = is->read(data, max);
-			remaining -= numRead;
-			std::cout << "read " << numRead << " bytes. remaining is " << remaining << std::endl;
+			ssize_t numRead = is->read(data, max);
+			if (numRead > 0) {remaining -= numRead;}
 			return numRead;
 
 		}
 
+		virtual ssize_t borrow(const uint8_t*& data, const size_t len) override {
+
+			// anything to read?
+			if (remaining == 0) {return ERR_FAILED;}
+
+			// borrow from the underlying stream, without exceeding the entry
+			size_t max = (len < remaining) ? (len) : (remaining);
+			ssize_t numBorrowed = is->borrow(data, max);
+			if (numBorrowed > 0) {remaining -= numBorrowed;}
+			return numBorrowed;
+
+		}
+
 		virtual void skip(const size_t n) override {
 
 			// check whether there are enough bytes remaining to skip
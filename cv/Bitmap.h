@@ -1,38 +1,268 @@
 #ifndef BITMAP_H
 #define BITMAP_H
 
-#include "DataMatrix.h"
 #include "../geo/Point2.h"
+#include "../Assertions.h"
 #include "ImageChannel.h"
 
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
 namespace K {
 
-	/** binary image (yes/no) */
-	class Bitmap : public DataMatrix<bool> {
+	/**
+	 * binary image (yes/no).
+	 *
+	 * the pixels are packed into 64 bit words, each row starts with a new word.
+	 * pixel x of a row is bit (x % 64) of word (x / 64). the unused bits of each row's
+	 * last word are always 0, thus all word-wise operations can ignore the padding.
+	 */
+	class Bitmap {
+
+	public:
+
+		typedef uint64_t Word;
+
+		/** number of pixels per word */
+		static constexpr int BITS = 64;
+
+	private:
+
+		/** the packed pixels */
+		std::vector<Word> words;
+
+		/** the bitmap's size */
+		int width;
+		int height;
+
+		/** the number of words per row */
+		int stride;
 
 	public:
 
-		/** ctor with image size */
-		Bitmap(const int w, const int h) : DataMatrix(w, h) {;}
+		/** empty ctor */
+		Bitmap() : width(0), height(0), stride(0) {;}
+
+		/** ctor with image size. all pixels are cleared */
+		Bitmap(const int w, const int h) : width(w), height(h), stride((w + BITS - 1) / BITS) {
+			_assertTrue(w >= 0 && h >= 0, "invalid size");
+			words.resize((size_t) stride * (size_t) height, 0);
+		}
 
 		/** ctor from image */
-		Bitmap(const ImageChannel& img, const float threshold = 0.5f) : DataMatrix(img.getWidth(), img.getHeight()) {
+		Bitmap(const ImageChannel& img, const float threshold = 0.5f) : Bitmap(img.getWidth(), img.getHeight()) {
+			for (int y = 0; y < height; ++y) {
+				const float* src = img.getData() + (size_t) y * (size_t) width;
+				Word* row = getRow(y);
+				for (int x = 0; x < width; ++x) {
+					if (src[x] > threshold) {row[x / BITS] |= bit(x);}
+				}
+			}
+		}
+
+
+		/** get the bitmap's width */
+		inline int getWidth() const {return width;}
+
+		/** get the bitmap's height */
+		inline int getHeight() const {return height;}
+
+		/** get the number of words per row */
+		inline int getStride() const {return stride;}
+
+		/** get the packed words of the y-th row */
+		inline Word* getRow(const int y) {return words.data() + (size_t) y * (size_t) stride;}
+
+		/** get the packed words of the y-th row */
+		inline const Word* getRow(const int y) const {return words.data() + (size_t) y * (size_t) stride;}
+
+		/** is the given location contained within the bitmap? */
+		inline bool isWithin(const int x, const int y) const {
+			return (x >= 0) && (y >= 0) && (x < width) && (y < height);
+		}
+
+
+		void set(const Point2i p)					{set(p.x, p.y);}
+		void set(const int x, const int y)			{check(x, y); getRow(y)[x / BITS] |= bit(x);}
+
+		void clear(const Point2i p)					{clear(p.x, p.y);}
+		void clear(const int x, const int y)		{check(x, y); getRow(y)[x / BITS] &= ~bit(x);}
+
+		bool isSet(const Point2i p) const			{return isSet(p.x, p.y);}
+		bool isSet(const int x, const int y) const	{check(x, y); return (getRow(y)[x / BITS] & bit(x)) != 0;}
+
+		/** same as isSet() */
+		bool get(const int x, const int y) const	{return isSet(x, y);}
+
+		/** set or clear all pixels */
+		void setAll(const bool v) {
+			std::fill(words.begin(), words.end(), 0);
+			if (v) {*this = ~*this;}
+		}
+
+
+		/** the number of set pixels */
+		size_t count() const {
+			size_t cnt = 0;
+			for (const Word w : words) {cnt += (size_t) __builtin_popcountll(w);}
+			return cnt;
+		}
+
+		/** is any pixel set? */
+		bool any() const {
+			for (const Word w : words) {if (w) {return true;}}
+			return false;
+		}
+
+		/**
+		 * find the first set pixel at or after (x,y), row by row. skips 64 cleared pixels at once.
+		 * @return false if there is none
+		 */
+		bool findNext(int& x, int& y) const {
+			if (stride == 0) {return false;}
+			if (x >= width) {x = 0; ++y;}
+			for (; y < height; ++y, x = 0) {
+				const Word* row = getRow(y);
+				int i = x / BITS;
+				Word w = row[i] & (~Word(0) << (x % BITS));
+				for (;;) {
+					if (w) {x = i * BITS + __builtin_ctzll(w); return true;}
+					if (++i >= stride) {break;}
+					w = row[i];
+				}
+			}
+			return false;
+		}
+
+		/** call func(x, y) for each set pixel, row by row */
+		template <typename Func> void forEachSet(Func&& func) const {
+			for (int y = 0; y < height; ++y) {
+				const Word* row = getRow(y);
+				for (int i = 0; i < stride; ++i) {
+					for (Word w = row[i]; w; w &= w - 1) {func(i * BITS + __builtin_ctzll(w), y);}
+				}
+			}
+		}
+
+
+		Bitmap& operator &= (const Bitmap& o)		{checkSize(o); for (size_t i = 0; i < words.size(); ++i) {words[i] &= o.words[i];} return *this;}
+		Bitmap& operator |= (const Bitmap& o)		{checkSize(o); for (size_t i = 0; i < words.size(); ++i) {words[i] |= o.words[i];} return *this;}
+		Bitmap& operator ^= (const Bitmap& o)		{checkSize(o); for (size_t i = 0; i < words.size(); ++i) {words[i] ^= o.words[i];} return *this;}
+
+		Bitmap operator & (const Bitmap& o) const	{Bitmap res = *this; res &= o; return res;}
+		Bitmap operator | (const Bitmap& o) const	{Bitmap res = *this; res |= o; return res;}
+		Bitmap operator ^ (const Bitmap& o) const	{Bitmap res = *this; res ^= o; return res;}
 
-			auto conv = [&] (const int x, const int y, const float val) {
-				if (val > threshold) {set(x,y);}
-			};
-			img.forEach(conv);
+		/** invert all pixels */
+		Bitmap operator ~ () const {
+			Bitmap res = *this;
+			for (Word& w : res.words) {w = ~w;}
+			res.clearPadding();
+			return res;
+		}
+
+		bool operator == (const Bitmap& o) const {
+			return width == o.width && height == o.height && words == o.words;
+		}
 
+		bool operator != (const Bitmap& o) const {
+			return !(*this == o);
 		}
 
-		void set(const Point2i p)					{DataMatrix::set(p.x, p.y, true);}
-		void set(const int x, const int y)			{DataMatrix::set(x, y, true);}
 
-		void clear(const Point2i p)					{DataMatrix::set(p.x, p.y, false);}
-		void clear(const int x, const int y)		{DataMatrix::set(x, y, false);}
+		/**
+		 * dilate all set pixels using a symmetric structuring element, given by the
+		 * horizontal half-width of each of its rows: halfWidths[r + dy] for dy in [-r:+r].
+		 * e.g. {0,1,0} = 3x3 cross, {1,1,1} = 3x3 square, -1 = no pixel within this row. pixels outside the bitmap are cleared.
+		 * each row is dilated horizontally (64 pixels at once), and the rows are OR-ed
+		 */
+		Bitmap dilate(const std::vector<int>& halfWidths) const {
+
+			_assertTrue(halfWidths.size() % 2 == 1, "the structuring element needs an odd number of rows");
+			const int r = (int) halfWidths.size() / 2;
+			const int maxHW = *std::max_element(halfWidths.begin(), halfWidths.end());
 
-		bool isSet(const Point2i p) const			{return get(p.x, p.y);}
-		bool isSet(const int x, const int y) const	{return get(x, y);}
+			// empty structuring element (all rows -1): nothing is set
+			if (maxHW < 0) {return Bitmap(width, height);}
+
+			// horizontally dilated versions of the bitmap: hor[k] = dilated by k pixels
+			std::vector<Bitmap> hor(maxHW + 1);
+			hor[0] = *this;
+			for (int k = 1; k <= maxHW; ++k) {hor[k] = hor[k-1].dilateRows();}
+
+			Bitmap res(width, height);
+			for (int y = 0; y < height; ++y) {
+				Word* dst = res.getRow(y);
+				for (int dy = -r; dy <= r; ++dy) {
+					const int sy = y + dy;
+					if (sy < 0 || sy >= height || halfWidths[r + dy] < 0) {continue;}
+					const Word* src = hor[halfWidths[r + dy]].getRow(sy);
+					for (int i = 0; i < stride; ++i) {dst[i] |= src[i];}
+				}
+			}
+			return res;
+
+		}
+
+		/**
+		 * erode all set pixels using the given structuring element (see dilate()).
+		 * pixels remain set when all (inner) pixels of the element are set, pixels outside the bitmap are ignored
+		 */
+		Bitmap erode(const std::vector<int>& halfWidths) const {
+			return ~((~*this).dilate(halfWidths));
+		}
+
+
+		/** debug output */
+		friend std::ostream& operator << (std::ostream& out, const Bitmap& b) {
+			for (int y = 0; y < b.getHeight(); ++y) {
+				for (int x = 0; x < b.getWidth(); ++x) {
+					out << b.isSet(x,y) << '\t';
+				}
+				out << std::endl;
+			}
+			return out;
+		}
+
+	private:
+
+		/** the mask for pixel x within its word */
+		static inline Word bit(const int x) {return Word(1) << (x % BITS);}
+
+		inline void check(const int x, const int y) const {
+			_assertBetween(x, 0, width-1, "x out of bounds: " + std::to_string(x));
+			_assertBetween(y, 0, height-1, "y out of bounds: " + std::to_string(y));
+		}
+
+		inline void checkSize(const Bitmap& o) const {
+			_assertTrue(width == o.width && height == o.height, "size mismatch");
+		}
+
+		/** clear the unused bits of each row's last word */
+		void clearPadding() {
+			const int used = width % BITS;
+			if (used == 0) {return;}
+			const Word mask = (Word(1) << used) - 1;
+			for (int y = 0; y < height; ++y) {getRow(y)[stride - 1] &= mask;}
+		}
+
+		/** dilate each row by one pixel to the left and right */
+		Bitmap dilateRows() const {
+			Bitmap res(width, height);
+			for (int y = 0; y < height; ++y) {
+				const Word* src = getRow(y);
+				Word* dst = res.getRow(y);
+				for (int i = 0; i < stride; ++i) {
+					const Word prev = (i > 0) ? (src[i-1] >> (BITS-1)) : (0);				// pixel x-1 of the word's first pixel
+					const Word next = (i < stride-1) ? (src[i+1] << (BITS-1)) : (0);		// pixel x+1 of the word's last pixel
+					dst[i] = src[i] | (src[i] << 1) | (src[i] >> 1) | prev | next;
+				}
+			}
+			res.clearPadding();
+			return res;
+		}
 
 	};
 
@@ -3,6 +3,8 @@
 
 #include "ImageChannel.h"
 #include "Kernel.h"
+#include "ConvolveSeparable.h"
+#include "TileExecutor.h"
 
 #include <cmath>
 
@@ -22,53 +24,135 @@ namespace K {
 			return dst;
 		}
 
+		/**
+		 * convolve the given image with the provided kernel.
+		 * 1D kernels use ConvolveSeparable, 2D kernels only check the bounds near the edges.
+		 */
+		static void convolve(const ImageChannel& src, ImageChannel& dst, const Kernel& k, const bool normalize = true) {
+			convolve(src, dst, k, normalize, TileExecutor());
+		}
+
+		/** convolve the given image with the provided kernel, using the bands of the given executor */
+		static void convolve(const ImageChannel& src, ImageChannel& dst, const Kernel& k, const bool normalize, const TileExecutor& exec) {
+
+			// 1D kernels
+			if (k.getHeight() == 1) {ConvolveSeparable::convolve(src, dst, k, getIdentity(), normalize, exec); return;}
+			if (k.getWidth() == 1)	{ConvolveSeparable::convolve(src, dst, getIdentity(), k, normalize, exec); return;}
+
+			exec.run(src.getHeight(), k.getHeight() / 2, [&] (const TileBand& b) {
+				convolveRows(src, dst, k, normalize, b.y0, b.y1);
+			});
+
+		}
+
+		/** convolve only the output rows [y0:y1) of dst with the provided (2D) kernel */
+		static void convolveRows(const ImageChannel& src, ImageChannel& dst, const Kernel& k, const bool normalize, const int y0, const int y1) {
+
+			const int w = src.getWidth();
+			const int h = src.getHeight();
+			const int kw = k.getWidth();
+			const int kh = k.getHeight();
+			const int dx = kw / 2;
+			const int dy = kh / 2;
+
+			// the region where the kernel is completely within the image
+			const int ix0 = std::min(dx, w);
+			const int ix1 = std::max(ix0, w - (kw - 1 - dx));
+			const int iy0 = std::min(dy, h);
+			const int iy1 = std::max(iy0, h - (kh - 1 - dy));
+
+			float sum = 0;
+			for (int i = 0; i < kw*kh; ++i) {sum += std::abs(k.getData()[i]);}
+			const bool div = normalize && sum != 0;
+
+			for (int y = y0; y < y1; ++y) {
+
+				// edge rows
+				if (y < iy0 || y >= iy1) {
+					for (int x = 0; x < w; ++x) {dst.set(x, y, getPixel(src, k, x, y, normalize));}
+					continue;
+				}
+
+				// left and right edge
+				for (int x = 0; x < ix0; ++x)	{dst.set(x, y, getPixel(src, k, x, y, normalize));}
+				for (int x = ix1; x < w; ++x)	{dst.set(x, y, getPixel(src, k, x, y, normalize));}
+
+				// interior
+				const float* in = src.getData() + (y - dy) * w - dx;
+				float* out = dst.getData() + y * w;
+				for (int x = ix0; x < ix1; ++x) {
+					float val = 0;
+					const float* kv = k.getData();
+					for (int ky = 0; ky < kh; ++ky) {
+						const float* row = in + ky * w + x;
+						for (int kx = 0; kx < kw; ++kx) {val += (*kv++) * row[kx];}
+					}
+					const float res = (div) ? (val/sum) : (val);
+					_assertNotNAN(res, "detected NaN");
+					out[x] = res;
+				}
+
+			}
+
+		}
+
 		template <typename T> static void convolve(const T& src, T& dst, const Kernel& k, const bool normalize = true) {
 
             #pragma omp parallel for
 			for (int y = 0; y < src.getHeight(); ++y) {
 				for (int x = 0; x < src.getWidth(); ++x) {
+					dst.set(x, y, getPixel(src, k, x, y, normalize));
+				}
+			}
 
-					const int dx = k.getWidth() / 2;
-					const int dy = k.getHeight() / 2;
+		}
 
-					float val = 0;		// the value after convolving all pixels
-					float sum = 0;		// used for normalization (unnormalized kernels / edges [less values ues])
+	private:
 
-					// convolve the current pixel with the kernel
-					for (int y1 = 0; y1 < k.getHeight(); ++y1) {
-						for (int x1 = 0; x1 < k.getWidth(); ++x1) {
+		/** convolve the pixel at (x,y) with the kernel, using only the values within the image */
+		template <typename T> static inline float getPixel(const T& src, const Kernel& k, const int x, const int y, const bool normalize) {
 
-							const int ix = x+x1-dx;
-							const int iy = y+y1-dy;
+			const int dx = k.getWidth() / 2;
+			const int dy = k.getHeight() / 2;
 
-							// skip edges ?
-							if (ix < 0 || ix >= src.getWidth())		{continue;}
-							if (iy < 0 || iy >= src.getHeight())	{continue;}
+			float val = 0;		// the value after convolving all pixels
+			float sum = 0;		// used for normalization (unnormalized kernels / edges [less values ues])
 
-							const float kv = k.get(x1, y1);		// kernel's value
-							const float sv = src.get(ix, iy);	// source image's value
-							val += kv*sv;
-							sum += std::abs(kv);
+			// convolve the current pixel with the kernel
+			for (int y1 = 0; y1 < k.getHeight(); ++y1) {
+				for (int x1 = 0; x1 < k.getWidth(); ++x1) {
 
-						}
-					}
+					const int ix = x+x1-dx;
+					const int iy = y+y1-dy;
 
-					// set the normalized, convolved value
-					const float res = (normalize && sum != 0) ? (val/sum) : (val);
-					_assertNotNAN(res, "detected NaN");
-					dst.set(x, y, res);
+					// skip edges ?
+					if (ix < 0 || ix >= src.getWidth())		{continue;}
+					if (iy < 0 || iy >= src.getHeight())	{continue;}
+
+					const float kv = k.get(x1, y1);		// kernel's value
+					const float sv = src.get(ix, iy);	// source image's value
+					val += kv*sv;
+					sum += std::abs(kv);
 
 				}
 			}
 
-		}
-
+			// the normalized, convolved value
+			const float res = (normalize && sum != 0) ? (val/sum) : (val);
+			_assertNotNAN(res, "detected NaN");
+			return res;
 
+		}
 
+		/** 1x1 kernel not modifying the image */
+		static const Kernel& getIdentity() {
+			static const float one = 1.0f;
+			static const Kernel k(&one, 1, 1);
+			return k;
+		}
 
 	};
 
 }
 
 #endif // K_CV_CONVOLVE_H
-
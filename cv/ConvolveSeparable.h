@@ -0,0 +1,261 @@
+#ifndef K_CV_CONVOLVESEPARABLE_H
+#define K_CV_CONVOLVESEPARABLE_H
+
+#include "ImageChannel.h"
+#include "Kernel.h"
+#include "TileExecutor.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_CV_X86_SIMD
+#endif
+
+namespace K {
+
+	/**
+	 * fast convolution with separable kernels (horizontal x vertical), e.g. gauss.
+	 *
+	 * yields the same results as two subsequent Convolve::run() calls,
+	 * including the re-normalization along the image's edges, but:
+	 *  - both passes are fused: the image is processed in strips of rows,
+	 *    the horizontal pass only fills a small ring-buffer of rows
+	 *    which is consumed by the vertical pass while still in cache
+	 *  - edges are handled separately, the interior loops have no bound checks
+	 *  - the interior loops use AVX2/SSE if available (scalar otherwise)
+	 */
+	class ConvolveSeparable {
+
+	public:
+
+		/**
+		 * convolve the given image with the horizontal kernel kH (w x 1) and the vertical kernel kV (1 x h).
+		 * returns a newly created image.
+		 */
+		static ImageChannel run(const ImageChannel& src, const Kernel& kH, const Kernel& kV, const bool normalize = true) {
+			ImageChannel dst(src.getWidth(), src.getHeight());
+			convolve(src, dst, kH, kV, normalize);
+			return dst;
+		}
+
+		/** convolve src with kH (w x 1) and kV (1 x h) into dst (same size as src, must not be src) */
+		static void convolve(const ImageChannel& src, ImageChannel& dst, const Kernel& kH, const Kernel& kV, const bool normalize = true) {
+
+			// strips of rows, each with its own ring-buffer of horizontally filtered rows
+			const int stripRows = std::max(128, 8 * kV.getHeight());
+			convolve(src, dst, kH, kV, normalize, TileExecutor(0, stripRows));
+
+		}
+
+		/** convolve src with kH (w x 1) and kV (1 x h) into dst, one strip per band of the given executor */
+		static void convolve(const ImageChannel& src, ImageChannel& dst, const Kernel& kH, const Kernel& kV, const bool normalize, const TileExecutor& exec) {
+
+			_assertTrue(src.getWidth() == dst.getWidth() && src.getHeight() == dst.getHeight(), "size mismatch");
+			if (src.getWidth() == 0 || src.getHeight() == 0) {return;}
+
+			exec.run(src.getHeight(), kV.getHeight() / 2, [&] (const TileBand& b) {
+				convolveRows(src, dst, kH, kV, normalize, b.y0, b.y1);
+			});
+
+		}
+
+		/**
+		 * convolve only the output rows [y0:y1) of dst.
+		 * the rows are processed as one strip, using a ring-buffer of horizontally filtered rows
+		 */
+		static void convolveRows(const ImageChannel& src, ImageChannel& dst, const Kernel& kH, const Kernel& kV, const bool normalize, const int y0, const int y1) {
+
+			_assertTrue(kH.getHeight() == 1, "horizontal kernel must be (w x 1)");
+			_assertTrue(kV.getWidth() == 1, "vertical kernel must be (1 x h)");
+			_assertTrue(&src != &dst, "in-place convolution is not supported");
+
+			const int w = src.getWidth();
+			const int h = src.getHeight();
+			const float* k = kV.getData();
+			const int n = kV.getHeight();
+			const int dy = n / 2;
+
+			// the last n horizontally filtered rows (row r is at slot r % n)
+			std::vector<float> ring((size_t) n * (size_t) w);
+			std::vector<const float*> rows(n);
+			std::vector<float> coefs(n);
+			int next = std::max(0, y0 - dy);
+
+			for (int y = y0; y < y1; ++y) {
+
+				// horizontal pass for all rows not yet within the ring
+				const int last = std::min(h - 1, y + (n - 1 - dy));
+				for (; next <= last; ++next) {
+					float* out = ring.data() + (size_t) (next % n) * (size_t) w;
+					convolveRow(src.getData() + (size_t) next * (size_t) w, out, w, kH.getData(), kH.getWidth(), normalize);
+				}
+
+				// vertical pass using all taps within the image
+				int m = 0;
+				float sum = 0;
+				for (int j = 0; j < n; ++j) {
+					const int iy = y + j - dy;
+					if (iy < 0 || iy >= h) {continue;}
+					rows[m] = ring.data() + (size_t) (iy % n) * (size_t) w;
+					coefs[m] = k[j];
+					sum += std::abs(k[j]);
+					++m;
+				}
+				const bool div = normalize && sum != 0;
+
+				float* out = dst.getData() + (size_t) y * (size_t) w;
+				int x = 0;
+#ifdef K_CV_X86_SIMD
+				static const int simd = detectSIMD();
+				if (simd == 2)		{x = colAVX2(rows.data(), coefs.data(), m, out, w, sum, div);}
+				else if (simd == 1)	{x = colSSE(rows.data(), coefs.data(), m, out, w, sum, div);}
+#endif
+				colScalar(rows.data(), coefs.data(), m, out, x, w, sum, div);
+
+			}
+
+		}
+
+		/** convolve one row with the given 1D kernel (edges re-normalized like Convolve::run) */
+		static void convolveRow(const float* in, float* out, const int w, const float* k, const int n, const bool normalize) {
+
+			const int dx = n / 2;
+			const int x0 = std::min(dx, w);
+			const int x1 = std::max(x0, w - (n - 1 - dx));
+
+			// edges: only the taps within the image
+			for (int x = 0; x < x0; ++x)	{out[x] = getEdge(in, w, x, k, n, normalize);}
+			for (int x = x1; x < w; ++x)	{out[x] = getEdge(in, w, x, k, n, normalize);}
+
+			// interior: all taps
+			const float sum = getAbsSum(k, n);
+			const bool div = normalize && sum != 0;
+			int x = x0;
+#ifdef K_CV_X86_SIMD
+			static const int simd = detectSIMD();
+			if (simd == 2)		{x = rowAVX2(in, out, x0, x1, k, n, sum, div);}
+			else if (simd == 1)	{x = rowSSE(in, out, x0, x1, k, n, sum, div);}
+#endif
+			rowScalar(in, out, x, x1, k, n, sum, div);
+
+		}
+
+	private:
+
+		/** sum of the absolute kernel values (same order as Convolve::run) */
+		static inline float getAbsSum(const float* k, const int n) {
+			float sum = 0;
+			for (int i = 0; i < n; ++i) {sum += std::abs(k[i]);}
+			return sum;
+		}
+
+		/** one edge pixel, using only the taps within the image */
+		static inline float getEdge(const float* in, const int w, const int x, const float* k, const int n, const bool normalize) {
+			const int dx = n / 2;
+			float val = 0;
+			float sum = 0;
+			for (int i = 0; i < n; ++i) {
+				const int ix = x + i - dx;
+				if (ix < 0 || ix >= w) {continue;}
+				val += k[i] * in[ix];
+				sum += std::abs(k[i]);
+			}
+			return (normalize && sum != 0) ? (val/sum) : (val);
+		}
+
+		static void rowScalar(const float* in, float* out, const int x0, const int x1, const float* k, const int n, const float sum, const bool div) {
+			const int dx = n / 2;
+			for (int x = x0; x < x1; ++x) {
+				const float* p = in + x - dx;
+				float val = 0;
+				for (int i = 0; i < n; ++i) {val += k[i] * p[i];}
+				out[x] = (div) ? (val/sum) : (val);
+			}
+		}
+
+		static void colScalar(const float* const* rows, const float* k, const int n, float* out, const int x0, const int w, const float sum, const bool div) {
+			for (int x = x0; x < w; ++x) {
+				float val = 0;
+				for (int j = 0; j < n; ++j) {val += k[j] * rows[j][x];}
+				out[x] = (div) ? (val/sum) : (val);
+			}
+		}
+
+#ifdef K_CV_X86_SIMD
+
+		/** 0 = none, 1 = SSE, 2 = AVX2 */
+		static int detectSIMD() {
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2"))	{return 2;}
+			if (__builtin_cpu_supports("sse"))	{return 1;}
+			return 0;
+		}
+
+		/** 4 pixels at once. returns the first unprocessed x */
+		__attribute__((target("sse")))
+		static int rowSSE(const float* in, float* out, int x, const int x1, const float* k, const int n, const float sum, const bool div) {
+			const int dx = n / 2;
+			const __m128 vSum = _mm_set1_ps(sum);
+			for (; x + 4 <= x1; x += 4) {
+				const float* p = in + x - dx;
+				__m128 val = _mm_setzero_ps();
+				for (int i = 0; i < n; ++i) {val = _mm_add_ps(val, _mm_mul_ps(_mm_set1_ps(k[i]), _mm_loadu_ps(p + i)));}
+				if (div) {val = _mm_div_ps(val, vSum);}
+				_mm_storeu_ps(out + x, val);
+			}
+			return x;
+		}
+
+		/** 8 pixels at once. returns the first unprocessed x */
+		__attribute__((target("avx2")))
+		static int rowAVX2(const float* in, float* out, int x, const int x1, const float* k, const int n, const float sum, const bool div) {
+			const int dx = n / 2;
+			const __m256 vSum = _mm256_set1_ps(sum);
+			for (; x + 8 <= x1; x += 8) {
+				const float* p = in + x - dx;
+				__m256 val = _mm256_setzero_ps();
+				for (int i = 0; i < n; ++i) {val = _mm256_add_ps(val, _mm256_mul_ps(_mm256_set1_ps(k[i]), _mm256_loadu_ps(p + i)));}
+				if (div) {val = _mm256_div_ps(val, vSum);}
+				_mm256_storeu_ps(out + x, val);
+			}
+			return x;
+		}
+
+		/** 4 pixels at once. returns the first unprocessed x */
+		__attribute__((target("sse")))
+		static int colSSE(const float* const* rows, const float* k, const int n, float* out, const int w, const float sum, const bool div) {
+			const __m128 vSum = _mm_set1_ps(sum);
+			int x = 0;
+			for (; x + 4 <= w; x += 4) {
+				__m128 val = _mm_setzero_ps();
+				for (int j = 0; j < n; ++j) {val = _mm_add_ps(val, _mm_mul_ps(_mm_set1_ps(k[j]), _mm_loadu_ps(rows[j] + x)));}
+				if (div) {val = _mm_div_ps(val, vSum);}
+				_mm_storeu_ps(out + x, val);
+			}
+			return x;
+		}
+
+		/** 8 pixels at once. returns the first unprocessed x */
+		__attribute__((target("avx2")))
+		static int colAVX2(const float* const* rows, const float* k, const int n, float* out, const int w, const float sum, const bool div) {
+			const __m256 vSum = _mm256_set1_ps(sum);
+			int x = 0;
+			for (; x + 8 <= w; x += 8) {
+				__m256 val = _mm256_setzero_ps();
+				for (int j = 0; j < n; ++j) {val = _mm256_add_ps(val, _mm256_mul_ps(_mm256_set1_ps(k[j]), _mm256_loadu_ps(rows[j] + x)));}
+				if (div) {val = _mm256_div_ps(val, vSum);}
+				_mm256_storeu_ps(out + x, val);
+			}
+			return x;
+		}
+
+#endif
+
+	};
+
+}
+
+#endif // K_CV_CONVOLVESEPARABLE_H
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <functional>
+#include <type_traits>
 
 #include "../Assertions.h"
 
@@ -219,14 +220,14 @@ namespace K {
 
 
 
-		template <typename DM> DM operator + (const DM& o) const {
+		template <typename DM, typename = std::enable_if_t<std::is_base_of<DataMatrix<T>, DM>::value>> DM operator + (const DM& o) const {
 			ensureEqualSize(*this, o);
 			DM copy = *((DM*)this);
 			copy += o;
 			return copy;
 		}
 
-		template <typename DM> DM operator - (const DM& o) const {
+		template <typename DM, typename = std::enable_if_t<std::is_base_of<DataMatrix<T>, DM>::value>> DM operator - (const DM& o) const {
 			ensureEqualSize(*this, o);
 			DM copy = *((DM*)this);
 			copy -= o;
@@ -0,0 +1,151 @@
+#ifndef K_CV_FLOAT16_H
+#define K_CV_FLOAT16_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_CV_X86_SIMD
+#endif
+
+namespace K {
+
+	/**
+	 * IEEE 754 half precision float (storage only).
+	 * conversions from float round to nearest even, like F16C does.
+	 */
+	struct Float16 {
+
+		/** the raw bits */
+		uint16_t bits;
+
+		/** empty ctor (+0) */
+		Float16() : bits(0) {;}
+
+		/** ctor from float */
+		explicit Float16(const float f) : bits(fromFloat(f)) {;}
+
+		/** convert to float */
+		operator float() const {return toFloat(bits);}
+
+		/** create from the raw bits */
+		static Float16 fromBits(const uint16_t bits) {Float16 f; f.bits = bits; return f;}
+
+		/** float -> half bits (round to nearest even) */
+		static uint16_t fromFloat(const float f) {
+
+			uint32_t u; std::memcpy(&u, &f, 4);
+			const uint32_t sign = (u >> 16) & 0x8000;
+			const int exp = (int) ((u >> 23) & 0xFF) - 127 + 15;
+			uint32_t mant = u & 0x7FFFFF;
+
+			// inf/nan (keep nan a nan)
+			if (((u >> 23) & 0xFF) == 0xFF) {return (uint16_t) (sign | 0x7C00 | ((mant) ? (0x200) : (0)));}
+
+			// overflow -> inf
+			if (exp >= 31) {return (uint16_t) (sign | 0x7C00);}
+
+			// subnormal (or zero)
+			if (exp <= 0) {
+				if (exp < -10) {return (uint16_t) sign;}
+				mant |= 0x800000;
+				const int shift = 14 - exp;
+				uint32_t half = mant >> shift;
+				const uint32_t rem = mant & ((1u << shift) - 1);
+				const uint32_t mid = 1u << (shift - 1);
+				if (rem > mid || (rem == mid && (half & 1))) {++half;}
+				return (uint16_t) (sign | half);
+			}
+
+			// normal. a carry of the rounding correctly propagates into the exponent (and inf)
+			uint32_t half = ((uint32_t) exp << 10) | (mant >> 13);
+			const uint32_t rem = mant & 0x1FFF;
+			if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) {++half;}
+			return (uint16_t) (sign | half);
+
+		}
+
+		/** half bits -> float (exact) */
+		static float toFloat(const uint16_t h) {
+
+			const uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+			const uint32_t exp = (h >> 10) & 0x1F;
+			const uint32_t mant = h & 0x3FF;
+
+			uint32_t u;
+			if (exp == 0) {
+				const float f = (float) mant * (1.0f / 16777216.0f);		// mant * 2^-24
+				return (sign) ? (-f) : (f);
+			} else if (exp == 31) {
+				u = sign | 0x7F800000 | (mant << 13);
+			} else {
+				u = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+			}
+
+			float f; std::memcpy(&f, &u, 4);
+			return f;
+
+		}
+
+		/** convert num halfs to floats */
+		static void toFloat(const Float16* src, float* dst, const size_t num) {
+			size_t i = 0;
+#ifdef K_CV_X86_SIMD
+			static const bool f16c = hasF16C();
+			if (f16c) {i = toFloatF16C(src, dst, num);}
+#endif
+			for (; i < num; ++i) {dst[i] = toFloat(src[i].bits);}
+		}
+
+		/** convert num floats to halfs */
+		static void fromFloat(const float* src, Float16* dst, const size_t num) {
+			size_t i = 0;
+#ifdef K_CV_X86_SIMD
+			static const bool f16c = hasF16C();
+			if (f16c) {i = fromFloatF16C(src, dst, num);}
+#endif
+			for (; i < num; ++i) {dst[i].bits = fromFloat(src[i]);}
+		}
+
+	private:
+
+#ifdef K_CV_X86_SIMD
+
+		static bool hasF16C() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+		}
+
+		/** 8 values at once. returns the first unprocessed index */
+		__attribute__((target("avx,f16c")))
+		static size_t toFloatF16C(const Float16* src, float* dst, const size_t num) {
+			size_t i = 0;
+			for (; i + 8 <= num; i += 8) {
+				const __m128i h = _mm_loadu_si128((const __m128i*) (src + i));
+				_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+			}
+			return i;
+		}
+
+		/** 8 values at once. returns the first unprocessed index */
+		__attribute__((target("avx,f16c")))
+		static size_t fromFloatF16C(const float* src, Float16* dst, const size_t num) {
+			size_t i = 0;
+			for (; i + 8 <= num; i += 8) {
+				const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128((__m128i*) (dst + i), h);
+			}
+			return i;
+		}
+
+#endif
+
+	};
+
+	static_assert(sizeof(Float16) == 2, "Float16 must be 2 bytes");
+
+}
+
+#endif // K_CV_FLOAT16_H
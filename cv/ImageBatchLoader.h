@@ -0,0 +1,149 @@
+#ifndef K_CV_IMAGEBATCHLOADER_H
+#define K_CV_IMAGEBATCHLOADER_H
+
+#include "ImageDecoder.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace K {
+
+	/**
+	 * decode a list of image files on several threads and hand them to
+	 * the caller in the list's order.
+	 *
+	 * memory is bounded: the images are decoded into a fixed ring of
+	 * (depth) slots, and a thread only starts with the next file once
+	 * its slot has been consumed. each slot's image and each thread's
+	 * ImageDecoder are reused, thus images of the same size do not
+	 * allocate anything.
+	 *
+	 * decoding is I/O and CPU bound, thus using more threads than
+	 * cores still helps when the files are not yet cached.
+	 */
+	template <typename Img = ImageChannel> class ImageBatchLoader {
+
+	private:
+
+		/** one decoded image */
+		struct Slot {
+			Img img;
+			bool ready = false;
+			std::exception_ptr error;
+		};
+
+		/** number of decoding threads */
+		int numThreads;
+
+		/** number of images decoded ahead */
+		int depth;
+
+	public:
+
+		/**
+		 * ctor
+		 * @param numThreads the number of decoding threads. 0 = one per core
+		 * @param depth the maximum number of decoded images held in memory. 0 = 2 per thread
+		 */
+		explicit ImageBatchLoader(const int numThreads = 0, const int depth = 0) {
+			this->numThreads = (numThreads > 0) ? (numThreads) : (std::max(1, (int) std::thread::hardware_concurrency()));
+			this->depth = (depth > 0) ? (depth) : (this->numThreads * 2);
+		}
+
+		/** get the number of decoding threads */
+		int getNumThreads() const {return numThreads;}
+
+		/** get the maximum number of decoded images held in memory */
+		int getDepth() const {return depth;}
+
+		/**
+		 * decode all files and call func(size_t idx, Img& img) for each of them, in order, on the calling thread.
+		 * img is reused once func returns (it may be swapped out). decoding errors and exceptions
+		 * thrown by func stop all threads and are re-thrown
+		 */
+		template <typename Func> void run(const std::vector<std::string>& files, Func&& func) const {
+
+			const size_t num = files.size();
+			const size_t numSlots = (size_t) depth;
+			std::vector<Slot> slots(numSlots);
+
+			std::mutex mutex;
+			std::condition_variable cvFree;
+			std::condition_variable cvReady;
+			size_t next = 0;			// the next file to decode
+			size_t consumed = 0;		// the number of files handed to func
+			bool stop = false;
+
+			auto work = [&] () {
+				ImageDecoder dec;
+				for (;;) {
+
+					std::unique_lock<std::mutex> lock(mutex);
+					cvFree.wait(lock, [&] {return stop || next >= num || next < consumed + numSlots;});
+					if (stop || next >= num) {return;}
+					const size_t idx = next++;
+					Slot& s = slots[idx % numSlots];
+					lock.unlock();
+
+					try {
+						dec.decode(files[idx], s.img);
+					} catch (...) {
+						s.error = std::current_exception();
+					}
+
+					lock.lock();
+					s.ready = true;
+					cvReady.notify_one();
+
+				}
+			};
+
+			std::vector<std::thread> threads;
+			const int numWorkers = (int) std::min((size_t) numThreads, num);
+			for (int i = 0; i < numWorkers; ++i) {threads.emplace_back(work);}
+
+			auto join = [&] () {
+				{std::lock_guard<std::mutex> lock(mutex); stop = true;}
+				cvFree.notify_all();
+				for (std::thread& t : threads) {t.join();}
+			};
+
+			try {
+
+				for (size_t idx = 0; idx < num; ++idx) {
+
+					Slot& s = slots[idx % numSlots];
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						cvReady.wait(lock, [&] {return s.ready;});
+					}
+					if (s.error) {std::rethrow_exception(s.error);}
+
+					func(idx, s.img);
+
+					std::lock_guard<std::mutex> lock(mutex);
+					s.ready = false;
+					++consumed;
+					cvFree.notify_all();
+
+				}
+
+			} catch (...) {
+				join();
+				throw;
+			}
+
+			join();
+
+		}
+
+	};
+
+}
+
+#endif // K_CV_IMAGEBATCHLOADER_H
@@ -0,0 +1,216 @@
+#ifndef K_CV_IMAGEBUFFER_H
+#define K_CV_IMAGEBUFFER_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <algorithm>
+
+#include "ImageChannel.h"
+#include "Float16.h"
+#include "../Assertions.h"
+
+namespace K {
+
+	/** conversion between a pixel type and ImageChannel's floats ([0:1] for integer types) */
+	template <typename T> struct PixelTraits;
+
+	template <> struct PixelTraits<uint8_t> {
+		static void toFloat(const uint8_t* src, float* dst, const int num) {
+			for (int i = 0; i < num; ++i) {dst[i] = (float) src[i] / 255.0f;}
+		}
+		static void fromFloat(const float* src, uint8_t* dst, const int num) {
+			for (int i = 0; i < num; ++i) {dst[i] = (uint8_t) std::min(255.0f, std::max(0.0f, src[i] * 255.0f + 0.5f));}
+		}
+	};
+
+	template <> struct PixelTraits<uint16_t> {
+		static void toFloat(const uint16_t* src, float* dst, const int num) {
+			for (int i = 0; i < num; ++i) {dst[i] = (float) src[i] / 65535.0f;}
+		}
+		static void fromFloat(const float* src, uint16_t* dst, const int num) {
+			for (int i = 0; i < num; ++i) {dst[i] = (uint16_t) std::min(65535.0f, std::max(0.0f, src[i] * 65535.0f + 0.5f));}
+		}
+	};
+
+	template <> struct PixelTraits<Float16> {
+		static void toFloat(const Float16* src, float* dst, const int num)		{Float16::toFloat(src, dst, (size_t) num);}
+		static void fromFloat(const float* src, Float16* dst, const int num)	{Float16::fromFloat(src, dst, (size_t) num);}
+	};
+
+	template <> struct PixelTraits<float> {
+		static void toFloat(const float* src, float* dst, const int num)		{std::memcpy(dst, src, (size_t) num * sizeof(float));}
+		static void fromFloat(const float* src, float* dst, const int num)		{std::memcpy(dst, src, (size_t) num * sizeof(float));}
+	};
+
+	/**
+	 * typed 2D image storage with 64-byte aligned (and padded) rows.
+	 *
+	 * unlike ImageChannel, copies and regions are views that share the pixels
+	 * with the image they were created from (the memory is reference counted).
+	 * use clone() for a deep copy.
+	 *
+	 * rows are addressed via getRow(y). x + y * getStride() is the index of
+	 * a pixel relative to getData(). only the rows of a full image
+	 * (not those of a region) start at an aligned address.
+	 */
+	template <typename T> class ImageBuffer {
+
+	public:
+
+		/** the alignment of each row (of a full image) in bytes */
+		static constexpr int ALIGNMENT = 64;
+
+	private:
+
+		/** the (shared) memory. empty for wrapped data */
+		std::shared_ptr<uint8_t> mem;
+
+		/** the first pixel */
+		T* data;
+
+		/** the image's size */
+		int width;
+		int height;
+
+		/** the distance between two rows (in pixels) */
+		int stride;
+
+	public:
+
+		/** empty ctor */
+		ImageBuffer() : data(nullptr), width(0), height(0), stride(0) {;}
+
+		/** ctor. all pixels (and the padding) are zero */
+		ImageBuffer(const int width, const int height) : data(nullptr), width(width), height(height) {
+
+			_assertTrue(width >= 0 && height >= 0, "invalid size");
+			const size_t rowBytes = ((size_t) width * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			stride = (int) (rowBytes / sizeof(T));
+
+			const size_t bytes = rowBytes * (size_t) height;
+			if (bytes == 0) {return;}
+			uint8_t* ptr = (uint8_t*) ::operator new(bytes, std::align_val_t(ALIGNMENT));
+			std::memset(ptr, 0, bytes);
+			mem = std::shared_ptr<uint8_t>(ptr, [] (uint8_t* p) {::operator delete(p, std::align_val_t(ALIGNMENT));});
+			data = (T*) ptr;
+
+		}
+
+		/** view on existing pixels (e.g. those of an ImageChannel) that must outlive the view. stride in pixels */
+		static ImageBuffer wrap(T* data, const int width, const int height, const int stride) {
+			_assertTrue(stride >= width, "stride must be >= width");
+			ImageBuffer img;
+			img.data = data;
+			img.width = width;
+			img.height = height;
+			img.stride = stride;
+			return img;
+		}
+
+		/** convert the given channel (floats within [0:1] for integer types) */
+		static ImageBuffer fromChannel(const ImageChannel& img) {
+			ImageBuffer res(img.getWidth(), img.getHeight());
+			for (int y = 0; y < res.height; ++y) {
+				PixelTraits<T>::fromFloat(img.getData() + (size_t) y * (size_t) res.width, res.getRow(y), res.width);
+			}
+			return res;
+		}
+
+		/** convert to an ImageChannel (integer types are mapped to [0:1]) */
+		ImageChannel toChannel() const {
+			ImageChannel res(width, height);
+			for (int y = 0; y < height; ++y) {
+				PixelTraits<T>::toFloat(getRow(y), res.getData() + (size_t) y * (size_t) width, width);
+			}
+			return res;
+		}
+
+		/** deep copy (with aligned rows) */
+		ImageBuffer clone() const {
+			ImageBuffer res(width, height);
+			for (int y = 0; y < height; ++y) {std::memcpy(res.getRow(y), getRow(y), (size_t) width * sizeof(T));}
+			return res;
+		}
+
+		/** view on the region [x1:x2) x [y1:y2), sharing the pixels with this image */
+		ImageBuffer region(const int x1, const int y1, const int x2, const int y2) const {
+			_assertTrue(x1 >= 0 && y1 >= 0 && x1 <= x2 && y1 <= y2 && x2 <= width && y2 <= height, "region out of bounds");
+			ImageBuffer res = *this;
+			res.data = data + (size_t) y1 * (size_t) stride + x1;
+			res.width = x2 - x1;
+			res.height = y2 - y1;
+			return res;
+		}
+
+		/** get the image's width */
+		inline int getWidth() const {return width;}
+
+		/** get the image's height */
+		inline int getHeight() const {return height;}
+
+		/** get the distance between two rows (in pixels) */
+		inline int getStride() const {return stride;}
+
+		/** are all rows stored without padding in between? */
+		bool isContiguous() const {return stride == width || height <= 1;}
+
+		/** get the first pixel */
+		inline T* getData() const {return data;}
+
+		/** get the first pixel of the y-th row */
+		inline T* getRow(const int y) const {
+			return data + (size_t) y * (size_t) stride;
+		}
+
+		/** get the value at (x,y) */
+		inline T get(const int x, const int y) const {
+			_assertBetween(x, 0, width-1, "x out of bounds: " + std::to_string(x));
+			_assertBetween(y, 0, height-1, "y out of bounds: " + std::to_string(y));
+			return getRow(y)[x];
+		}
+
+		/** set the value at (x,y) */
+		inline void set(const int x, const int y, const T v) const {
+			_assertBetween(x, 0, width-1, "x out of bounds: " + std::to_string(x));
+			_assertBetween(y, 0, height-1, "y out of bounds: " + std::to_string(y));
+			getRow(y)[x] = v;
+		}
+
+		/** set all pixels (not the padding) to the given value */
+		void setAll(const T v) const {
+			for (int y = 0; y < height; ++y) {std::fill(getRow(y), getRow(y) + width, v);}
+		}
+
+		/** does this image share its pixels with the given one? */
+		bool sharesWith(const ImageBuffer& o) const {
+			return mem && mem == o.mem;
+		}
+
+		/** pixel-wise comparison (ignores the padding) */
+		bool operator == (const ImageBuffer& o) const {
+			if (width != o.width || height != o.height) {return false;}
+			for (int y = 0; y < height; ++y) {
+				if (std::memcmp(getRow(y), o.getRow(y), (size_t) width * sizeof(T)) != 0) {return false;}
+			}
+			return true;
+		}
+
+	};
+
+	/** 8 bit per pixel */
+	using ImageU8 = ImageBuffer<uint8_t>;
+
+	/** 16 bit per pixel */
+	using ImageU16 = ImageBuffer<uint16_t>;
+
+	/** half precision float per pixel */
+	using ImageF16 = ImageBuffer<Float16>;
+
+	/** float per pixel */
+	using ImageF32 = ImageBuffer<float>;
+
+}
+
+#endif // K_CV_IMAGEBUFFER_H
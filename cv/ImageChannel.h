@@ -3,16 +3,20 @@
 
 
 #include "DataMatrix.h"
+#include "ImageExpression.h"
 #include <functional>
 #include <algorithm>
 #include "../math/statistics/Statistics.h"
 
 namespace K {
 
-	class ImageChannel : public DataMatrix<float> {
+	class ImageChannel : public DataMatrix<float>, public ImageExpression<ImageChannel> {
 
 	public:
 
+		/** images are referenced by the expressions using them */
+		static constexpr bool EXPR_LEAF = true;
+
 		/** empty ctor */
 		ImageChannel() : DataMatrix() {;}
 
@@ -22,6 +26,57 @@ namespace K {
 		/** ctor without data */
 		ImageChannel(const int width, const int height) : DataMatrix(width, height) {;}
 
+		/** ctor from an element-wise expression like (1 - img) * 0.5f, evaluated in one pass */
+		template <typename E> ImageChannel(const ImageExpression<E>& expr) : DataMatrix(expr.self().getWidth(), expr.self().getHeight()) {
+			ImageExpr::evaluate(expr.self(), data.data(), data.size());
+		}
+
+		/** assign an element-wise expression. the expression may use this image itself (e.g. img = 1 - img) */
+		template <typename E> ImageChannel& operator = (const ImageExpression<E>& expr) {
+			const E& e = expr.self();
+			if (e.getWidth() != width || e.getHeight() != height) {
+				*this = ImageChannel(expr);
+			} else {
+				ImageExpr::evaluate(e, data.data(), data.size());
+			}
+			return *this;
+		}
+
+		using DataMatrix::operator +=;
+		using DataMatrix::operator -=;
+		using DataMatrix::operator *=;
+		using DataMatrix::operator /=;
+
+		/** in-place: add the given expression */
+		template <typename E> ImageChannel& operator += (const ImageExpression<E>& expr)	{return *this = *this + expr.self();}
+
+		/** in-place: subtract the given expression */
+		template <typename E> ImageChannel& operator -= (const ImageExpression<E>& expr)	{return *this = *this - expr.self();}
+
+		/** in-place: multiply with the given expression */
+		template <typename E> ImageChannel& operator *= (const ImageExpression<E>& expr)	{return *this = *this * expr.self();}
+
+		/** in-place: divide by the given expression */
+		template <typename E> ImageChannel& operator /= (const ImageExpression<E>& expr)	{return *this = *this / expr.self();}
+
+		/** in-place: subtract the given value */
+		ImageChannel& operator -= (const float val) {
+			for (float& f : data) {f -= val;}
+			return *this;
+		}
+
+		/** the idx-th pixel (expression interface) */
+		inline float getPixel(const size_t idx) const {return data[idx];}
+
+#ifdef K_CV_PACKET
+		/** the pixels [idx:idx+n) (expression interface) */
+		inline Packet getPacket(const size_t idx) const {
+			Packet p;
+			std::memcpy(&p, data.data() + idx, sizeof(p));
+			return p;
+		}
+#endif
+
 
 
 
@@ -119,31 +174,6 @@ namespace K {
 		}
 
 
-		friend K::ImageChannel operator - (const float val, const K::ImageChannel& img) {
-			K::ImageChannel copy = img;
-			for (int i = 0; i < (int) img.data.size(); ++i) { copy.data[i] = val - copy.data[i]; }
-			return copy;
-		}
-
-		friend K::ImageChannel operator * (const K::ImageChannel& img, const float val) {
-			K::ImageChannel copy = img;
-			for (int i = 0; i < (int) img.data.size(); ++i) { copy.data[i] = copy.data[i] * val; }
-			return copy;
-		}
-
-		friend K::ImageChannel operator / (const K::ImageChannel& img, const float val) {
-			K::ImageChannel copy = img;
-			for (int i = 0; i < (int) img.data.size(); ++i) { copy.data[i] = copy.data[i] / val; }
-			return copy;
-		}
-
-		/** make all values absolute */
-		K::ImageChannel abs() const {
-			K::ImageChannel copy = *this;
-			for (int i = 0; i < (int) copy.data.size(); ++i) { copy.data[i] = std::abs(copy.data[i]); }
-			return copy;
-		}
-
 		/** check whether the picture contains the given pixel */
 		bool contains(const int x, const int y) const {
 			if (x < 0)				{return false;}
@@ -0,0 +1,338 @@
+#ifndef K_CV_IMAGEDECODER_H
+#define K_CV_IMAGEDECODER_H
+
+#include "ImageChannel.h"
+#include "ImageBuffer.h"
+#include "../Exception.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <csetjmp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#ifdef WITH_PNG
+#include <png.h>
+#endif
+
+#ifdef WITH_JPEG
+#include <jpeglib.h>
+#endif
+
+namespace K {
+
+	/**
+	 * decode PNG/JPEG images into grey images, row by row.
+	 *
+	 * each row is converted as soon as libpng/libjpeg has decoded it and written
+	 * directly into the destination, which is either an ImageChannel or a typed
+	 * ImageBuffer<T> (integer types hold [0:max], floats [0:1]).
+	 * when the destination already has the image's size, its pixels are reused.
+	 * the decoder itself keeps its row buffers, thus decoding many images with
+	 * one decoder (per thread) does not allocate anything after the first one.
+	 *
+	 * grey values: RGB(A) PNGs are averaged (alpha is skipped). colored JPEGs use
+	 * their first (red) component, like ImageFactory always did. setJPEGLuminance()
+	 * decodes them as luminance instead, which skips libjpeg's color conversion.
+	 */
+	class ImageDecoder {
+
+	private:
+
+		/** one decoded row (or the whole image for interlaced PNGs) */
+		std::vector<uint8_t> raw;
+
+		/** row pointers for interlaced PNGs */
+		std::vector<uint8_t*> rows;
+
+		/** one grey row, for destinations that are not float */
+		std::vector<float> grey;
+
+		/** decode colored JPEGs as luminance instead of their first component */
+		bool jpegLuminance = false;
+
+	public:
+
+		/** decode colored JPEGs as luminance (faster) instead of their first (red) component */
+		void setJPEGLuminance(const bool luminance) {
+			jpegLuminance = luminance;
+		}
+
+		/** decode the given PNG or JPEG file (detected by its content) into dst */
+		template <typename Img> void decode(const std::string& file, Img& dst) {
+
+			File fp(file);
+			uint8_t magic[4] = {0};
+			const size_t num = fread(magic, 1, 4, fp.get());
+			rewind(fp.get());
+
+			if (num == 4 && magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G') {
+				decodePNG(fp.get(), nullptr, file, dst);
+			} else if (num >= 2 && magic[0] == 0xFF && magic[1] == 0xD8) {
+				decodeJPEG(fp.get(), file, dst);
+			} else {
+				throw Exception("unsupported image format: " + file);
+			}
+
+		}
+
+		/** decode the given PNG file into dst */
+		template <typename Img> void decodePNG(const std::string& file, Img& dst) {
+			File fp(file);
+			decodePNG(fp.get(), nullptr, file, dst);
+		}
+
+		/** decode the given in-memory PNG into dst */
+		template <typename Img> void decodePNG(const uint8_t bytes[], Img& dst) {
+			decodePNG(nullptr, bytes, "memory", dst);
+		}
+
+		/** decode the given JPEG file into dst */
+		template <typename Img> void decodeJPEG(const std::string& file, Img& dst) {
+			File fp(file);
+			decodeJPEG(fp.get(), file, dst);
+		}
+
+	private:
+
+		/** closes the file when going out of scope */
+		struct File : std::unique_ptr<FILE, int(*)(FILE*)> {
+			File(const std::string& file) : std::unique_ptr<FILE, int(*)(FILE*)>(fopen(file.c_str(), "rb"), fclose) {
+				if (!get()) {throw Exception("error while reading file " + file);}
+			}
+		};
+
+
+		/** ensure dst has the given size. keeps the pixels if it already has */
+		static void prepare(ImageChannel& dst, const int w, const int h) {
+			if (dst.getWidth() != w || dst.getHeight() != h) {dst = ImageChannel(w, h);}
+		}
+
+		/** ensure dst has the given size. keeps the pixels if it already has */
+		template <typename T> static void prepare(ImageBuffer<T>& dst, const int w, const int h) {
+			if (dst.getWidth() != w || dst.getHeight() != h) {dst = ImageBuffer<T>(w, h);}
+		}
+
+		/** convert the y-th decoded row and write it into dst */
+		void store(ImageChannel& dst, const int y, const uint8_t* src, const int bitDepth, const int channels) {
+			const int w = dst.getWidth();
+			toGrey(src, bitDepth, channels, dst.getData() + (size_t) y * (size_t) w, w);
+		}
+
+		/** convert the y-th decoded row and write it into dst */
+		template <typename T> void store(ImageBuffer<T>& dst, const int y, const uint8_t* src, const int bitDepth, const int channels) {
+			const int w = dst.getWidth();
+			T* row = dst.getRow(y);
+			if constexpr (std::is_same<T, float>::value) {
+				toGrey(src, bitDepth, channels, row, w);
+				return;
+			}
+			if constexpr (std::is_same<T, uint8_t>::value) {
+				if (bitDepth == 8 && channels == 1) {std::memcpy(row, src, (size_t) w); return;}
+			}
+			grey.resize((size_t) w);
+			toGrey(src, bitDepth, channels, grey.data(), w);
+			PixelTraits<T>::fromFloat(grey.data(), row, w);
+		}
+
+		/** convert one row of 8 or 16 (big endian) bit pixels with 1-4 channels to [0.0:1.0] grey values */
+		static void toGrey(const uint8_t* src, const int bitDepth, const int channels, float* dst, const int w) {
+
+			if (bitDepth == 8) {
+				switch (channels) {
+					case 1:		for (int x = 0; x < w; ++x, src += 1) {dst[x] = float(src[0]) / (float) (255);} return;
+					case 2:		for (int x = 0; x < w; ++x, src += 2) {dst[x] = float(src[0]) / (float) (255);} return;						// grey + alpha. skip alpha
+					case 3:		for (int x = 0; x < w; ++x, src += 3) {dst[x] = float(src[0]+src[1]+src[2]) / (float) (255*3);} return;	// RGB. average
+					case 4:		for (int x = 0; x < w; ++x, src += 4) {dst[x] = float(src[0]+src[1]+src[2]) / (float) (255*3);} return;	// RGBA. skip alpha
+				}
+			} else if (bitDepth == 16) {
+				switch (channels) {
+					case 1:		for (int x = 0; x < w; ++x, src += 2) {dst[x] = float(be16(src)) / (float) (65535);} return;
+					case 2:		for (int x = 0; x < w; ++x, src += 4) {dst[x] = float(be16(src)) / (float) (65535);} return;
+					case 3:		for (int x = 0; x < w; ++x, src += 6) {dst[x] = float(be16(src)+be16(src+2)+be16(src+4)) / (float) (65535*3);} return;
+					case 4:		for (int x = 0; x < w; ++x, src += 8) {dst[x] = float(be16(src)+be16(src+2)+be16(src+4)) / (float) (65535*3);} return;
+				}
+			}
+			throw Exception("unsupported pixel format: " + std::to_string(bitDepth) + " bit, " + std::to_string(channels) + " channels");
+
+		}
+
+		static inline int be16(const uint8_t* src) {
+			return (src[0] << 8) | src[1];
+		}
+
+
+#ifdef WITH_PNG
+
+		/** reads from an in-memory PNG */
+		static void readPNGMemory(png_structp png, png_bytep data, png_size_t length) {
+			const uint8_t** bytes = (const uint8_t**) png_get_io_ptr(png);
+			memcpy(data, *bytes, length);
+			*bytes += length;
+		}
+
+		/** decode from the given file or memory. libpng errors return here via longjmp */
+		template <typename Img> void decodePNG(FILE* fp, const uint8_t* bytes, const std::string& name, Img& dst) {
+
+			png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+			if (!png) {throw Exception("could not allocate png read struct");}
+
+			png_infop info = png_create_info_struct(png);
+			if (!info) {png_destroy_read_struct(&png, nullptr, nullptr); throw Exception("could not create png info struct");}
+
+			if (setjmp(png_jmpbuf(png))) {
+				png_destroy_read_struct(&png, &info, nullptr);
+				throw Exception("error while decoding png: " + name);
+			}
+
+			// C++ exceptions (e.g. unsupported pixel formats, bad_alloc) do not pass the longjmp above
+			const uint8_t* ptr = bytes;
+			if (fp) {png_init_io(png, fp);} else {png_set_read_fn(png, &ptr, readPNGMemory);}
+			try {
+				readPNG(png, info, dst);
+			} catch (...) {
+				png_destroy_read_struct(&png, &info, nullptr);
+				throw;
+			}
+			png_destroy_read_struct(&png, &info, nullptr);
+
+		}
+
+		/** must not hold objects with destructors: libpng errors longjmp over it */
+		template <typename Img> void readPNG(png_structp png, png_infop info, Img& dst) {
+
+			png_read_info(png, info);
+
+			// expand palette and 1/2/4 bit grey images to 8 bit
+			const int colorType = png_get_color_type(png, info);
+			if (colorType == PNG_COLOR_TYPE_PALETTE) {png_set_palette_to_rgb(png);}
+			if (colorType == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png, info) < 8) {png_set_expand_gray_1_2_4_to_8(png);}
+			const int passes = png_set_interlace_handling(png);
+			png_read_update_info(png, info);
+
+			const int w = (int) png_get_image_width(png, info);
+			const int h = (int) png_get_image_height(png, info);
+			const int bitDepth = png_get_bit_depth(png, info);
+			const int channels = png_get_channels(png, info);
+			const size_t bytesPerRow = png_get_rowbytes(png, info);
+			prepare(dst, w, h);
+
+			if (passes == 1) {
+
+				// stream: convert each row as soon as it is decoded
+				raw.resize(bytesPerRow);
+				for (int y = 0; y < h; ++y) {
+					png_read_row(png, raw.data(), nullptr);
+					store(dst, y, raw.data(), bitDepth, channels);
+				}
+
+			} else {
+
+				// interlaced: rows are complete only after the last pass
+				raw.resize(bytesPerRow * (size_t) h);
+				rows.resize((size_t) h);
+				for (int y = 0; y < h; ++y) {rows[y] = raw.data() + (size_t) y * bytesPerRow;}
+				png_read_image(png, rows.data());
+				for (int y = 0; y < h; ++y) {store(dst, y, rows[y], bitDepth, channels);}
+
+			}
+
+		}
+
+#else
+
+		template <typename Img> void decodePNG(FILE*, const uint8_t*, const std::string&, Img&) {
+			throw Exception("compiled without PNG support");
+		}
+
+#endif
+
+
+#ifdef WITH_JPEG
+
+		/** libjpeg's error manager, extended by the target for longjmp */
+		struct JPEGError {
+			jpeg_error_mgr mgr;
+			jmp_buf jmp;
+			char msg[JMSG_LENGTH_MAX];
+		};
+
+		/** libjpeg would exit() by default */
+		static void onJPEGError(j_common_ptr cinfo) {
+			JPEGError* err = (JPEGError*) cinfo->err;
+			(*cinfo->err->format_message)(cinfo, err->msg);
+			longjmp(err->jmp, 1);
+		}
+
+		/** decode from the given file. libjpeg errors return here via longjmp */
+		template <typename Img> void decodeJPEG(FILE* fp, const std::string& name, Img& dst) {
+
+			jpeg_decompress_struct cinfo;
+			JPEGError err;
+			cinfo.err = jpeg_std_error(&err.mgr);
+			err.mgr.error_exit = onJPEGError;
+			jpeg_create_decompress(&cinfo);
+
+			if (setjmp(err.jmp)) {
+				jpeg_destroy_decompress(&cinfo);
+				throw Exception("error while decoding jpeg: " + name + ": " + err.msg);
+			}
+
+			// C++ exceptions (e.g. unsupported pixel formats, bad_alloc) do not pass the longjmp above
+			jpeg_stdio_src(&cinfo, fp);
+			try {
+				readJPEG(cinfo, dst);
+			} catch (...) {
+				jpeg_destroy_decompress(&cinfo);
+				throw;
+			}
+			jpeg_destroy_decompress(&cinfo);
+
+		}
+
+		/** must not hold objects with destructors: libjpeg errors longjmp over it */
+		template <typename Img> void readJPEG(jpeg_decompress_struct& cinfo, Img& dst) {
+
+			(void) jpeg_read_header(&cinfo, TRUE);
+
+			// luminance only. libjpeg then skips the chroma components and the color conversion
+			if (jpegLuminance && (cinfo.jpeg_color_space == JCS_YCbCr || cinfo.jpeg_color_space == JCS_GRAYSCALE)) {
+				cinfo.out_color_space = JCS_GRAYSCALE;
+			}
+			(void) jpeg_start_decompress(&cinfo);
+
+			const int w = (int) cinfo.output_width;
+			const int h = (int) cinfo.output_height;
+			const int channels = cinfo.output_components;
+			prepare(dst, w, h);
+
+			// stream: convert each row as soon as it is decoded
+			raw.resize((size_t) w * (size_t) channels);
+			JSAMPROW row = raw.data();
+			while (cinfo.output_scanline < cinfo.output_height) {
+				const int y = (int) cinfo.output_scanline;
+				(void) jpeg_read_scanlines(&cinfo, &row, 1);
+				for (int x = 1; x < w && channels > 1; ++x) {raw[x] = raw[x * channels];}	// first component only
+				store(dst, y, raw.data(), 8, 1);
+			}
+
+			(void) jpeg_finish_decompress(&cinfo);
+
+		}
+
+#else
+
+		template <typename Img> void decodeJPEG(FILE*, const std::string&, Img&) {
+			throw Exception("compiled without JPEG support");
+		}
+
+#endif
+
+	};
+
+}
+
+#endif // K_CV_IMAGEDECODER_H
@@ -0,0 +1,173 @@
+#ifndef K_CV_IMAGEEXPRESSION_H
+#define K_CV_IMAGEEXPRESSION_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "../Assertions.h"
+#include "Packet.h"
+
+namespace K {
+
+	/**
+	 * base of all lazily evaluated element-wise image expressions, e.g. (1 - img) * 0.5f / max.
+	 *
+	 * combining images (and scalars) via + - * / and abs() does not allocate anything,
+	 * it just builds a (small) expression tree. assigning the expression to an ImageChannel
+	 * evaluates it in one pass over all pixels, several pixels at once.
+	 *
+	 * the tree holds references to all named images it uses, thus an expression
+	 * must not outlive those (e.g. when stored via auto). temporary images are moved
+	 * into the tree.
+	 */
+	template <typename E> struct ImageExpression {
+
+		/** the actual expression */
+		inline const E& self() const {return static_cast<const E&>(*this);}
+
+		/** element-wise absolute value */
+		inline auto abs() const;
+
+	};
+
+	namespace ImageExpr {
+
+		/** is T an expression (or an image)? */
+		template <typename T> using IsExpr = std::is_base_of<ImageExpression<std::decay_t<T>>, std::decay_t<T>>;
+
+		/** how a node stores its operand: named images by reference, temporary images and nodes by value */
+		template <typename T> using Stored = std::conditional_t<
+			std::is_lvalue_reference<T>::value && std::decay_t<T>::EXPR_LEAF,
+			const std::decay_t<T>&,
+			std::decay_t<T>
+		>;
+
+		struct Add {template <typename V> static inline V apply(const V a, const V b) {return a + b;}};
+		struct Sub {template <typename V> static inline V apply(const V a, const V b) {return a - b;}};
+		struct Mul {template <typename V> static inline V apply(const V a, const V b) {return a * b;}};
+		struct Div {template <typename V> static inline V apply(const V a, const V b) {return a / b;}};
+
+		struct Neg {
+			static inline float apply(const float a) {return -a;}
+#ifdef K_CV_PACKET
+			static inline Packet apply(const Packet a) {return -a;}
+#endif
+		};
+
+		struct Abs {
+			static inline float apply(const float a) {return std::abs(a);}
+#ifdef K_CV_PACKET
+			static inline Packet apply(const Packet a) {return (Packet) ((PacketI) a & 0x7FFFFFFF);}
+#endif
+		};
+
+		/** expr op expr */
+		template <typename Op, typename L, typename R> struct Binary : ImageExpression<Binary<Op, L, R>> {
+			static constexpr bool EXPR_LEAF = false;
+			L l;
+			R r;
+			Binary(L l, R r) : l(std::forward<L>(l)), r(std::forward<R>(r)) {
+				_assertTrue(this->l.getWidth() == this->r.getWidth() && this->l.getHeight() == this->r.getHeight(), "size mismatch");
+			}
+			inline int getWidth() const {return l.getWidth();}
+			inline int getHeight() const {return l.getHeight();}
+			inline float getPixel(const size_t i) const {return Op::apply(l.getPixel(i), r.getPixel(i));}
+#ifdef K_CV_PACKET
+			inline Packet getPacket(const size_t i) const {return Op::apply(l.getPacket(i), r.getPacket(i));}
+#endif
+		};
+
+		/** expr op scalar */
+		template <typename Op, typename L> struct BinaryScalarR : ImageExpression<BinaryScalarR<Op, L>> {
+			static constexpr bool EXPR_LEAF = false;
+			L l;
+			float s;
+			BinaryScalarR(L l, const float s) : l(std::forward<L>(l)), s(s) {;}
+			inline int getWidth() const {return l.getWidth();}
+			inline int getHeight() const {return l.getHeight();}
+			inline float getPixel(const size_t i) const {return Op::apply(l.getPixel(i), s);}
+#ifdef K_CV_PACKET
+			inline Packet getPacket(const size_t i) const {return Op::apply(l.getPacket(i), Packet{} + s);}
+#endif
+		};
+
+		/** scalar op expr */
+		template <typename Op, typename R> struct BinaryScalarL : ImageExpression<BinaryScalarL<Op, R>> {
+			static constexpr bool EXPR_LEAF = false;
+			float s;
+			R r;
+			BinaryScalarL(const float s, R r) : s(s), r(std::forward<R>(r)) {;}
+			inline int getWidth() const {return r.getWidth();}
+			inline int getHeight() const {return r.getHeight();}
+			inline float getPixel(const size_t i) const {return Op::apply(s, r.getPixel(i));}
+#ifdef K_CV_PACKET
+			inline Packet getPacket(const size_t i) const {return Op::apply(Packet{} + s, r.getPacket(i));}
+#endif
+		};
+
+		/** op expr */
+		template <typename Op, typename A> struct Unary : ImageExpression<Unary<Op, A>> {
+			static constexpr bool EXPR_LEAF = false;
+			A a;
+			explicit Unary(A a) : a(std::forward<A>(a)) {;}
+			inline int getWidth() const {return a.getWidth();}
+			inline int getHeight() const {return a.getHeight();}
+			inline float getPixel(const size_t i) const {return Op::apply(a.getPixel(i));}
+#ifdef K_CV_PACKET
+			inline Packet getPacket(const size_t i) const {return Op::apply(a.getPacket(i));}
+#endif
+		};
+
+		/** evaluate the expression into the given (correctly sized) array */
+		template <typename E> void evaluate(const E& e, float* dst, const size_t num) {
+			size_t i = 0;
+#ifdef K_CV_PACKET
+			constexpr size_t lanes = sizeof(Packet) / sizeof(float);
+			for (; i + lanes <= num; i += lanes) {
+				const Packet p = e.getPacket(i);
+				std::memcpy(dst + i, &p, sizeof(Packet));
+			}
+#endif
+			for (; i < num; ++i) {dst[i] = e.getPixel(i);}
+		}
+
+	}
+
+	template <typename E> inline auto ImageExpression<E>::abs() const {
+		return ImageExpr::Unary<ImageExpr::Abs, ImageExpr::Stored<const E&>>(self());
+	}
+
+	#define K_CV_IMAGEEXPR_BINARY(OP, NAME) \
+		template <typename A, typename B, typename = std::enable_if_t<ImageExpr::IsExpr<A>::value && ImageExpr::IsExpr<B>::value>> \
+		inline ImageExpr::Binary<ImageExpr::NAME, ImageExpr::Stored<A&&>, ImageExpr::Stored<B&&>> operator OP (A&& a, B&& b) { \
+			return {std::forward<A>(a), std::forward<B>(b)}; \
+		} \
+		template <typename A, typename = std::enable_if_t<ImageExpr::IsExpr<A>::value>> \
+		inline ImageExpr::BinaryScalarR<ImageExpr::NAME, ImageExpr::Stored<A&&>> operator OP (A&& a, const float s) { \
+			return {std::forward<A>(a), s}; \
+		} \
+		template <typename B, typename = std::enable_if_t<ImageExpr::IsExpr<B>::value>> \
+		inline ImageExpr::BinaryScalarL<ImageExpr::NAME, ImageExpr::Stored<B&&>> operator OP (const float s, B&& b) { \
+			return {s, std::forward<B>(b)}; \
+		}
+
+	K_CV_IMAGEEXPR_BINARY(+, Add)
+	K_CV_IMAGEEXPR_BINARY(-, Sub)
+	K_CV_IMAGEEXPR_BINARY(*, Mul)
+	K_CV_IMAGEEXPR_BINARY(/, Div)
+
+	#undef K_CV_IMAGEEXPR_BINARY
+
+	/** element-wise negation */
+	template <typename A, typename = std::enable_if_t<ImageExpr::IsExpr<A>::value>>
+	inline ImageExpr::Unary<ImageExpr::Neg, ImageExpr::Stored<A&&>> operator - (A&& a) {
+		return ImageExpr::Unary<ImageExpr::Neg, ImageExpr::Stored<A&&>>(std::forward<A>(a));
+	}
+
+}
+
+#endif // K_CV_IMAGEEXPRESSION_H
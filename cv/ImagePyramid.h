@@ -2,100 +2,296 @@
 #define IMAGEPYRAMID_H
 
 #include <vector>
+#include <algorithm>
 #include "ImageChannel.h"
-#include "KernelFactory.h"
+#include "TileExecutor.h"
+#include "../Assertions.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_CV_X86_SIMD
+#endif
 
 namespace K {
 
+	/**
+	 * gaussian image pyramid. each level has half the size of the previous one
+	 * and is obtained by blurring the previous level with the (separable)
+	 * 5-tap binomial kernel [1 4 6 4 1]/16 and dropping every second pixel.
+	 *
+	 * levels are built lazily, on the first get() of the level (or a level above).
+	 * set() replaces the base image while keeping all level buffers whose size
+	 * is unchanged, e.g. when processing video frames of the same size.
+	 *
+	 * the lazy build is not thread-safe: call build() beforehand if several
+	 * threads get() levels of the same pyramid.
+	 */
 	class ImagePyramid {
 
 	private:
 
-		/** all layers of the pyramid */
+		/** level 0: either the borrowed image or the own copy */
+		const ImageChannel* base;
+
+		/** the own copy of level 0 (if not borrowed) */
+		ImageChannel copy;
+
+		/** levels [1:numLevels) at [0:numLevels-1). buffers are kept across set() */
 		std::vector<ImageChannel> layers;
 
+		/** the number of levels for the current base image */
+		int numLevels;
+
+		/** levels [0:numBuilt) are up-to-date */
+		int numBuilt;
+
+		/** used for reducing each level */
+		TileExecutor exec;
+
 	public:
 
-		/** ctor */
-		ImagePyramid(ImageChannel& img) {
-			layers.push_back(img);
-			create();
+		/** empty ctor */
+		ImagePyramid() : base(nullptr), numLevels(0), numBuilt(0) {;}
+
+		/**
+		 * ctor
+		 * @param img the base image (level 0)
+		 * @param borrow use the given image without copying it. it must then outlive the pyramid (or the next set())
+		 */
+		explicit ImagePyramid(const ImageChannel& img, const bool borrow = false) : ImagePyramid() {
+			set(img, borrow);
+		}
+
+		/** level 0 might point to the own copy */
+		ImagePyramid(const ImagePyramid& o) = delete;
+		ImagePyramid& operator = (const ImagePyramid& o) = delete;
+
+		/**
+		 * use a new base image (level 0). all other levels are invalidated and
+		 * rebuilt on demand, reusing their buffers if the size did not change.
+		 * @param img the base image (level 0)
+		 * @param borrow use the given image without copying it. it must then outlive the pyramid (or the next set())
+		 */
+		void set(const ImageChannel& img, const bool borrow = false) {
+
+			if (borrow) {
+				base = &img;
+			} else {
+				copy = img;
+				base = &copy;
+			}
+
+			// number of levels: halve until one of both sides drops below 1
+			numLevels = 1;
+			for (int w = img.getWidth() / 2, h = img.getHeight() / 2; w >= 1 && h >= 1; w /= 2, h /= 2) {++numLevels;}
+			numBuilt = 1;
+
 		}
 
-		/** get the number of layers */
+		/** set the executor used to reduce each level (default: all cores) */
+		void setExecutor(const TileExecutor& exec) {
+			this->exec = exec;
+		}
+
+		/** get the number of levels */
 		size_t size() const {
-			return layers.size();
+			return (size_t) numLevels;
 		}
 
-		/** get the idx-th layer */
-		ImageChannel& get(const int idx) {
-			return layers[idx];
+		/** get the idx-th level. builds all missing levels up to idx */
+		const ImageChannel& get(const int idx) {
+			_assertTrue(idx >= 0 && idx < numLevels, "pyramid level out of bounds");
+			build(idx);
+			return (idx == 0) ? (*base) : (layers[idx-1]);
 		}
 
-	private:
+		/** build all missing levels up to (including) idx */
+		void build(const int idx) {
 
-		void create() {
+			const int last = std::min(idx, numLevels - 1);
+			if ((int) layers.size() < numLevels - 1) {layers.resize(numLevels - 1);}
 
-			// start at layer 0
-			ImageChannel* prev = &layers[0];
+			for (; numBuilt <= last; ++numBuilt) {
+				const ImageChannel& prev = (numBuilt == 1) ? (*base) : (layers[numBuilt-2]);
+				ImageChannel& cur = layers[numBuilt-1];
+				const int w = prev.getWidth() / 2;
+				const int h = prev.getHeight() / 2;
+				if (cur.getWidth() != w || cur.getHeight() != h) {cur = ImageChannel(w, h);}
+				reduce(prev, cur, exec);
+			}
+
+		}
+
+		/** build all levels */
+		void buildAll() {
+			build(numLevels - 1);
+		}
 
-			const Kernel k = KernelFactory::gauss2D(1.0, 5);
+		/** blur the given image with [1 4 6 4 1]/16 (separable) and drop every second pixel */
+		static ImageChannel reduce(const ImageChannel& src) {
+			ImageChannel dst(src.getWidth() / 2, src.getHeight() / 2);
+			reduce(src, dst, TileExecutor());
+			return dst;
+		}
 
-			while (true) {
+		/**
+		 * reduce src into dst (half the size of src), one band of output rows at a time.
+		 * along the edges, only the taps within the image are used (and re-normalized)
+		 */
+		static void reduce(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec) {
 
-				// size for the current layer
-				const int curW = prev->getWidth() / 2;
-				const int curH = prev->getHeight() / 2;
+			_assertTrue(dst.getWidth() == src.getWidth() / 2 && dst.getHeight() == src.getHeight() / 2, "size mismatch");
+			if (dst.getWidth() == 0 || dst.getHeight() == 0) {return;}
 
-				// done?
-				if (curW < 1 || curH < 1) {break;}
+			exec.run(dst.getHeight(), 0, [&] (const TileBand& b) {
+				reduceRows(src, dst, b.y0, b.y1);
+			});
 
-				// create the image for the next layer
-				ImageChannel cur(curW, curH);
+		}
 
-				// render
-				for (int y = 0; y < curH; ++y) {
-					for (int x = 0; x < curW; ++x) {
+	private:
 
-						float val = 0;	// convolved value
-						float sum = 0;	// sum of all used kernel values (for normalization)
+		/** the output rows [y0:y1) of reduce(): vertical pass into a full-width row, decimating horizontal pass */
+		static void reduceRows(const ImageChannel& src, ImageChannel& dst, const int y0, const int y1) {
+
+			static constexpr float k[5] = {1, 4, 6, 4, 1};
+
+			const int sw = src.getWidth();
+			const int sh = src.getHeight();
+			const int dw = dst.getWidth();
+			std::vector<float> tmp(sw);
+
+			// interior output columns: all 5 taps within the image
+			const int x0 = std::min(1, dw);
+			const int x1 = std::max(x0, std::min(dw, (sw - 1) / 2));
+
+			for (int y = y0; y < y1; ++y) {
+
+				// vertical pass
+				const int sy = 2 * y;
+				if (sy - 2 >= 0 && sy + 2 < sh) {
+					const float* r = src.getData() + (size_t) (sy - 2) * (size_t) sw;
+					verticalInterior(r, r + sw, r + 2*sw, r + 3*sw, r + 4*sw, tmp.data(), sw);
+				} else {
+					std::fill(tmp.begin(), tmp.end(), 0.0f);
+					float sum = 0;
+					for (int j = 0; j < 5; ++j) {
+						const int iy = sy + j - 2;
+						if (iy < 0 || iy >= sh) {continue;}
+						const float* r = src.getData() + (size_t) iy * (size_t) sw;
+						for (int x = 0; x < sw; ++x) {tmp[x] += k[j] * r[x];}
+						sum += k[j];
+					}
+					for (int x = 0; x < sw; ++x) {tmp[x] /= sum;}
+				}
 
-						auto lambda = [&] (const int kx, const int ky, const float kv) {
+				// decimating horizontal pass
+				float* out = dst.getData() + (size_t) y * (size_t) dw;
+				for (int x = 0; x < x0; ++x)	{out[x] = horizontalEdge(tmp.data(), sw, x);}
+				for (int x = x1; x < dw; ++x)	{out[x] = horizontalEdge(tmp.data(), sw, x);}
+				horizontalInterior(tmp.data(), sw, out, x0, x1);
 
-							const int ix = (x*2) + kx;			// translate between cur and previous layer (twice the size) + add window
-							const int iy = (y*2) + ky;			// translate between cur and previous layer (twice the size) + add window
+			}
 
-							// skip edges
-							if (ix < 0 || ix >= prev->getWidth())	{return;}
-							if (iy < 0 || iy >= prev->getHeight())	{return;}
+		}
 
-							const float sv = prev->get(ix, iy);	// value from the current layer
-							val += kv*sv;						// update convolved value
-							sum += kv;							// update sum of used kernel values (for normalization)
+		/** one output pixel along the left/right edge, using only the taps within the image */
+		static inline float horizontalEdge(const float* in, const int sw, const int x) {
+			static constexpr float k[5] = {1, 4, 6, 4, 1};
+			float val = 0;
+			float sum = 0;
+			for (int i = 0; i < 5; ++i) {
+				const int ix = 2 * x + i - 2;
+				if (ix < 0 || ix >= sw) {continue;}
+				val += k[i] * in[ix];
+				sum += k[i];
+			}
+			return val / sum;
+		}
 
-						};
+		/** [1 4 6 4 1]/16 (same order of operations for the scalar and the SIMD variant) */
+		static inline float tap5(const float a, const float b, const float c, const float d, const float e) {
+			return (((a + e) + 4.0f * (b + d)) + 6.0f * c) * (1.0f / 16.0f);
+		}
 
-						// convolve
-						k.forEach(lambda);
+		static void verticalInterior(const float* r0, const float* r1, const float* r2, const float* r3, const float* r4, float* out, const int w) {
+			int x = 0;
+#ifdef K_CV_X86_SIMD
+			static const bool sse = hasSSE();
+			if (sse) {x = verticalSSE(r0, r1, r2, r3, r4, out, w);}
+#endif
+			for (; x < w; ++x) {out[x] = tap5(r0[x], r1[x], r2[x], r3[x], r4[x]);}
+		}
 
-						// set
-						val /= sum;								// normalize
-						cur.set(x,y,val);
+		static void horizontalInterior(const float* in, const int sw, float* out, int x, const int x1) {
+#ifdef K_CV_X86_SIMD
+			static const bool sse = hasSSE();
+			if (sse) {x = horizontalSSE(in, sw, out, x, x1);}
+#else
+			(void) sw;
+#endif
+			for (; x < x1; ++x) {
+				const float* p = in + 2 * x - 2;
+				out[x] = tap5(p[0], p[1], p[2], p[3], p[4]);
+			}
+		}
 
-					}
-				}
+#ifdef K_CV_X86_SIMD
 
-				// add and proceed
-				layers.push_back(cur);
-				prev = &layers[layers.size()-1];
+		static bool hasSSE() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse");
+		}
 
+		/** 4 pixels at once. returns the first unprocessed x */
+		__attribute__((target("sse")))
+		static int verticalSSE(const float* r0, const float* r1, const float* r2, const float* r3, const float* r4, float* out, const int w) {
+			const __m128 v4 = _mm_set1_ps(4.0f);
+			const __m128 v6 = _mm_set1_ps(6.0f);
+			const __m128 vNorm = _mm_set1_ps(1.0f / 16.0f);
+			int x = 0;
+			for (; x + 4 <= w; x += 4) {
+				const __m128 ae = _mm_add_ps(_mm_loadu_ps(r0 + x), _mm_loadu_ps(r4 + x));
+				const __m128 bd = _mm_add_ps(_mm_loadu_ps(r1 + x), _mm_loadu_ps(r3 + x));
+				const __m128 c = _mm_loadu_ps(r2 + x);
+				const __m128 val = _mm_add_ps(_mm_add_ps(ae, _mm_mul_ps(v4, bd)), _mm_mul_ps(v6, c));
+				_mm_storeu_ps(out + x, _mm_mul_ps(val, vNorm));
 			}
+			return x;
+		}
 
+		/**
+		 * 4 output pixels (from 11 input pixels) at once by splitting the input into even and odd pixels.
+		 * returns the first unprocessed x
+		 */
+		__attribute__((target("sse")))
+		static int horizontalSSE(const float* in, const int sw, float* out, int x, const int x1) {
+			const __m128 v4 = _mm_set1_ps(4.0f);
+			const __m128 v6 = _mm_set1_ps(6.0f);
+			const __m128 vNorm = _mm_set1_ps(1.0f / 16.0f);
+			for (; x + 4 <= x1 && 2 * x + 10 <= sw; x += 4) {
+				const float* p = in + 2 * x - 2;
+				const __m128 a = _mm_loadu_ps(p);
+				const __m128 b = _mm_loadu_ps(p + 4);
+				const __m128 c = _mm_loadu_ps(p + 8);
+				const __m128 e0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));		// p[0,2,4,6]
+				const __m128 o0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));		// p[1,3,5,7]
+				const __m128 e2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,0,2,0));		// p[4,6,8,10]
+				const __m128 o2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3,1,3,1));		// p[5,7,9,11]
+				const __m128 e1 = _mm_shuffle_ps(e0, e2, _MM_SHUFFLE(2,1,2,1));	// p[2,4,6,8]
+				const __m128 o1 = _mm_shuffle_ps(o0, o2, _MM_SHUFFLE(2,1,2,1));	// p[3,5,7,9]
+				const __m128 ae = _mm_add_ps(e0, e2);
+				const __m128 bd = _mm_add_ps(o0, o1);
+				const __m128 val = _mm_add_ps(_mm_add_ps(ae, _mm_mul_ps(v4, bd)), _mm_mul_ps(v6, e1));
+				_mm_storeu_ps(out + x, _mm_mul_ps(val, vNorm));
+			}
+			return x;
 		}
 
+#endif
+
 	};
 
 }
 
 #endif // IMAGEPYRAMID_H
-
@@ -0,0 +1,164 @@
+#ifndef K_CV_INTEGRALIMAGE_H
+#define K_CV_INTEGRALIMAGE_H
+
+#include "ImageChannel.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace K {
+
+	/**
+	 * summed-area table of an ImageChannel.
+	 *
+	 * allows for O(1) queries of the sum (and optionally the sum of squares)
+	 * of all pixels within a rectangle. accumulation uses double precision,
+	 * thus the sums remain exact enough even for large (e.g. 12 MP) images.
+	 *
+	 * all rectangles are given as [x1:x2) x [y1:y2) (like ImageChannel::region)
+	 * and are clamped to the image.
+	 */
+	class IntegralImage {
+
+	private:
+
+		/** the image's size */
+		int width;
+		int height;
+
+		/** (width+1) x (height+1) tables with a leading row/column of zeros */
+		std::vector<double> sum;
+		std::vector<double> sum2;
+
+	public:
+
+		/** empty ctor */
+		IntegralImage() : width(0), height(0) {;}
+
+		/**
+		 * ctor
+		 * @param img the image to build the table(s) for
+		 * @param withSquared also build a table for the sum of squared values (variance queries)
+		 */
+		explicit IntegralImage(const ImageChannel& img, const bool withSquared = false) {
+			build(img, [] (const int x, const int y, const float v) {(void) x; (void) y; return (double) v;}, withSquared);
+		}
+
+		/**
+		 * ctor for a weighted image: table(x,y) covers func(x, y, img(x,y))
+		 * @param img the image to build the table(s) for
+		 * @param func the value to accumulate for each pixel
+		 * @param withSquared also build a table for the sum of squared values
+		 */
+		template <typename Func> IntegralImage(const ImageChannel& img, Func func, const bool withSquared = false) {
+			build(img, func, withSquared);
+		}
+
+		/** get the image's width */
+		int getWidth() const {return width;}
+
+		/** get the image's height */
+		int getHeight() const {return height;}
+
+		/** does the table contain the squared sums? */
+		bool hasSquared() const {return !sum2.empty();}
+
+		/** get the sum of all values within [x1:x2) x [y1:y2) */
+		double getSum(int x1, int y1, int x2, int y2) const {
+			if (!clamp(x1, y1, x2, y2)) {return 0;}
+			return get(sum, x1, y1, x2, y2);
+		}
+
+		/** get the sum of all squared values within [x1:x2) x [y1:y2). requires withSquared */
+		double getSumSquared(int x1, int y1, int x2, int y2) const {
+			_assertTrue(hasSquared(), "squared table not built");
+			if (!clamp(x1, y1, x2, y2)) {return 0;}
+			return get(sum2, x1, y1, x2, y2);
+		}
+
+		/** get the number of pixels within [x1:x2) x [y1:y2) (after clamping) */
+		int getCount(int x1, int y1, int x2, int y2) const {
+			if (!clamp(x1, y1, x2, y2)) {return 0;}
+			return (x2-x1) * (y2-y1);
+		}
+
+		/** get the mean of all values within [x1:x2) x [y1:y2) */
+		float getMean(int x1, int y1, int x2, int y2) const {
+			if (!clamp(x1, y1, x2, y2)) {return 0;}
+			return (float) (get(sum, x1, y1, x2, y2) / ((x2-x1) * (y2-y1)));
+		}
+
+		/** get the (population) variance of all values within [x1:x2) x [y1:y2). requires withSquared */
+		float getVariance(int x1, int y1, int x2, int y2) const {
+			_assertTrue(hasSquared(), "squared table not built");
+			if (!clamp(x1, y1, x2, y2)) {return 0;}
+			const double n = (x2-x1) * (y2-y1);
+			const double mean = get(sum, x1, y1, x2, y2) / n;
+			const double var = get(sum2, x1, y1, x2, y2) / n - mean*mean;
+			return (var > 0) ? ((float) var) : (0.0f);
+		}
+
+		/** get the sum of the (2*rx+1) x (2*ry+1) window around (x,y) */
+		double getSumAround(const int x, const int y, const int rx, const int ry) const {
+			return getSum(x-rx, y-ry, x+rx+1, y+ry+1);
+		}
+
+		/** get the mean of the (2*rx+1) x (2*ry+1) window around (x,y) */
+		float getMeanAround(const int x, const int y, const int rx, const int ry) const {
+			return getMean(x-rx, y-ry, x+rx+1, y+ry+1);
+		}
+
+		/** get the variance of the (2*rx+1) x (2*ry+1) window around (x,y) */
+		float getVarianceAround(const int x, const int y, const int rx, const int ry) const {
+			return getVariance(x-rx, y-ry, x+rx+1, y+ry+1);
+		}
+
+	private:
+
+		template <typename Func> void build(const ImageChannel& img, Func func, const bool withSquared) {
+
+			width = img.getWidth();
+			height = img.getHeight();
+			const size_t stride = (size_t) width + 1;
+			sum.assign(stride * ((size_t) height + 1), 0.0);
+			if (withSquared) {sum2.assign(stride * ((size_t) height + 1), 0.0);}
+
+			// each row: running row-sum + the table's row above
+			for (int y = 0; y < height; ++y) {
+				const float* src = img.getData() + (size_t) y * (size_t) width;
+				const double* above = sum.data() + (size_t) y * stride;
+				double* dst = sum.data() + (size_t) (y+1) * stride;
+				double row = 0;
+				double row2 = 0;
+				for (int x = 0; x < width; ++x) {
+					const double v = func(x, y, src[x]);
+					row += v;
+					dst[x+1] = above[x+1] + row;
+					if (withSquared) {
+						row2 += v*v;
+						sum2[(size_t) (y+1) * stride + x + 1] = sum2[(size_t) y * stride + x + 1] + row2;
+					}
+				}
+			}
+
+		}
+
+		/** clamp the rectangle to the image. false if it is empty afterwards */
+		inline bool clamp(int& x1, int& y1, int& x2, int& y2) const {
+			x1 = std::max(x1, 0);		y1 = std::max(y1, 0);
+			x2 = std::min(x2, width);	y2 = std::min(y2, height);
+			return (x1 < x2) && (y1 < y2);
+		}
+
+		/** the sum within the (already clamped) rectangle */
+		inline double get(const std::vector<double>& tbl, const int x1, const int y1, const int x2, const int y2) const {
+			const size_t stride = (size_t) width + 1;
+			return	tbl[(size_t) y2 * stride + x2] - tbl[(size_t) y1 * stride + x2]
+				-	tbl[(size_t) y2 * stride + x1] + tbl[(size_t) y1 * stride + x1];
+		}
+
+	};
+
+}
+
+#endif // K_CV_INTEGRALIMAGE_H
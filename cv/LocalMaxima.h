@@ -2,6 +2,10 @@
 #define K_CV_LOCALMAXIMA_H
 
 #include "ImageChannel.h"
+#include "ImagePoint.h"
+#include "TileExecutor.h"
+
+#include <vector>
 
 namespace K {
 
@@ -36,6 +40,32 @@ namespace K {
 			}
 		}
 
+		/**
+		 * get all local maxima, ordered row by row (like forEach).
+		 * the image is split into bands of rows that are searched in parallel.
+		 * the (usually few) pixels above the threshold are the only ones whose neighborhood is examined
+		 */
+		std::vector<ImagePoint> getAll(const ImageChannel& img, const TileExecutor& exec = TileExecutor()) const {
+
+			const std::vector<TileBand> bands = exec.getBands(img.getHeight(), size);
+			std::vector<std::vector<ImagePoint>> found(bands.size());
+
+			exec.run(bands, [&] (const TileBand& b) {
+				for (int y = b.y0; y < b.y1; ++y) {
+					const float* row = img.getData() + (size_t) y * (size_t) img.getWidth();
+					for (int x = 0; x < img.getWidth(); ++x) {
+						if (row[x] < threshold) {continue;}
+						if (isMaximaUnchecked(img, x, y)) {found[b.idx].push_back(ImagePoint(x,y));}
+					}
+				}
+			});
+
+			std::vector<ImagePoint> res;
+			for (const std::vector<ImagePoint>& vec : found) {res.insert(res.end(), vec.begin(), vec.end());}
+			return res;
+
+		}
+
 		/** is the given point above the threshold and also a local maxima? */
 		bool isMaxima(const ImageChannel& img, const int cx, const int cy) const {
 
@@ -64,6 +94,32 @@ namespace K {
 
 		}
 
+	private:
+
+		/** same as isMaxima() without bound-checked pixel access and without the threshold check */
+		bool isMaximaUnchecked(const ImageChannel& img, const int cx, const int cy) const {
+
+			const int w = img.getWidth();
+			const float* data = img.getData();
+			const float cv = data[(size_t) cy * (size_t) w + (size_t) cx];
+
+			const int x1 = std::max(0, cx-size);
+			const int y1 = std::max(0, cy-size);
+			const int x2 = std::min(w-1, cx+size);
+			const int y2 = std::min(img.getHeight()-1, cy+size);
+
+			// the center itself is never greater than itself
+			for (int y = y1; y <= y2; ++y) {
+				const float* row = data + (size_t) y * (size_t) w;
+				for (int x = x1; x <= x2; ++x) {
+					if (row[x] > cv) {return false;}
+				}
+			}
+
+			return true;
+
+		}
+
 	};
 
 }
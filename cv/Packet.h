@@ -0,0 +1,20 @@
+#ifndef K_CV_PACKET_H
+#define K_CV_PACKET_H
+
+#include <cstdint>
+
+namespace K {
+
+#if defined(__GNUC__)
+	/** several floats at once (GCC/clang vector extension, mapped to SSE/NEON) */
+	typedef float Packet __attribute__((vector_size(16)));
+
+	/** several int32 at once, e.g. the masks yielded by comparing two Packets */
+	typedef int32_t PacketI __attribute__((vector_size(16)));
+
+	#define K_CV_PACKET
+#endif
+
+}
+
+#endif // K_CV_PACKET_H
@@ -0,0 +1,129 @@
+#ifndef K_CV_TILEEXECUTOR_H
+#define K_CV_TILEEXECUTOR_H
+
+#include <vector>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace K {
+
+	/** one band of rows, processed as one task */
+	struct TileBand {
+
+		/** index of the band [0:numBands) */
+		int idx;
+
+		/** the output rows [y0:y1) */
+		int y0;
+		int y1;
+
+		/** the input rows [in0:in1) needed by the filter (output rows + halo, clamped to the image) */
+		int in0;
+		int in1;
+
+	};
+
+	/**
+	 * split an image into bands of rows and process them in parallel.
+	 *
+	 * each band knows the input rows it depends on (its halo, given
+	 * by the filter's radius) and must only write its own output rows.
+	 * the bands are scheduled dynamically on OpenMP's (process-wide)
+	 * thread pool. without OpenMP, all bands run on the calling thread.
+	 */
+	class TileExecutor {
+
+	private:
+
+		/** number of threads to use (0 = all) */
+		int numThreads;
+
+		/** rows per band (0 = auto) */
+		int bandRows;
+
+	public:
+
+		/**
+		 * ctor
+		 * @param numThreads the number of threads to use. 0 = all available cores
+		 * @param bandRows the number of rows per band. 0 = auto (several bands per thread)
+		 */
+		explicit TileExecutor(const int numThreads = 0, const int bandRows = 0) : numThreads(numThreads), bandRows(bandRows) {
+			;
+		}
+
+		/** get the number of threads used for running the bands */
+		int getNumThreads() const {
+#ifdef _OPENMP
+			return (numThreads > 0) ? (numThreads) : (omp_get_max_threads());
+#else
+			return 1;
+#endif
+		}
+
+		/** split the rows [0:height) into bands. halo = the number of rows the filter looks up/down */
+		std::vector<TileBand> getBands(const int height, const int halo) const {
+
+			// several bands per thread for load-balancing
+			int rows = bandRows;
+			if (rows <= 0) {
+				const int tasks = getNumThreads() * 4;
+				rows = std::max(8, (height + tasks - 1) / tasks);
+			}
+
+			std::vector<TileBand> bands;
+			for (int y = 0; y < height; y += rows) {
+				TileBand b;
+				b.idx = (int) bands.size();
+				b.y0 = y;
+				b.y1 = std::min(height, y + rows);
+				b.in0 = std::max(0, b.y0 - halo);
+				b.in1 = std::min(height, b.y1 + halo);
+				bands.push_back(b);
+			}
+			return bands;
+
+		}
+
+		/** run func(const TileBand&) for all bands covering [0:height) */
+		template <typename Func> void run(const int height, const int halo, Func&& func) const {
+			const std::vector<TileBand> bands = getBands(height, halo);
+			run(bands, func);
+		}
+
+		/** run func(const TileBand&) for all the given bands */
+		template <typename Func> void run(const std::vector<TileBand>& bands, Func&& func) const {
+			const int num = (int) bands.size();
+			#pragma omp parallel for schedule(dynamic) num_threads(getNumThreads())
+			for (int i = 0; i < num; ++i) {
+				func(bands[i]);
+			}
+		}
+
+		/** run func(int x, int y) for all pixels of a width x height image, band by band */
+		template <typename Func> void forEachPixel(const int width, const int height, const int halo, Func&& func) const {
+			run(height, halo, [&] (const TileBand& b) {
+				for (int y = b.y0; y < b.y1; ++y) {
+					for (int x = 0; x < width; ++x) {
+						func(x, y);
+					}
+				}
+			});
+		}
+
+		/** run func(int i) for all i within [0:num), e.g. for independent items of a list */
+		template <typename Func> void forEach(const int num, Func&& func) const {
+			#pragma omp parallel for schedule(dynamic) num_threads(getNumThreads())
+			for (int i = 0; i < num; ++i) {
+				func(i);
+			}
+		}
+
+	};
+
+}
+
+#endif // K_CV_TILEEXECUTOR_H
@@ -67,6 +67,11 @@ namespace K {
 			CV::Transform::affine(invMat, src, dst);
 		}
 
+		/** get a remap plan for undo() (bilinear), for transforming many images of the same size. requires estimate() */
+		CV::Remap::Plan getUndoPlan(const int srcW, const int srcH, const int dstW, const int dstH, const TileExecutor& exec = TileExecutor()) const {
+			return CV::Transform::getPlan(invMat, srcW, srcH, dstW, dstH, exec);
+		}
+
 
 
 		/** estimate the Homography based on previously added correspondences */
@@ -5,6 +5,7 @@
 #include "../../../geo/Point2.h"
 #include "../../ImageChannel.h"
 #include "../../filter/Interpolation.h"
+#include "../../filter/Remap.h"
 
 
 namespace K {
@@ -56,48 +57,47 @@ namespace K {
 
 
 		template <typename T> static ImageChannel undistort(const ImageChannel& src, const T* params, const int num) {
-			return apply<true>(src, params, num);
+			return getUndistortPlan(src.getWidth(), src.getHeight(), params, num).apply(src);
 		}
 
 		template <typename T> static ImageChannel distort(const ImageChannel& src, const T* params, const int num) {
-			return apply<false>(src, params, num);
+			return getDistortPlan(src.getWidth(), src.getHeight(), params, num).apply(src);
 		}
 
-	private:
+		/**
+		 * get a remap plan for undistorting images of the given size. for a fixed camera, the
+		 * polynomial is evaluated once per pixel (here) instead of once per pixel and frame
+		 */
+		template <typename T> static CV::Remap::Plan getUndistortPlan(const int w, const int h, const T* params, const int num) {
+			return getPlan<true>(w, h, params, num);
+		}
 
-		template <bool useUndistort, typename T> static ImageChannel apply(const ImageChannel& src, const T* params, const int num) {
+		/** get a remap plan for distorting images of the given size */
+		template <typename T> static CV::Remap::Plan getDistortPlan(const int w, const int h, const T* params, const int num) {
+			return getPlan<false>(w, h, params, num);
+		}
+
+	private:
 
-			const int w = src.getWidth();
-			const int h = src.getHeight();
+		template <bool useUndistort, typename T> static CV::Remap::Plan getPlan(const int w, const int h, const T* params, const int num) {
 
 			const Point2f size((float)w, (float)h);
 			const Point2f offset(0.5f, 0.5f);
 
-			ImageChannel dst(w, h);
+			auto map = [&] (const int x, const int y) {
 
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
+				// map (x,y) to the range [-0.5;+0.5]
+				const Point2f p1 = Point2f((float)x, (float)y) / size - offset;
 
-					// map (x,y) to the range [-0.5;+0.5]
-					const Point2f p1 = Point2f((float)x, (float)y) / size - offset;
+				// undistort/distort and map back to range [0:w] / [0:h]
+				return (useUndistort)
+						? (undistort(p1, params, num) + offset) * size
+						: (distort(p1, params, num) + offset) * size;
 
-					// undistort/distort and map back to range [0:w] / [0:h]
-					const Point2f p2 = (useUndistort)
-							? (undistort(p1, params, num) + offset) * size
-							: (distort(p1, params, num) + offset) * size;
+			};
 
-					// out of bounds?
-					if (std::ceil(p2.x) >= w || std::ceil(p2.y) >= h) {continue;}
-					if (p2.x < 0 || p2.y < 0) {continue;}
-
-					// apply
-					dst.set(x,y, CV::Interpolation::bilinear(src,p2.x,p2.y));
-
-				}
-			}
-
-			// done
-			return dst;
+			// pixels mapped outside of the image remain 0
+			return CV::Remap::Plan(w, h, w, h, map, CV::Remap::SKIP);
 
 		}
 
@@ -3,38 +3,29 @@
 
 #include "Corner.h"
 #include "../ImageChannel.h"
-#include "../Derivative.h"
-#include "../filter/Gauss.h"
-#include "../ImageFactory.h"
 #include "../LocalMaxima.h"
-#include "../segmentation/Segmentation.h"
-#include "../filter/Normalize.h"
+#include "../ConvolveSeparable.h"
+#include "../KernelFactory.h"
+#include "../TileExecutor.h"
+#include "../Packet.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstring>
 
 namespace K {
 
+	/**
+	 * harris corner detection.
+	 *
+	 * the response is calculated strip-wise: for each band of rows, the derivatives,
+	 * the structure tensor products Ix², Iy², IxIy and their gaussian smoothing only
+	 * touch a few (cached) rows, and the bands are processed in parallel.
+	 * the local maxima of the response are also searched in parallel.
+	 */
 	class CornerDetectorHarris {
 
-		/** helper-class to calculate the eigenvalues of a 2x2 matrix */
-		struct Eigenvalues2 {float e1, e2;};
-
-		/** helper-class to calculate the eigenvalues of a 2x2 matrix */
-		struct Matrix2 {
-
-			const float a,b,c,d;
-
-			Matrix2(const float a, const float b, const float c, const float d) : a(a), b(b), c(c), d(d) {;}
-
-			Eigenvalues2 getEigenvalues() const {
-				const float T = a+d;
-				const float D = a*d - b*c;
-				Eigenvalues2 res;
-				res.e1 = T/2 + std::sqrt(T*T/4-D);
-				res.e2 = T/2 - std::sqrt(T*T/4-D);
-				return res;
-			}
-
-		};
-
 	private:
 
 		float threshold;
@@ -42,12 +33,18 @@ namespace K {
 
 		LocalMaxima lMax;
 
+		/** keep only the strongest (well distributed) corners. 0 = all */
+		size_t maxCorners;
+
+		/** the bands to process in parallel */
+		TileExecutor exec;
+
 	public:
 
 
 
 		/** ctor */
-		CornerDetectorHarris() : threshold(0.001f), sigma(1.0f), lMax( int(sigma*2), 0.00001f ) {
+		CornerDetectorHarris() : threshold(0.001f), sigma(1.0f), lMax( int(sigma*2), 0.00001f ), maxCorners(0) {
 			;
 		}
 
@@ -67,71 +64,149 @@ namespace K {
 			this->lMax.setSize(size);
 		}
 
-		/** find all corners within the provided image-channel */
-		std::vector<Corner> getCorners(const ImageChannel& img) {
-
-			// slightly blur the input (remove noise)
-			//Gauss g1(0.75);
-			//ImageChannel img = g1.filter(src);
-
-			// derive the input image in x and y direction -> Ix and Iy
-			ImageChannel imgX = Derivative::getX(img);
-			ImageChannel imgY = Derivative::getY(img);
-
-			// calculate Ix * Iy
-			ImageChannel imgXY(imgX.getWidth(), imgX.getHeight());
-			imgXY.setEach([&] (const int x, const int y) {return imgX.get(x,y) * imgY.get(x,y);});
-
-			// sqaure Ix and Iy (2nd order moments)
-			auto lambda = [] (const int x, const int y, const float val) {(void) x; (void) y; return val*val;};
-			imgX.forEachModify(lambda);
-			imgY.forEachModify(lambda);
-
-			// apply guassian to the derived images (blend possible edges together)
-			CV::Gauss g2(sigma);
-			imgX = g2.filter(imgX);
-			imgY = g2.filter(imgY);
-			imgXY = g2.filter(imgXY);
-
-			// calculate R image
-			ImageChannel imgR(imgX.getWidth(), imgX.getHeight());
-			auto getR = [&] (const int x, const int y) {
-				const Matrix2 m(imgX.get(x,y), imgXY.get(x,y), imgXY.get(x,y), imgY.get(x,y));
-				const Eigenvalues2 ev = m.getEigenvalues();
-				//const float r = ev.e1 - 2.0 * ev.e2;
-				//const float r = std::abs(  ev.e1*ev.e2 - k * ((ev.e1+ev.e2)*(ev.e1+ev.e2))  );
-				const float r = (ev.e1*ev.e2) / (ev.e1+ev.e2);
-				return (r==r && r > threshold) ? (r) : (0);
-			};
-			imgR.setEach(getR);
-			//imgR.normalize();
-
-			// find local maxima within the image
+		/**
+		 * keep only the given number of corners, selected by adaptive non-maximal suppression:
+		 * the corners with the largest distance to the next (significantly) stronger corner.
+		 * yields well-distributed corners instead of clusters around highly textured regions. default: 0 = all
+		 */
+		void setMaxCorners(const size_t maxCorners) {
+			this->maxCorners = maxCorners;
+		}
+
+		/** set the executor used for processing the bands of rows in parallel. default: all cores */
+		void setExecutor(const TileExecutor& exec) {
+			this->exec = exec;
+		}
+
+		/** find all corners within the provided image-channel. the corner's strength is its response */
+		std::vector<Corner> getCorners(const ImageChannel& img) const {
+
+			const ImageChannel imgR = getResponse(img);
+
+			// find local maxima within the response
 			std::vector<Corner> found;
-			ImageChannel imgC(imgX.getWidth(), imgX.getHeight()); imgC.zero();
+			for (const ImagePoint& p : lMax.getAll(imgR, exec)) {
+				found.push_back(Corner(p.x, p.y, imgR.get(p.x, p.y)));
+			}
+
+			if (maxCorners > 0) {found = selectAdaptive(found, maxCorners);}
+			return found;
+
+		}
+
+		/**
+		 * get the corner response det(M) / trace(M) (= e1*e2 / (e1+e2) for M's eigenvalues) of the
+		 * gaussian smoothed structure tensor M for each pixel. values below the threshold are 0
+		 */
+		ImageChannel getResponse(const ImageChannel& img) const {
+
+			const int w = img.getWidth();
+			const int h = img.getHeight();
+			ImageChannel imgR(w, h);
+			if (w == 0 || h == 0) {return imgR;}
+
+			const Kernel kH = KernelFactory::gauss1D(sigma);
+			Kernel kV = KernelFactory::gauss1D(sigma); kV.tilt();
+
+			exec.run(h, kV.getHeight() / 2, [&] (const TileBand& b) {
+
+				// all rows needed by the smoothing of the band (strip coordinates: row - b.in0)
+				const int sh = b.in1 - b.in0;
+				ImageChannel xx(w, sh), yy(w, sh), xy(w, sh);
+				for (int y = b.in0; y < b.in1; ++y) {
+					tensorRow(img, y, xx.getData() + (size_t) (y-b.in0) * (size_t) w, yy.getData() + (size_t) (y-b.in0) * (size_t) w, xy.getData() + (size_t) (y-b.in0) * (size_t) w);
+				}
+
+				// smooth the band's rows. taps outside of the strip are outside of the image
+				ImageChannel gxx(w, sh), gyy(w, sh), gxy(w, sh);
+				ConvolveSeparable::convolveRows(xx, gxx, kH, kV, true, b.y0 - b.in0, b.y1 - b.in0);
+				ConvolveSeparable::convolveRows(yy, gyy, kH, kV, true, b.y0 - b.in0, b.y1 - b.in0);
+				ConvolveSeparable::convolveRows(xy, gxy, kH, kV, true, b.y0 - b.in0, b.y1 - b.in0);
+
+				for (int y = b.y0; y < b.y1; ++y) {
+					const size_t off = (size_t) (y - b.in0) * (size_t) w;
+					responseRow(gxx.getData() + off, gyy.getData() + off, gxy.getData() + off, imgR.getData() + (size_t) y * (size_t) w, w, threshold);
+				}
 
-			lMax.forEach(imgR, [&] (const int x, const int y) {
-				found.push_back(Corner(x,y,0));
-				imgC.set(x,y,1);
 			});
 
-			CV::Normalize::inplace(imgX);
-			CV::Normalize::inplace(imgY);
-			CV::Normalize::inplace(imgXY);
-			CV::Normalize::inplace(imgR);
-
-#ifdef WITH_PNG
-			ImageFactory::writePNG("/tmp/i.png", img);
-			ImageFactory::writePNG("/tmp/ix.png", imgX);
-			ImageFactory::writePNG("/tmp/iy.png", imgY);
-			ImageFactory::writePNG("/tmp/ixy.png", imgXY);
-			ImageFactory::writePNG("/tmp/ir.png", imgR);
-			ImageFactory::writePNG("/tmp/ic.png", imgC);
-#endif
-			// find corners
+			return imgR;
 
-			return found;
+		}
+
+		/**
+		 * adaptive non-maximal suppression: for each corner, the suppression radius is the distance
+		 * to the nearest corner that is stronger by the given factor. returns the k corners with
+		 * the largest radius (the strongest corner first)
+		 */
+		static std::vector<Corner> selectAdaptive(std::vector<Corner> corners, const size_t k, const float robust = 0.9f) {
+
+			if (corners.size() <= k) {return corners;}
+
+			std::stable_sort(corners.begin(), corners.end(), [] (const Corner& a, const Corner& b) {return a.strength > b.strength;});
+
+			// only stronger corners (= all before i) may suppress corner i
+			const int n = (int) corners.size();
+			std::vector<float> radius2(n, std::numeric_limits<float>::infinity());
+			#pragma omp parallel for schedule(dynamic, 64)
+			for (int i = 1; i < n; ++i) {
+				const Corner& ci = corners[i];
+				float best = std::numeric_limits<float>::infinity();
+				for (int j = 0; j < i; ++j) {
+					if (ci.strength >= robust * corners[j].strength) {break;}		// sorted -> all others are not strong enough
+					const float dx = (float) (ci.x - corners[j].x);
+					const float dy = (float) (ci.y - corners[j].y);
+					best = std::min(best, dx*dx + dy*dy);
+				}
+				radius2[i] = best;
+			}
+
+			std::vector<int> idx(n);
+			for (int i = 0; i < n; ++i) {idx[i] = i;}
+			std::stable_sort(idx.begin(), idx.end(), [&] (const int a, const int b) {return radius2[a] > radius2[b];});
 
+			std::vector<Corner> res;
+			for (size_t i = 0; i < k; ++i) {res.push_back(corners[idx[i]]);}
+			return res;
+
+		}
+
+	private:
+
+		/** Ix², Iy² and IxIy for one row (forward differences, like Derivative::getX/getY) */
+		static void tensorRow(const ImageChannel& img, const int y, float* xx, float* yy, float* xy) {
+			const int w = img.getWidth();
+			const float* row = img.getData() + (size_t) y * (size_t) w;
+			const float* next = (y < img.getHeight() - 1) ? (row + w) : (nullptr);
+			for (int x = 0; x < w; ++x) {
+				const float dx = (x < w - 1) ? (row[x+1] - row[x]) : (0.0f);
+				const float dy = (next) ? (next[x] - row[x]) : (0.0f);
+				xx[x] = dx*dx;
+				yy[x] = dy*dy;
+				xy[x] = dx*dy;
+			}
+		}
+
+		/** the response for one row. NaN (empty tensor) and values below the threshold become 0 */
+		static void responseRow(const float* a, const float* c, const float* b, float* out, const int w, const float threshold) {
+			int x = 0;
+#ifdef K_CV_PACKET
+			constexpr int lanes = (int) (sizeof(Packet) / sizeof(float));
+			for (; x + lanes <= w; x += lanes) {
+				Packet pa, pb, pc;
+				std::memcpy(&pa, a + x, sizeof(Packet));
+				std::memcpy(&pb, b + x, sizeof(Packet));
+				std::memcpy(&pc, c + x, sizeof(Packet));
+				const Packet r = (pa*pc - pb*pb) / (pa + pc);
+				const PacketI keep = (r > threshold);			// false for NaN
+				const Packet res = (Packet) ((PacketI) r & keep);
+				std::memcpy(out + x, &res, sizeof(Packet));
+			}
+#endif
+			for (; x < w; ++x) {
+				const float r = (a[x]*c[x] - b[x]*b[x]) / (a[x] + c[x]);
+				out[x] = (r > threshold) ? (r) : (0.0f);
+			}
 		}
 
 	};
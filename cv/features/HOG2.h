@@ -16,6 +16,15 @@
 #include "../../geo/Size2.h"
 #include "../../geo/Point2.h"
 
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_HOG2_X86_SIMD
+#endif
+
 
 namespace K {
 
@@ -50,16 +59,6 @@ namespace K {
 
 	public:
 
-		enum Pattern {
-			RECTANGULAR,
-			CIRCULAR,
-		};
-
-		struct CellPoint : public ImagePoint {
-			float impact;			// from gaussian, to downweight edge-pixels
-			CellPoint(const int x, const int y, const float impact) : ImagePoint(x,y), impact(impact) {;}
-		};
-
 		struct Contribution {
 			int bin;
 			float weight;
@@ -185,11 +184,12 @@ namespace K {
 		/** downweight each block's edge pixels [more importance to the center] */
 		K::Kernel gauss;
 
-		/** histogram for each cell */
-		DataMatrix<Vector> cells;
+		/** the image's size */
+		int width;
+		int height;
 
-		/** histogram for each block [multiple cells] */
-		DataMatrix<Vector> blocks;
+		/** histogram for each cell, one cell centered at every pixel: [(y*width + x) * bins + bin] */
+		std::vector<float> cells;
 
 
 	public:
@@ -216,19 +216,28 @@ namespace K {
 		}
 
 		/** get the histogram for the cell around [=centered at] (x,y) */
-		const Vector& getCell(const int x, const int y) const {
-			//if (x % stride != 0) {throw Exception("x-coordinate must be a multiple of the stride-size");}
-			//if (y % stride != 0) {throw Exception("y-coordinate must be a multiple of the stride-size");}
+		Vector getCell(const int x, const int y) const {
 			if ((x < cellSize.w / 2) || (y < cellSize.h / 2)) {throw Exception("block position out of bounds");}
-			return cells.getConstRef(x/stride, y/stride);
+			const float* cell = getCellData(x, y);
+			Vector res;
+			res.assign(cell, cell + bins);
+			return res;
 		}
 
-		/** get the historgram for the block around [=centered at] (x,y) */
-		const Vector& getBlock(const int x, const int y) const {
-			//if (x % stride != 0) {throw Exception("x-coordinate must be a multiple of the stride-size");}
-			//if (y % stride != 0) {throw Exception("y-coordinate must be a multiple of the stride-size");}
+		/** get the histogram for the cell around [=centered at] (x,y) without copying it */
+		const float* getCellData(const int x, const int y) const {
+			if (x < 0 || y < 0 || x >= width || y >= height) {throw Exception("cell position out of bounds");}
+			return cells.data() + ((size_t) y * (size_t) width + (size_t) x) * (size_t) bins;
+		}
+
+		/** get the (normalized) historgram for the block around [=centered at] (x,y). empty if the block exceeds the image */
+		Vector getBlock(const int x, const int y) const {
 			if ((x < blockSize.w / 2) || (y < blockSize.h / 2)) {throw Exception("window position out of bounds");}
-			return blocks.getConstRef(x/stride, y/stride);
+			Vector block;
+			if (!isBlockWithin(x, y)) {return block;}
+			block.resize(valuesPerBlock);
+			fillBlock(x, y, block.data());
+			return block;
 		}
 
 
@@ -236,52 +245,74 @@ namespace K {
 		/** get a feature-vector for the given location (x,y) = center and size(w,h) */
 		Vector getFeature(const Point2i pos, const Size2i winSize, const Size2i blockStride = Size2i(8,8)) const {
 
-			//const int x = pos.x;
-			//const int y = pos.y;
-
-			const int w = winSize.w;
-			const int h = winSize.h;
+			Vector feature;
+			feature.resize(getFeatureLength(winSize, blockStride));
+			const Area a = Area(pos, blockSize, winSize, blockStride);
+			if (!isWindowWithin(a)) {throw Exception("window exceeds the image");}
+			fillFeature(a, feature.data());
+			return feature;
 
-			// sanity checks
-			//if (x % stride != 0)	{throw Exception("x-coordinate must be a multiple of the stride-size");}
-			//if (y % stride != 0)	{throw Exception("y-coordinate must be a multiple of the stride-size");}
+		}
 
-			if (w % cellSize.w != 0)	{throw Exception("window-width must be a multiple of the cell-width");}
-			if (h % cellSize.h != 0)	{throw Exception("window-height must be a multiple of the cell-height");}
+		/** get the number of values within the feature-vector for the given window-size and block-stride */
+		int getFeatureLength(const Size2i winSize, const Size2i blockStride = Size2i(8,8)) const {
 
+			// sanity checks
+			if (winSize.w % cellSize.w != 0)	{throw Exception("window-width must be a multiple of the cell-width");}
+			if (winSize.h % cellSize.h != 0)	{throw Exception("window-height must be a multiple of the cell-height");}
 			if ((winSize.w - blockSize.w) % blockStride.w != 0) {throw Exception("err");}
 			if ((winSize.h - blockSize.h) % blockStride.h != 0) {throw Exception("err");}
 
-			//if (windowSize != 2*blockSize) {throw Exception("not yet supported!");}
+			const Area a = Area(Point2i(0,0), blockSize, winSize, blockStride);
+			return a.wx * a.wy * valuesPerBlock;
 
-			const Area a = Area(pos, blockSize, winSize, blockStride);
+		}
 
-			const size_t reserve = a.wx*a.wy*valuesPerBlock;
+		/**
+		 * get the feature-vectors for all given window centers at once.
+		 * row i of the returned matrix (width = feature length) is the feature for positions[i]
+		 */
+		DataMatrix<float> getFeatures(const std::vector<Point2i>& positions, const Size2i winSize, const Size2i blockStride = Size2i(8,8)) const {
 
-			//Vector feature(reserve);
-			Vector feature;
-			feature.resize(reserve);
-			float* data = feature.data();
+			const int len = getFeatureLength(winSize, blockStride);
+			DataMatrix<float> res(len, (int) positions.size());
 
-			for (int y = 0; y < a.wy; ++y) {
-				for (int x = 0; x < a.wx; ++x) {
+			// check all windows upfront (no exceptions within the parallel loop)
+			for (const Point2i pos : positions) {
+				if (!isWindowWithin(Area(pos, blockSize, winSize, blockStride))) {throw Exception("window exceeds the image");}
+			}
 
-					const Point2i pt = a.getBlockCenter(x, y);
+			#pragma omp parallel for schedule(dynamic, 16)
+			for (int i = 0; i < (int) positions.size(); ++i) {
+				fillFeature(Area(positions[i], blockSize, winSize, blockStride), res.getData() + (size_t) i * (size_t) len);
+			}
 
-					const Vector& block = getBlock(pt.x, pt.y);
-					_assertNot0(block.size(), "invalid number of values in window detected");
+			return res;
 
-					//feature.insert(feature.end(), block.begin(), block.end());
-					memcpy(data, block.data(), block.size()*sizeof(float));
-					data += block.size();
+		}
 
-				}
+		/**
+		 * gaussian impact for each pixel column (or row) of a cell with the given size, downweighting its edge-pixels.
+		 * the pattern is symmetric, also for even sizes [no real center]. a pixel's impact is impactX * impactY
+		 */
+		std::vector<float> getCellImpact(const int size) const {
+			std::vector<float> res;
+			for (int i = -half(size); i < size - half(size); ++i) {
+				const float d = (float)i + ( (size % 2 == 0) ? 0.5f : 0.0f );
+				res.push_back(std::exp( - (d*d) / (2.0f*sigma*sigma) ));
 			}
+			return res;
+		}
 
-			_assertEqual(reserve, feature.size(), "invalid feature size");
-
-			return feature;
-
+		/** all window centers (with the given stride) where the window fits into the image, e.g. for getFeatures() */
+		std::vector<Point2i> getWindowCenters(const Size2i winSize, const Size2i stride = Size2i(8,8)) const {
+			std::vector<Point2i> res;
+			for (int y = half(winSize.h); y <= height - half(winSize.h); y += stride.h) {
+				for (int x = half(winSize.w); x <= width - half(winSize.w); x += stride.w) {
+					res.push_back(Point2i(x, y));
+				}
+			}
+			return res;
 		}
 
 
@@ -326,291 +357,175 @@ namespace K {
 
 		/** perform one-time calculations for fast lookups */
 		void precalc(const ImageChannel& img) {
+			width = img.getWidth();
+			height = img.getHeight();
 			buildCells(img);
-			buildBlocks(img);
 		}
 
 		/**
-		 * step1)
-		 * calculate HOG cells [usually 8x8] around each "pixel" of the input image
-		 * TODO: do not calculate for each pixel [++i] but for [i+=stride]
-		 * that will be used during the matching phase. this is less accurate but faster
+		 * calculate the HOG cell [usually 8x8] around each pixel of the input image.
+		 *
+		 * each pixel's gradient is converted to its (max 2) bin-contributions only once.
+		 * as the impact of each pixel within a cell is a (separable) gaussian, all cells
+		 * are then given by a separable convolution (vertical, then horizontal) of the
+		 * per-pixel contributions, processing all bins of a row at once.
 		 */
 		void buildCells(const ImageChannel& img) {
 
-			const int w = img.getWidth();
-			const int h = img.getHeight();
+			const int w = width;
+			const int h = height;
+			const size_t rowLen = (size_t) w * (size_t) bins;
 
-			// number of blocks to calculate
-			const int nx = img.getWidth() / stride;
-			const int ny = img.getHeight() / stride;
+			cells.assign(rowLen * (size_t) h, 0.0f);
+			if (w == 0 || h == 0) {return;}
 
 			// get derivative images (x and y)
 			const K::ImageChannel imgX = Derivative::getXcen(img);		// [-1: 0: +1]
 			const K::ImageChannel imgY = Derivative::getYcen(img);		// [-1: 0: +1]
 
-			// buffer containing HOG-Block-Histogram for every stride-th-pixel within the image
-			cells = DataMatrix<Vector>(nx, ny);
-
-			// list of all pixels that belong to a HOG-window (centered at 0,0)
-			const std::vector<CellPoint> region = getCellPoints(Pattern::RECTANGULAR);
-
-			// border to skip [half block size]
-			const int w2 = half(cellSize.w);
-			const int h2 = half(cellSize.h);
-
-			// build HOG-Histogram for each block centered at (x,y) with stride-th increment
-			for (int y = h2; y <= h-h2; y += stride) {
-
-				#pragma omp parallel for
-				for (int x = w2; x <= w-w2; x += stride) {
-					cells.set(x/stride, y/stride, getHistogram(imgX, imgY, x,y, region));
+			// per-pixel bin-contributions
+			std::vector<float> contrib(rowLen * (size_t) h, 0.0f);
+			#pragma omp parallel for
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x) {
+					const float dx = imgX.get(x, y);
+					const float dy = imgY.get(x, y);
+					const float mag = std::sqrt( (dx*dx) + (dy*dy) );		// gradient's overall magnitude
+					const float deg = atan360(dy, dx) * 180.0f / (float)M_PI;	// the gradient's direction in degree
+					const Contributions c = getContribution(deg, mag);
+					float* dst = contrib.data() + (size_t) y * rowLen + (size_t) x * (size_t) bins;
+					dst[c.c1.bin] += c.c1.weight;	// split contribution
+					dst[c.c2.bin] += c.c2.weight;
 				}
-
 			}
 
-		}
-
-		/**
-		 * step2)
-		 * calculate HOG blocks [=several cells] [usually 16x16 (or 2x2 cells)] around each "pixel" of the input image
-		 */
-		void buildBlocks(const ImageChannel& img) {
-
-			//if (windowSize != 2*blockSize) {throw Exception("not yet supported!");}
-
-			const int w = img.getWidth();
-			const int h = img.getHeight();
-
-			// number of windows to calculate
-			const int nx = img.getWidth() / stride;
-			const int ny = img.getHeight() / stride;
-
-			// buffer containing HOG-Window-Vector for every stride-th-pixel within the image
-			blocks = DataMatrix<Vector>(nx, ny);
-
-			const int bsw2 = half(blockSize.w);
-			const int bsh2 = half(blockSize.h);
-
-			// build combined/normalized Histogram for each Window centered at (x,y)
-			for (int y = bsh2; y <= h-bsh2; y += stride) {
-
-				#pragma omp parallel for
-				for (int x = bsw2; x <= w-bsw2; x += stride) {
-
-					// upper left coordinate for the area-of-interest
-					const int sx = x - half(blockSize.w);
-					const int sy = y - half(blockSize.h);
-
-					// first block's center
-					const int cx = sx + half(cellSize.w);
-					const int cy = sy + half(cellSize.h);
-
-					// number of cells within each block
-					const int cellsX = blockSize.w / cellSize.w;
-					const int cellsY = blockSize.h / cellSize.h;
-
-					// build the block
-					const size_t reserve = cellsX*cellsY*bins;
-					//Vector block(reserve);
-					Vector block;
-					block.resize(reserve);
-					float* data = block.data();
-
-					// fetch each cell that belongs to the block
-					for (int y1 = 0; y1 < cellsY; ++y1) {
-						for (int x1 = 0; x1 < cellsX; ++x1) {
-
-							const int xx = cx + x1*cellSize.w;
-							const int yy = cy + y1*cellSize.h;
-
-							const Vector& cell = getCell(xx, yy);
-							//block.insert(block.end(), cell.begin(), cell.end());
-							memcpy(data, cell.data(), cell.size()*sizeof(float));
-							data += cell.size();
+			// the cell's pixels relative to its center and their separable impact
+			const int sw2 = half(cellSize.w);
+			const int sh2 = half(cellSize.h);
+			const int ew2 = sw2 + ( (cellSize.w % 2 == 1) ? 1 : 0);
+			const int eh2 = sh2 + ( (cellSize.h % 2 == 1) ? 1 : 0);
+			const std::vector<float> impactX = getCellImpact(cellSize.w);
+			const std::vector<float> impactY = getCellImpact(cellSize.h);
 
-						}
+			// cells are calculated for all centers within [w2:w-w2] x [h2:h-h2], all others remain 0
+			const int w2 = half(cellSize.w);
+			const int h2 = half(cellSize.h);
+			const int x0 = w2;
+			const int x1 = std::min(w - 1, w - w2);
+
+			#pragma omp parallel
+			{
+				std::vector<float> rowV(rowLen);
+
+				#pragma omp for schedule(dynamic, 8)
+				for (int y = h2; y <= std::min(h - 1, h - h2); ++y) {
+
+					// vertical pass: all pixels within the image
+					std::fill(rowV.begin(), rowV.end(), 0.0f);
+					for (int j = -sh2; j < eh2; ++j) {
+						const int iy = y + j;
+						if (iy < 0 || iy >= h) {continue;}
+						axpy(rowV.data(), contrib.data() + (size_t) iy * rowLen, rowLen, impactY[j + sh2]);
 					}
 
-					_assertEqual(reserve, block.size(), "invalid number of entries in block");
-
-					// normalize the window
-					block.normalize();
-
-					// store
-					blocks.set(x/stride, y/stride, block);
+					// horizontal pass: for each offset, all cells whose pixel is within the image
+					float* out = cells.data() + (size_t) y * rowLen;
+					for (int i = -sw2; i < ew2; ++i) {
+						const int xs = std::max(x0, -i);
+						const int xe = std::min(x1, w - 1 - i);
+						if (xs > xe) {continue;}
+						axpy(out + (size_t) xs * (size_t) bins, rowV.data() + (size_t) (xs + i) * (size_t) bins, (size_t) (xe - xs + 1) * (size_t) bins, impactX[i + sw2]);
+					}
 
 				}
 			}
 
 		}
 
-//		/** convert gradients to histogram */
-//		Vector getHistogram(const std::vector<HOGGradient>& gradients) {
-
-//			Vector res(bins);
-//			res.resize(bins);
-
-//			for (const HOGGradient& hg : gradients) {
-
-//				const float deg = hg.direction * 180.0f / (float)M_PI;
-//				const Contributions c = getContribution(deg, hg.magnitude);
-
-//				if (1 == 1) {
-//					res[c.c1.bin] += c.c1.weight;	// split contribution
-//					res[c.c2.bin] += c.c2.weight;
-//				} else {
-//					res[c.c1.bin] += c.c1.weight;	// both to the same bin
-//					res[c.c1.bin] += c.c2.weight;	// both to the same bin
-//				}
-
-//			}
-
-//			return res;
-
-//		}
-
-
-
-//		/** get all individual gradients at the given location */
-//		std::vector<HOGGradient> getGradients(const K::ImageChannel& imgX, const K::ImageChannel& imgY, const int x, const int y, const std::vector<ImagePoint>& region) const {
-
-//			std::vector<HOGGradient> gradients(bins);
-
-//			for (size_t i = 0; i < region.size(); ++i) {
-
-//				const ImagePoint p = region[i];
-
-//				// point within the image
-//				const int x1 = x+p.x;
-//				const int y1 = y+p.y;
-
-//				// clamp
-//				if (x1 < 0 || x1 >= imgX.getWidth())	{continue;}
-//				if (y1 < 0 || y1 >= imgX.getHeight())	{continue;}
-
-//				// calculate the centered derivatives
-//				const auto dx = imgX.get(x1, y1);	// gradient's magnitude in x direction
-//				const auto dy = imgY.get(x1, y1);	// gradient's magnitude in y direction
-
-//				// calculate magnitude and direction of the gradient
-//				HOGGradient grad;
-//				grad.magnitude = std::sqrt( (dx*dx) + (dy*dy) );		// gradient's overall magnitude
-//				grad.direction = atan360(dy, dx);						// the gradient's direction
-
-//				gradients.push_back(grad);
-
-//			}
-
-//			return gradients;
-
-//		}
-
-
-
-		/** get all individual gradients at the given location */
-		Vector getHistogram(const K::ImageChannel& imgX, const K::ImageChannel& imgY, const int x, const int y, const std::vector<CellPoint>& region) const {
-
-			// output histogram
-			Vector res;
-			res.resize(bins);
-
-			// process each pixel
-			for (size_t i = 0; i < region.size(); ++i) {
-
-				const CellPoint p = region[i];
-
-				// point within the image
-				const int x1 = x+p.x;
-				const int y1 = y+p.y;
+		/** is the block centered at (x,y) fully covered by calculated cells? */
+		bool isBlockWithin(const int x, const int y) const {
+			return	(x >= half(blockSize.w)) && (y >= half(blockSize.h)) &&
+					(x <= width - half(blockSize.w)) && (y <= height - half(blockSize.h)) &&
+					(x < width) && (y < height);
+		}
 
-				// clamp
-				if (x1 < 0 || x1 >= imgX.getWidth())	{continue;}
-				if (y1 < 0 || y1 >= imgX.getHeight())	{continue;}
+		/** are all blocks of the given window within the image? */
+		bool isWindowWithin(const Area& a) const {
+			const Point2i first = a.getBlockCenter(0, 0);
+			const Point2i last = a.getBlockCenter(a.wx - 1, a.wy - 1);
+			return isBlockWithin(first.x, first.y) && isBlockWithin(last.x, last.y);
+		}
 
-				// calculate the centered derivatives
-				const auto dx = imgX.get(x1, y1);	// gradient's magnitude in x direction
-				const auto dy = imgY.get(x1, y1);	// gradient's magnitude in y direction
+		/** concatenate all cells of the block centered at (x,y) into dst and normalize them */
+		void fillBlock(const int x, const int y, float* dst) const {
 
-				// calculate magnitude and direction of the gradient
-				const float mag = std::sqrt( (dx*dx) + (dy*dy) );		// gradient's overall magnitude
-				const float dir = atan360(dy, dx);						// the gradient's direction in radians
-				const float deg = dir * 180.0f / (float)M_PI;			// in degree
+			// first cell's center
+			const int cx = x - half(blockSize.w) + half(cellSize.w);
+			const int cy = y - half(blockSize.h) + half(cellSize.h);
 
-				// calculate bin-contribution [max 2 bins]
-				// hereby add the impact factor based on the blur-window
-				const Contributions c = getContribution(deg, mag * p.impact);
+			// number of cells within each block
+			const int cellsX = blockSize.w / cellSize.w;
+			const int cellsY = blockSize.h / cellSize.h;
 
-				if (1 == 1) {
-					res[c.c1.bin] += c.c1.weight;	// split contribution
-					res[c.c2.bin] += c.c2.weight;
-				} else {
-					res[c.c1.bin] += c.c1.weight;	// both to the same bin
-					res[c.c1.bin] += c.c2.weight;	// both to the same bin
+			float* data = dst;
+			for (int y1 = 0; y1 < cellsY; ++y1) {
+				for (int x1 = 0; x1 < cellsX; ++x1) {
+					memcpy(data, getCellData(cx + x1*cellSize.w, cy + y1*cellSize.h), (size_t) bins * sizeof(float));
+					data += bins;
 				}
-
 			}
 
-			// done
-			return res;
+			// normalize (see Vector::normalize)
+			float length = 0;
+			for (int i = 0; i < valuesPerBlock; ++i) {length += dst[i]*dst[i];}
+			length += 0.2f;
+			length = std::sqrt(length);
+			for (int i = 0; i < valuesPerBlock; ++i) {dst[i] /= length;}
 
 		}
 
-
-	public:
-
-		/** a list of all pixels within a cell. (0,0) = cell-center */
-		std::vector<CellPoint> getCellPoints(const Pattern p) const {
-
-			std::vector<CellPoint> region;
-
-			CellPoint dst(0,0,0);
-			const ImagePoint center(0,0);
-
-			if (p == CIRCULAR && cellSize.w != cellSize.h) {
-				throw Exception("CIRCULAR pattern requires cellSize.w == cellSize.h");
+		/** concatenate all (normalized) blocks of the given window into dst */
+		void fillFeature(const Area& a, float* dst) const {
+			for (int y = 0; y < a.wy; ++y) {
+				for (int x = 0; x < a.wx; ++x) {
+					const Point2i pt = a.getBlockCenter(x, y);
+					fillBlock(pt.x, pt.y, dst);
+					dst += valuesPerBlock;
+				}
 			}
+		}
 
-			const int sw2 = half(cellSize.w);
-			const int sh2 = half(cellSize.w);
-
-			// if the cell-size is odd, the end is included -> +1
-			const int ew2 = sw2 + ( (cellSize.w % 2 == 1) ? 1 : 0);
-			const int eh2 = sh2 + ( (cellSize.h % 2 == 1) ? 1 : 0);
-
-
-			// process a square region...
-			for (dst.y = -sh2; dst.y < +eh2; ++dst.y) {
-				for (dst.x = -sw2; dst.x < +ew2; ++dst.x) {
-
-
-					// impact factor based on sigma and distance from center
-					// ensure the impact pattern is symmetric, also for even block sizes [no real center]
-					const float dx = (float)dst.x + ( (cellSize.w % 2 == 0) ? 0.5f : 0.0f );
-					const float dy = (float)dst.y + ( (cellSize.h % 2 == 0) ? 0.5f : 0.0f );
-					dst.impact = std::exp( - ((dx*dx) + (dy*dy)) / (2.0f*sigma*sigma) );
-
-
-					// pattern?
-					if (p == RECTANGULAR) {
-						region.push_back(dst);
-					} else if (p == CIRCULAR) {
-						// ...but use only points within a radius around the center
-						const float d = center.distance(dst);
-						if (d <= cellSize.w) {region.push_back(dst);}
-					}
+		/** dst += k * src */
+		static void axpy(float* dst, const float* src, const size_t num, const float k) {
+			size_t i = 0;
+#ifdef K_HOG2_X86_SIMD
+			static const bool avx = hasAVX();
+			if (avx) {i = axpyAVX(dst, src, num, k);}
+#endif
+			for (; i < num; ++i) {dst[i] += k * src[i];}
+		}
 
-					std::cout << dst.x << "," << dst.y << ":" << dst.impact << "\t";
+#ifdef K_HOG2_X86_SIMD
 
-				}
-				std::cout << std::endl;
+		static bool hasAVX() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx");
+		}
 
+		/** 8 values at once. returns the first unprocessed index */
+		__attribute__((target("avx")))
+		static size_t axpyAVX(float* dst, const float* src, const size_t num, const float k) {
+			const __m256 vk = _mm256_set1_ps(k);
+			size_t i = 0;
+			for (; i + 8 <= num; i += 8) {
+				const __m256 v = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(vk, _mm256_loadu_ps(src + i)));
+				_mm256_storeu_ps(dst + i, v);
 			}
-
-			return region;
-
+			return i;
 		}
 
+#endif
+
 	};
 
 }
@@ -88,6 +88,9 @@ namespace K {
 			const K::ImageChannel imgX = K::Derivative::getXcen(img);
 			const K::ImageChannel imgY = K::Derivative::getYcen(img);
 
+			// O(1) moments for each cell
+			const MomentsIntegral moments(img);
+
 			// process every pixel within the image
 			for (int y = 0; y < img.getHeight(); ++y) {
 
@@ -150,8 +153,8 @@ namespace K {
 						}
 					}
 
-					p.m00 = Moments::get<0,0>(img, Point2i(x,y), cellSize);
-					p.m11 = Moments::get<1,1>(img, Point2i(x,y), cellSize);
+					p.m00 = moments.get<0,0>(Point2i(x,y), cellSize);
+					p.m11 = moments.get<1,1>(Point2i(x,y), cellSize);
 
 
 					const float pxAvg = pxSum/pxCnt;
@@ -4,6 +4,7 @@
 #include "../ImageChannel.h"
 #include "../../geo/Point2.h"
 #include "../../geo/Size2.h"
+#include "../IntegralImage.h"
 
 namespace K {
 
@@ -23,7 +24,7 @@ namespace K {
 
 			for (int oy = y1; oy < y2; ++oy) {
 
-				#pragma omp parallel for
+				#pragma omp parallel for reduction(+:sum)
 				for (int ox = x1; ox < x2; ++ox) {
 
 					const int x = center.x + ox;
@@ -47,7 +48,7 @@ namespace K {
 
 			float sum = 0;
 
-			#pragma omp parallel for
+			#pragma omp parallel for reduction(+:sum)
 			for (size_t i = 0; i < offsets.size(); ++i) {
 
 				const Point2i offset = offsets[i];
@@ -75,6 +76,62 @@ namespace K {
 
 	};
 
+	/**
+	 * O(1) moments of rectangular windows (same as Moments::get with a window)
+	 * using integral images of img, x*img, y*img and x*y*img.
+	 * supports the orders p,q within [0:1]. coordinates are relative to the
+	 * image's center to keep the double-precision sums accurate.
+	 */
+	class MomentsIntegral {
+
+	private:
+
+		/** the image's center (origin of the coordinates within the tables) */
+		int cx;
+		int cy;
+
+		/** integral images of x^k * y^l * img for (k,l) = (0,0), (1,0), (0,1), (1,1) */
+		IntegralImage s00;
+		IntegralImage s10;
+		IntegralImage s01;
+		IntegralImage s11;
+
+	public:
+
+		/** ctor */
+		explicit MomentsIntegral(const ImageChannel& img) :
+			cx(img.getWidth()/2), cy(img.getHeight()/2),
+			s00(img),
+			s10(img, [this] (const int x, const int y, const float v) {(void) y; return (double) (x-cx) * v;}),
+			s01(img, [this] (const int x, const int y, const float v) {(void) x; return (double) (y-cy) * v;}),
+			s11(img, [this] (const int x, const int y, const float v) {return (double) (x-cx) * (double) (y-cy) * v;}) {
+			;
+		}
+
+		template <int p, int q> float get(const Point2i center, const Size2i window) const {
+
+			static_assert(p >= 0 && p <= 1 && q >= 0 && q <= 1, "only orders 0 and 1 are supported");
+
+			// the window [x1:x2) x [y1:y2)
+			const int x1 = center.x - window.w/2;
+			const int x2 = center.x + (window.w+1)/2;
+			const int y1 = center.y - window.h/2;
+			const int y2 = center.y + (window.h+1)/2;
+
+			// Moments::get weights with (x - center.x - w/2)^p * (y - center.y - h/2)^q
+			const double a = center.x + window.w/2 - cx;
+			const double b = center.y + window.h/2 - cy;
+
+			const double m00 = s00.getSum(x1, y1, x2, y2);
+			if (p == 0 && q == 0) {return (float) m00;}
+			if (p == 1 && q == 0) {return (float) (s10.getSum(x1, y1, x2, y2) - a * m00);}
+			if (p == 0 && q == 1) {return (float) (s01.getSum(x1, y1, x2, y2) - b * m00);}
+			return (float) (s11.getSum(x1, y1, x2, y2) - a * s01.getSum(x1, y1, x2, y2) - b * s10.getSum(x1, y1, x2, y2) + a * b * m00);
+
+		}
+
+	};
+
 }
 
 #endif // MOMENTS_H
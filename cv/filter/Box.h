@@ -0,0 +1,54 @@
+#ifndef K_CV_BOX_H
+#define K_CV_BOX_H
+
+#include "../ImageChannel.h"
+#include "../IntegralImage.h"
+#include "../TileExecutor.h"
+
+namespace K {
+
+	namespace CV {
+
+		/**
+		 * box (mean) filter using an integral image.
+		 * the runtime does not depend on the window's size.
+		 * along the edges, only the pixels within the image are averaged
+		 */
+		class Box {
+
+		public:
+
+			/** apply a sx*sy box-filter to the given image */
+			static ImageChannel apply(const ImageChannel& img, const int sx = 3, const int sy = 3) {
+				ImageChannel res(img.getWidth(), img.getHeight());
+				apply(img, res, TileExecutor(), sx, sy);
+				return res;
+			}
+
+			/** apply a sx*sy box-filter to the given image, using the bands of the given executor. dst must have the same size as img */
+			static void apply(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec, const int sx = 3, const int sy = 3) {
+
+				_assertTrue(sx % 2 == 1, "sx must be odd");
+				_assertTrue(sy % 2 == 1, "sy must be odd");
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+
+				const IntegralImage ii(img);
+				const int rx = sx/2;
+				const int ry = sy/2;
+
+				exec.run(img.getHeight(), ry, [&] (const TileBand& b) {
+					for (int y = b.y0; y < b.y1; ++y) {
+						float* out = dst.getData() + y * img.getWidth();
+						for (int x = 0; x < img.getWidth(); ++x) {out[x] = ii.getMeanAround(x, y, rx, ry);}
+					}
+				});
+
+			}
+
+		};
+
+	}
+
+}
+
+#endif // K_CV_BOX_H
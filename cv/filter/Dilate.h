@@ -2,6 +2,10 @@
 #define K_CV_DILATE_H
 
 #include "../ImageChannel.h"
+#include "../Bitmap.h"
+#include "../TileExecutor.h"
+
+#include <algorithm>
 
 namespace K {
 
@@ -35,91 +39,149 @@ namespace K {
 				// process each pixel
 				for (int y = radius; y < img.getHeight()-radius; ++y) {
 					for (int x = radius; x < img.getWidth()-radius; ++x) {
+						dilate(img, out, x, y, radius, shape, refVal, threshold, 0, img.getHeight());
+					}
+				}
+
+				// done
+				return out;
 
-						// get the pixel's value
-						const float val = img.get(x, y);
+			}
 
-						// perform threshold check. pixel-value too different than reference? -> skip
-						const float diff = std::abs(refVal - val);
-						if (diff > threshold) {continue;}
+			/**
+			 * like apply() but writes into the preallocated out (same size as img), using the bands of the given executor.
+			 * each band processes all pixels that may dilate into its rows, but only writes its own rows
+			 */
+			static void apply(const ImageChannel& img, ImageChannel& out, const TileExecutor& exec, const int radius = 1, const Shape shape = Shape::SQUARE_45, const float refVal = 1.0, const float threshold = 0.5) {
 
-						// set the pixel itself
-						out.set(x+0, y+0, val);
+				_assertBetween(radius, 1, 3, "invalid radius given");
+				_assertTrue(out.getWidth() == img.getWidth() && out.getHeight() == img.getHeight(), "size mismatch");
 
-						// set radius 1 pixels
-						if (radius >= 1) {
-							out.set(x+1, y+0, val);
-							out.set(x-1, y+0, val);
-							out.set(x+0, y+1, val);
-							out.set(x+0, y-1, val);
+				exec.run(img.getHeight(), radius, [&] (const TileBand& b) {
+
+					// start with a copy of the band's rows
+					std::copy(img.getData() + b.y0 * img.getWidth(), img.getData() + b.y1 * img.getWidth(), out.getData() + b.y0 * img.getWidth());
+
+					// same (row-major) order as apply() -> same result for overlapping writes
+					const int y0 = std::max(radius, b.in0);
+					const int y1 = std::min(img.getHeight()-radius, b.in1);
+					for (int y = y0; y < y1; ++y) {
+						for (int x = radius; x < img.getWidth()-radius; ++x) {
+							dilate(img, out, x, y, radius, shape, refVal, threshold, b.y0, b.y1);
 						}
+					}
 
-						// set radius 2 pixels
-						if (radius >= 2) {
+				});
 
-							out.set(x+2, y+0, val);
-							out.set(x-2, y+0, val);
-							out.set(x+0, y+2, val);
-							out.set(x+0, y-2, val);
+			}
 
-							out.set(x+1, y+1, val);
-							out.set(x+1, y-1, val);
-							out.set(x-1, y+1, val);
-							out.set(x-1, y-1, val);
+			/**
+			 * dilate all set pixels of the given binary mask, 64 pixels at once.
+			 * same shapes as for images, but also pixels near the border are dilated
+			 */
+			static Bitmap apply(const Bitmap& mask, const int radius = 1, const Shape shape = Shape::SQUARE_45) {
+				return mask.dilate(getElement(radius, shape));
+			}
 
-							if (shape == CIRCLE) {
+			/** erode all set pixels of the given binary mask, 64 pixels at once. pixels outside the mask are ignored */
+			static Bitmap erode(const Bitmap& mask, const int radius = 1, const Shape shape = Shape::SQUARE_45) {
+				return mask.erode(getElement(radius, shape));
+			}
 
-								out.set(x-2, y-1, val);
-								out.set(x-1, y-2, val);
+			/** the horizontal half-width of each row [-radius:+radius] of the given shape (see dilate() below) */
+			static std::vector<int> getElement(const int radius, const Shape shape) {
+				_assertBetween(radius, 1, 3, "invalid radius given");
+				switch (radius) {
+					case 1:		return {0, 1, 0};
+					case 2:		return (shape == CIRCLE) ? std::vector<int>{1, 2, 2, 2, 1} : std::vector<int>{0, 1, 2, 1, 0};
+					default:	return (shape == CIRCLE) ? std::vector<int>{0, 2, 2, 3, 2, 2, 0} : std::vector<int>{0, 1, 2, 3, 2, 1, 0};
+				}
+			}
 
-								out.set(x-2, y+1, val);
-								out.set(x-1, y+2, val);
+		private:
 
-								out.set(x+2, y-1, val);
-								out.set(x+1, y-2, val);
+			/** dilate the pixel at (x,y). only rows within [y0:y1) are written */
+			static inline void dilate(const ImageChannel& img, ImageChannel& out, const int x, const int y, const int radius, const Shape shape, const float refVal, const float threshold, const int y0, const int y1) {
 
-								out.set(x+2, y+1, val);
-								out.set(x+1, y+2, val);
+				// get the pixel's value
+				const float val = img.get(x, y);
 
-							}
+				// perform threshold check. pixel-value too different than reference? -> skip
+				const float diff = std::abs(refVal - val);
+				if (diff > threshold) {return;}
 
-						}
+				auto set = [&] (const int px, const int py, const float v) {if (py >= y0 && py < y1) {out.set(px, py, v);}};
 
-						// set radius 3 pixels
-						if (radius >= 3) {
+				// set the pixel itself
+				set(x+0, y+0, val);
 
-							out.set(x+3, y+0, val);
-							out.set(x-3, y+0, val);
-							out.set(x+0, y+3, val);
-							out.set(x+0, y-3, val);
+				// set radius 1 pixels
+				if (radius >= 1) {
+					set(x+1, y+0, val);
+					set(x-1, y+0, val);
+					set(x+0, y+1, val);
+					set(x+0, y-1, val);
+				}
 
-							out.set(x-2, y-1, val);
-							out.set(x-1, y-2, val);
+				// set radius 2 pixels
+				if (radius >= 2) {
 
-							out.set(x-2, y+1, val);
-							out.set(x-1, y+2, val);
+					set(x+2, y+0, val);
+					set(x-2, y+0, val);
+					set(x+0, y+2, val);
+					set(x+0, y-2, val);
 
-							out.set(x+2, y-1, val);
-							out.set(x+1, y-2, val);
+					set(x+1, y+1, val);
+					set(x+1, y-1, val);
+					set(x-1, y+1, val);
+					set(x-1, y-1, val);
 
-							out.set(x+2, y+1, val);
-							out.set(x+1, y+2, val);
+					if (shape == CIRCLE) {
 
-							if (shape == CIRCLE) {
-								out.set(x+2, y+2, val);
-								out.set(x+2, y-2, val);
-								out.set(x-2, y+2, val);
-								out.set(x-2, y-2, val);
-							}
+						set(x-2, y-1, val);
+						set(x-1, y-2, val);
 
-						}
+						set(x-2, y+1, val);
+						set(x-1, y+2, val);
 
+						set(x+2, y-1, val);
+						set(x+1, y-2, val);
+
+						set(x+2, y+1, val);
+						set(x+1, y+2, val);
 
 					}
+
 				}
 
-				// done
-				return out;
+				// set radius 3 pixels
+				if (radius >= 3) {
+
+					set(x+3, y+0, val);
+					set(x-3, y+0, val);
+					set(x+0, y+3, val);
+					set(x+0, y-3, val);
+
+					set(x-2, y-1, val);
+					set(x-1, y-2, val);
+
+					set(x-2, y+1, val);
+					set(x-1, y+2, val);
+
+					set(x+2, y-1, val);
+					set(x+1, y-2, val);
+
+					set(x+2, y+1, val);
+					set(x+1, y+2, val);
+
+					if (shape == CIRCLE) {
+						set(x+2, y+2, val);
+						set(x+2, y-2, val);
+						set(x-2, y+2, val);
+						set(x-2, y-2, val);
+					}
+
+				}
 
 			}
 
@@ -4,13 +4,15 @@
 #include "../ImageChannel.h"
 #include "../KernelFactory.h"
 #include "../Convolve.h"
+#include "../ConvolveSeparable.h"
 
 namespace K {
 
 	namespace CV {
 
 		/**
-		 * 2D gauss filter using 2x1D gauss
+		 * 2D gauss filter using 2x1D gauss.
+		 * both passes are fused by ConvolveSeparable
 		 */
 		class Gauss {
 
@@ -39,10 +41,15 @@ namespace K {
 			ImageChannel filter(const ImageChannel& src) const {
 
 				// 2 x 1D convolution
-				return Convolve::run(Convolve::run(src, kH), kV);
+				return ConvolveSeparable::run(src, kH, kV);
 
 			}
 
+			/** filter into dst (same size as src), using the bands of the given executor */
+			void filter(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec) const {
+				ConvolveSeparable::convolve(src, dst, kH, kV, true, exec);
+			}
+
 		};
 
 	}
@@ -3,6 +3,8 @@
 
 
 #include "../ImageChannel.h"
+#include "../TileExecutor.h"
+#include "../ImageBuffer.h"
 #include "../../Assertions.h"
 #include "../../math/statistics/Maximum.h"
 
@@ -30,6 +32,58 @@ namespace K {
 
 			}
 
+			/** apply the filter to the given image, using the bands of the given executor. dst must have the same size as img */
+			static void apply(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec, const int sx = 3, const int sy = 3) {
+
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+
+				exec.forEachPixel(img.getWidth(), img.getHeight(), (sy-1)/2, [&] (const int x, const int y) {
+					dst.set(x,y, get(img,x,y,sx,sy));
+				});
+
+			}
+
+			/**
+			 * apply the filter natively to 8/16 bit (or half/float) images. dst must have the same size as img.
+			 * the (clamped) window is separable: a horizontal pass followed by a vertical one
+			 */
+			template <typename T> static void apply(const ImageBuffer<T>& img, const ImageBuffer<T>& dst, const int sx = 3, const int sy = 3) {
+
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+				_assertTrue(sx % 2 == 1, "sx must be odd");
+				_assertTrue(sy % 2 == 1, "sy must be odd");
+
+				const int w = img.getWidth();
+				const int h = img.getHeight();
+				const int rx = (sx-1)/2;
+				const int ry = (sy-1)/2;
+				const ImageBuffer<T> tmp(w, h);
+
+				#pragma omp parallel for
+				for (int y = 0; y < h; ++y) {
+					const T* in = img.getRow(y);
+					T* out = tmp.getRow(y);
+					for (int x = 0; x < w; ++x) {
+						const int x2 = std::min(w-1, x+rx);
+						T v = in[std::max(0, x-rx)];
+						for (int xx = std::max(0, x-rx) + 1; xx <= x2; ++xx) {v = std::max(v, in[xx]);}
+						out[x] = v;
+					}
+				}
+
+				#pragma omp parallel for
+				for (int y = 0; y < h; ++y) {
+					const int y2 = std::min(h-1, y+ry);
+					T* out = dst.getRow(y);
+					std::copy(tmp.getRow(std::max(0, y-ry)), tmp.getRow(std::max(0, y-ry)) + w, out);
+					for (int yy = std::max(0, y-ry) + 1; yy <= y2; ++yy) {
+						const T* in = tmp.getRow(yy);
+						for (int x = 0; x < w; ++x) {out[x] = std::max(out[x], in[x]);}
+					}
+				}
+
+			}
+
 			/** get the median for the given (x,y) by examining its neighborhood (default 3x3) */
 			static float get(const ImageChannel& img, const int x, const int y, const int sx = 3, const int sy = 3) {
 
@@ -2,30 +2,84 @@
 #define K_CV_MEDIAN_H
 
 #include "../ImageChannel.h"
+#include "../TileExecutor.h"
 #include "../../Assertions.h"
 #include "../../math/statistics/Median.h"
 
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
 namespace K {
 
 	namespace CV {
 
-		/** median image filter */
+		/**
+		 * median image filter.
+		 *
+		 * apply() examines the (clamped) neighborhood of each pixel.
+		 * 3x3 and 5x5 windows use sorting networks for the image's interior.
+		 *
+		 * applyHistogram() uses sliding histograms (Perreault/Hebert) on values
+		 * quantized to 256 levels. its runtime hardly depends on the radius.
+		 */
 		class Median {
 
+		private:
+
+			/** number of quantization levels for applyHistogram() */
+			static constexpr int LEVELS = 256;
+
+			/** number of coarse bins (each covering LEVELS/COARSE fine bins) */
+			static constexpr int COARSE = 16;
+
+			/** number of pixels processed at once by the sorting networks */
+			static constexpr int LANES = 8;
+
 		public:
 
 			/** apply a median-filter to the given image */
 			static ImageChannel apply(const ImageChannel& img, const int sx = 3, const int sy = 3) {
 
 				K::ImageChannel res(img.getWidth(), img.getHeight());
+				applyRows(img, res, sx, sy, 0, img.getHeight());
+				return res;
 
-				for (int y = 0; y < img.getHeight(); ++y) {
-					for (int x = 0; x < img.getWidth(); ++x) {
-						res.set(x,y, get(img,x,y,sx,sy));
-					}
-				}
+			}
 
+			/** apply the filter to the given image, using the bands of the given executor. dst must have the same size as img */
+			static void apply(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec, const int sx = 3, const int sy = 3) {
+
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+
+				exec.run(img.getHeight(), (sy-1)/2, [&] (const TileBand& b) {
+					applyRows(img, dst, sx, sy, b.y0, b.y1);
+				});
+
+			}
+
+			/**
+			 * median-filter with a (2*radius+1)^2 window using sliding histograms.
+			 * values are quantized to 256 levels within [min:max], thus the result
+			 * is exact for 8-bit data (and an approximation otherwise)
+			 */
+			static ImageChannel applyHistogram(const ImageChannel& img, const int radius, const float min = 0.0f, const float max = 1.0f) {
+				K::ImageChannel res(img.getWidth(), img.getHeight());
+				applyHistogram(img, res, TileExecutor(), radius, min, max);
 				return res;
+			}
+
+			/** like applyHistogram() but using the bands of the given executor. dst must have the same size as img */
+			static void applyHistogram(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec, const int radius, const float min = 0.0f, const float max = 1.0f) {
+
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+				_assertBetween(radius, 0, 127, "radius out of range");
+				_assertTrue(max > min, "max must be > min");
+
+				exec.run(img.getHeight(), radius, [&] (const TileBand& b) {
+					histogramRows(img, dst, radius, min, max, b.y0, b.y1);
+				});
 
 			}
 
@@ -60,6 +114,178 @@ namespace K {
 
 			}
 
+		private:
+
+			/** filter the output rows [y0:y1) */
+			static void applyRows(const ImageChannel& img, ImageChannel& dst, const int sx, const int sy, const int y0, const int y1) {
+
+				const int w = img.getWidth();
+				const int h = img.getHeight();
+				const bool network = (sx == sy) && (sx == 3 || sx == 5);
+				const int r = (sx-1)/2;
+
+				for (int y = y0; y < y1; ++y) {
+
+					// without sorting network or within the top/bottom edge: examine each neighborhood
+					if (!network || y < r || y >= h-r) {
+						for (int x = 0; x < w; ++x) {dst.set(x,y, get(img,x,y,sx,sy));}
+						continue;
+					}
+
+					// left and right edge
+					for (int x = 0; x < std::min(r, w); ++x)		{dst.set(x,y, get(img,x,y,sx,sy));}
+					for (int x = std::max(r, w-r); x < w; ++x)		{dst.set(x,y, get(img,x,y,sx,sy));}
+
+					// interior
+					if (sx == 3)	{networkRow<9>(img, dst, y, r, w-r, NET9, sizeof(NET9)/sizeof(NET9[0]));}
+					else			{networkRow<25>(img, dst, y, r, w-r, NET25, sizeof(NET25)/sizeof(NET25[0]));}
+
+				}
+
+			}
+
+			/** median of the NxN (N=3,5) neighborhood for pixels [x0:x1) of row y, LANES pixels at once */
+			template <int N> static void networkRow(const ImageChannel& img, ImageChannel& dst, const int y, const int x0, const int x1, const int (*net)[2], const size_t numPairs) {
+
+				const int s = (N == 9) ? (3) : (5);
+				const int r = s/2;
+				const int w = img.getWidth();
+				float v[N][LANES] = {};
+
+				for (int x = x0; x < x1; x += LANES) {
+
+					const int lanes = std::min(LANES, x1 - x);
+
+					// gather the neighborhoods (column-wise per lane)
+					for (int l = 0; l < lanes; ++l) {
+						const float* src = img.getData() + (y-r) * w + (x+l-r);
+						int i = 0;
+						for (int yy = 0; yy < s; ++yy) {
+							for (int xx = 0; xx < s; ++xx) {v[i++][l] = src[yy*w + xx];}
+						}
+					}
+
+					// compare-exchange for all lanes
+					for (size_t p = 0; p < numPairs; ++p) {
+						float* a = v[net[p][0]];
+						float* b = v[net[p][1]];
+						for (int l = 0; l < LANES; ++l) {
+							const float lo = std::min(a[l], b[l]);
+							const float hi = std::max(a[l], b[l]);
+							a[l] = lo;
+							b[l] = hi;
+						}
+					}
+
+					float* out = dst.getData() + y * w + x;
+					for (int l = 0; l < lanes; ++l) {out[l] = v[N/2][l];}
+
+				}
+
+			}
+
+			/** filter the output rows [y0:y1) using sliding histograms */
+			static void histogramRows(const ImageChannel& img, ImageChannel& dst, const int r, const float min, const float max, const int y0, const int y1) {
+
+				const int w = img.getWidth();
+				const int h = img.getHeight();
+				if (w == 0 || h == 0) {return;}
+
+				const float scale = (float) (LEVELS-1) / (max - min);
+				const float step = (max - min) / (float) (LEVELS-1);
+				auto quantize = [&] (const float v) -> int {
+					const int q = (int) std::lround((v - min) * scale);
+					return (q < 0) ? (0) : (q >= LEVELS) ? (LEVELS-1) : (q);
+				};
+
+				// one (fine and coarse) histogram per column, covering the window's rows
+				std::vector<uint16_t> cols((size_t) w * LEVELS);
+				std::vector<uint16_t> colsCoarse((size_t) w * COARSE);
+				auto update = [&] (const int row, const int delta) {
+					const float* src = img.getData() + row * w;
+					for (int x = 0; x < w; ++x) {
+						const int q = quantize(src[x]);
+						uint16_t& c = cols[(size_t) x * LEVELS + q];
+						uint16_t& cc = colsCoarse[(size_t) x * COARSE + q / (LEVELS/COARSE)];
+						c = (uint16_t) (c + delta);
+						cc = (uint16_t) (cc + delta);
+					}
+				};
+				for (int yy = std::max(0, y0-r); yy <= std::min(h-1, y0+r); ++yy) {update(yy, +1);}
+
+				uint16_t hist[LEVELS];
+				uint16_t coarse[COARSE];
+
+				for (int y = y0; y < y1; ++y) {
+
+					// slide the column histograms down
+					if (y > y0) {
+						if (y+r < h)	{update(y+r, +1);}
+						if (y-r-1 >= 0)	{update(y-r-1, -1);}
+					}
+					const int rows = std::min(h-1, y+r) - std::max(0, y-r) + 1;
+
+					// window histogram for x = 0
+					std::fill(hist, hist+LEVELS, 0);
+					std::fill(coarse, coarse+COARSE, 0);
+					for (int x = 0; x <= std::min(w-1, r); ++x) {addColumn(hist, coarse, cols, colsCoarse, x, +1);}
+
+					float* out = dst.getData() + y * w;
+					for (int x = 0; x < w; ++x) {
+
+						// slide the window right
+						if (x > 0) {
+							if (x+r < w)	{addColumn(hist, coarse, cols, colsCoarse, x+r, +1);}
+							if (x-r-1 >= 0)	{addColumn(hist, coarse, cols, colsCoarse, x-r-1, -1);}
+						}
+
+						// same as K::Median: the mean of both center values for an even number of entries
+						const int n = rows * (std::min(w-1, x+r) - std::max(0, x-r) + 1);
+						const int lo = getRank(hist, coarse, (n-1)/2);
+						const int hi = (n % 2 == 1) ? (lo) : (getRank(hist, coarse, n/2));
+						out[x] = min + (float) (lo + hi) * 0.5f * step;
+
+					}
+
+				}
+
+			}
+
+			/** add/remove the given column's histogram to/from the window's histogram */
+			static inline void addColumn(uint16_t* hist, uint16_t* coarse, const std::vector<uint16_t>& cols, const std::vector<uint16_t>& colsCoarse, const int x, const int sign) {
+				const uint16_t* c = cols.data() + (size_t) x * LEVELS;
+				const uint16_t* cc = colsCoarse.data() + (size_t) x * COARSE;
+				if (sign > 0) {
+					for (int i = 0; i < LEVELS; ++i) {hist[i] = (uint16_t) (hist[i] + c[i]);}
+					for (int i = 0; i < COARSE; ++i) {coarse[i] = (uint16_t) (coarse[i] + cc[i]);}
+				} else {
+					for (int i = 0; i < LEVELS; ++i) {hist[i] = (uint16_t) (hist[i] - c[i]);}
+					for (int i = 0; i < COARSE; ++i) {coarse[i] = (uint16_t) (coarse[i] - cc[i]);}
+				}
+			}
+
+			/** get the level of the value with the given rank (0-based) */
+			static inline int getRank(const uint16_t* hist, const uint16_t* coarse, int rank) {
+				int c = 0;
+				while (rank >= coarse[c]) {rank -= coarse[c]; ++c;}
+				int i = c * (LEVELS/COARSE);
+				while (rank >= hist[i]) {rank -= hist[i]; ++i;}
+				return i;
+			}
+
+			/** median selection networks for 3x3 and 5x5 (the median ends up at the center index) */
+			static constexpr int NET9[19][2] = {
+				{1,2},{4,5},{7,8},{0,1},{3,4},{6,7},{1,2},{4,5},{7,8},{0,3},{5,8},{4,7},{3,6},{1,4},{2,5},{4,7},{4,2},{6,4},{4,2}
+			};
+
+			static constexpr int NET25[99][2] = {
+				{0,1},{3,4},{2,4},{2,3},{6,7},{5,7},{5,6},{9,10},{8,10},{8,9},{12,13},{11,13},{11,12},{15,16},{14,16},{14,15},{18,19},{17,19},{17,18},{21,22},
+				{20,22},{20,21},{23,24},{2,5},{3,6},{0,6},{0,3},{4,7},{1,7},{1,4},{11,14},{8,14},{8,11},{12,15},{9,15},{9,12},{13,16},{10,16},{10,13},{20,23},
+				{17,23},{17,20},{21,24},{18,24},{18,21},{19,22},{8,17},{9,18},{0,18},{0,9},{10,19},{1,19},{1,10},{11,20},{2,20},{2,11},{12,21},{3,21},{3,12},{13,22},
+				{4,22},{4,13},{14,23},{5,23},{5,14},{15,24},{6,24},{6,15},{7,16},{7,19},{13,21},{15,23},{7,13},{7,15},{1,9},{3,11},{5,17},{11,17},{9,17},{4,10},
+				{6,12},{7,14},{4,6},{4,7},{12,14},{10,14},{6,7},{10,12},{6,10},{6,17},{12,17},{7,17},{7,10},{12,18},{7,12},{10,18},{12,20},{10,20},{10,12}
+			};
+
 		};
 
 	}
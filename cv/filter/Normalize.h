@@ -2,6 +2,10 @@
 #define K_CV_FILTER_NORMALIZE_H
 
 #include "../ImageChannel.h"
+#include "../TileExecutor.h"
+
+#include <vector>
+#include <algorithm>
 
 namespace K {
 
@@ -51,6 +55,42 @@ namespace K {
 				return out;
 			}
 
+			/** normalize img into dst (same size), using the bands of the given executor. min and max are automatically determined */
+			static void run(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec) {
+
+				if (img.getWidth() == 0 || img.getHeight() == 0) {return;}
+
+				// per band min/max
+				const std::vector<TileBand> bands = exec.getBands(img.getHeight(), 0);
+				std::vector<float> mins(bands.size());
+				std::vector<float> maxs(bands.size());
+				exec.run(bands, [&] (const TileBand& b) {
+					const float* start = img.getData() + b.y0 * img.getWidth();
+					const float* end = img.getData() + b.y1 * img.getWidth();
+					mins[b.idx] = *std::min_element(start, end);
+					maxs[b.idx] = *std::max_element(start, end);
+				});
+
+				const float min = *std::min_element(mins.begin(), mins.end());
+				const float max = *std::max_element(maxs.begin(), maxs.end());
+				run(img, dst, min, max, exec);
+
+			}
+
+			/** normalize img into dst (same size), using the bands of the given executor */
+			static void run(const ImageChannel& img, ImageChannel& dst, const float min, const float max, const TileExecutor& exec) {
+
+				_assertTrue(dst.getWidth() == img.getWidth() && dst.getHeight() == img.getHeight(), "size mismatch");
+				const float diff = max - min;
+
+				exec.run(img.getHeight(), 0, [&] (const TileBand& b) {
+					const float* src = img.getData() + b.y0 * img.getWidth();
+					float* out = dst.getData() + b.y0 * img.getWidth();
+					for (int i = 0; i < (b.y1 - b.y0) * img.getWidth(); ++i) {out[i] = clamp01((src[i] - min) / diff);}
+				});
+
+			}
+
 			static float clamp01(const float val) {
 				if (val < 0) {return 0;}
 				if (val > 1) {return 1;}
@@ -0,0 +1,191 @@
+#ifndef K_CV_FILTER_REMAP_H
+#define K_CV_FILTER_REMAP_H
+
+#include "../ImageChannel.h"
+#include "../TileExecutor.h"
+#include "../../geo/Point2.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_CV_X86_SIMD
+#endif
+
+namespace K {
+
+	namespace CV {
+
+		/**
+		 * geometric image transformations (rotation, homography, lens distortion, ...) via remap tables.
+		 *
+		 * all transformations map each destination pixel to a source coordinate. calculating this coordinate
+		 * (trigonometry, divisions, distortion polynomials, ...) is the expensive part, but for a fixed geometry
+		 * (and camera) it is the same for every frame. a Plan thus calculates the coordinates once and stores,
+		 * for each destination pixel, the top-left source pixel and the bilinear weights.
+		 * applying the plan is a gather of 4 pixels and a blend per pixel (8 pixels at once using AVX2).
+		 */
+		class Remap {
+
+		public:
+
+			/** what to do with destination pixels, whose source coordinate is outside of the image */
+			enum Border {
+				CLAMP,		// use the nearest pixel within the image (like ImageChannel::getClamped)
+				SKIP,		// leave the destination pixel untouched
+			};
+
+			/** the precomputed remap table for one geometry */
+			class Plan {
+
+				int srcW = 0;
+				int srcH = 0;
+				int dstW = 0;
+				int dstH = 0;
+
+				/** index of the top-left source pixel for each destination pixel. -1 = skip */
+				std::vector<int32_t> idx;
+
+				/** weight of the left (top) source pixels. the right (bottom) ones use 1 - weight */
+				std::vector<float> wx;
+				std::vector<float> wy;
+
+			public:
+
+				/** empty ctor */
+				Plan() {;}
+
+				/**
+				 * ctor
+				 * @param map returns the (sub-pixel) source coordinate as Point2f for the destination pixel (x,y)
+				 * @param border how to handle source coordinates outside of the source image. NaN is always skipped
+				 * @param exec the bands of rows to calculate in parallel
+				 */
+				template <typename Map> Plan(const int srcW, const int srcH, const int dstW, const int dstH, Map&& map, const Border border = CLAMP, const TileExecutor& exec = TileExecutor()) :
+					srcW(srcW), srcH(srcH), dstW(dstW), dstH(dstH) {
+
+					_assertTrue(srcW >= 2 && srcH >= 2, "the source image must have at least 2x2 pixels");
+					const size_t num = (size_t) dstW * (size_t) dstH;
+					idx.resize(num);
+					wx.resize(num);
+					wy.resize(num);
+
+					exec.run(dstH, 0, [&] (const TileBand& b) {
+						for (int y = b.y0; y < b.y1; ++y) {
+							for (int x = 0; x < dstW; ++x) {
+								const size_t i = (size_t) y * (size_t) dstW + (size_t) x;
+								const Point2f p = map(x, y);
+								const bool outside = !(p.x >= 0 && p.y >= 0 && p.x <= (float) (srcW-1) && p.y <= (float) (srcH-1));	// also NaN
+								if ((outside && border == SKIP) || p.x != p.x || p.y != p.y) {idx[i] = -1; wx[i] = 0; wy[i] = 0; continue;}
+								int x1, y1;
+								getTap(p.x, srcW, x1, wx[i]);
+								getTap(p.y, srcH, y1, wy[i]);
+								idx[i] = y1 * srcW + x1;
+							}
+						}
+					});
+
+				}
+
+				int getSrcWidth() const {return srcW;}
+				int getSrcHeight() const {return srcH;}
+				int getDstWidth() const {return dstW;}
+				int getDstHeight() const {return dstH;}
+
+				/** apply the remap table to src. dst must have the plan's destination size */
+				void apply(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec = TileExecutor()) const {
+
+					_assertTrue(src.getWidth() == srcW && src.getHeight() == srcH, "source size does not match the plan");
+					_assertTrue(dst.getWidth() == dstW && dst.getHeight() == dstH, "destination size does not match the plan");
+
+					exec.run(dstH, 0, [&] (const TileBand& b) {
+						const size_t i0 = (size_t) b.y0 * (size_t) dstW;
+						const size_t i1 = (size_t) b.y1 * (size_t) dstW;
+						size_t i = i0;
+#ifdef K_CV_X86_SIMD
+						static const bool avx2 = hasAVX2();
+						if (avx2) {i = applyAVX2(src.getData(), dst.getData(), i0, i1);}
+#endif
+						applyScalar(src.getData(), dst.getData(), i, i1);
+					});
+
+				}
+
+				/** apply the remap table to src */
+				ImageChannel apply(const ImageChannel& src, const TileExecutor& exec = TileExecutor()) const {
+					ImageChannel dst(dstW, dstH);
+					dst.zero();
+					apply(src, dst, exec);
+					return dst;
+				}
+
+			private:
+
+				/** top-left tap and its weight along one axis. both taps are always within [0:size-1] */
+				static inline void getTap(const float v, const int size, int& i1, float& w1) {
+					if (v <= 0)						{i1 = 0; w1 = 1; return;}
+					if (v >= (float) (size-1))		{i1 = size-2; w1 = 0; return;}
+					i1 = (int) std::floor(v);
+					w1 = (float) (i1 + 1) - v;		// same as Interpolation::bilinear
+				}
+
+				/** blend the 4 taps (same order of operations as Interpolation::bilinear) */
+				void applyScalar(const float* src, float* dst, size_t i, const size_t i1) const {
+					for (; i < i1; ++i) {
+						if (idx[i] < 0) {continue;}
+						const float* p = src + idx[i];
+						const float vy1 = p[0] * wx[i] + p[1] * (1-wx[i]);
+						const float vy2 = p[srcW] * wx[i] + p[srcW+1] * (1-wx[i]);
+						dst[i] = vy1 * wy[i] + vy2 * (1-wy[i]);
+					}
+				}
+
+#ifdef K_CV_X86_SIMD
+
+				static bool hasAVX2() {
+					__builtin_cpu_init();
+					return __builtin_cpu_supports("avx2");
+				}
+
+				/** 8 pixels at once. skipped pixels are masked. returns the first unprocessed index */
+				__attribute__((target("avx2")))
+				size_t applyAVX2(const float* src, float* dst, size_t i, const size_t i1) const {
+					const __m256 one = _mm256_set1_ps(1.0f);
+					const __m256i stepX = _mm256_set1_epi32(1);
+					const __m256i stepY = _mm256_set1_epi32(srcW);
+					for (; i + 8 <= i1; i += 8) {
+						const __m256i base = _mm256_loadu_si256((const __m256i*) (idx.data() + i));
+						const __m256i valid = _mm256_cmpgt_epi32(base, _mm256_set1_epi32(-1));
+						const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(valid));
+						if (mask == 0) {continue;}
+						const __m256 m = _mm256_castsi256_ps(valid);
+						const __m256i safe = _mm256_and_si256(base, valid);			// skipped pixels gather index 0 (masked anyway)
+						const __m256 a = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src, safe, m, 4);
+						const __m256 b = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src, _mm256_add_epi32(safe, stepX), m, 4);
+						const __m256 c = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src, _mm256_add_epi32(safe, stepY), m, 4);
+						const __m256 d = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src, _mm256_add_epi32(_mm256_add_epi32(safe, stepY), stepX), m, 4);
+						const __m256 vx = _mm256_loadu_ps(wx.data() + i);
+						const __m256 vy = _mm256_loadu_ps(wy.data() + i);
+						const __m256 vx2 = _mm256_sub_ps(one, vx);
+						const __m256 vy1 = _mm256_add_ps(_mm256_mul_ps(a, vx), _mm256_mul_ps(b, vx2));
+						const __m256 vy2 = _mm256_add_ps(_mm256_mul_ps(c, vx), _mm256_mul_ps(d, vx2));
+						const __m256 res = _mm256_add_ps(_mm256_mul_ps(vy1, vy), _mm256_mul_ps(vy2, _mm256_sub_ps(one, vy)));
+						if (mask == 0xFF)	{_mm256_storeu_ps(dst + i, res);}
+						else				{_mm256_maskstore_ps(dst + i, valid, res);}
+					}
+					return i;
+				}
+
+#endif
+
+			};
+
+		};
+
+	}
+
+}
+
+#endif // K_CV_FILTER_REMAP_H
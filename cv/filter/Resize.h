@@ -2,6 +2,18 @@
 #define K_CV_RESIZE_H
 
 #include "../ImageChannel.h"
+#include "../TileExecutor.h"
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_CV_X86_SIMD
+#endif
 
 namespace K {
 
@@ -11,6 +23,328 @@ namespace K {
 
 		public:
 
+			/** resampling filters for the plan-based resizing */
+			enum Filter {
+				NEAREST,
+				BILINEAR,
+				BICUBIC,		// catmull-rom
+				LANCZOS3,
+				AREA,			// average of all covered pixels (bilinear when upscaling)
+			};
+
+			/**
+			 * precomputed separable resizing from one size to another.
+			 *
+			 * for each output column (row) the first input column (row) and the weights of
+			 * all taps are calculated once. all columns (rows) use the same number of taps,
+			 * thus the horizontal and the vertical pass are simple (SIMD) loops.
+			 * pixel centers are aligned, when downscaling the filters are widened accordingly (anti-aliasing).
+			 * the results are not clamped (bicubic and lanczos may overshoot).
+			 * a plan is immutable and may be used by several threads at once.
+			 */
+			class Plan {
+
+				/** the taps of one axis */
+				struct Axis {
+
+					/** number of output pixels */
+					int num = 0;
+
+					/** taps per output pixel */
+					int taps = 0;
+
+					/** first input pixel for each output pixel */
+					std::vector<int> start;
+
+					/** weight of tap k for output pixel i: [k * num + i] */
+					std::vector<float> weights;
+
+				};
+
+				int srcW, srcH;
+				Filter filter;
+				Axis ax;
+				Axis ay;
+
+			public:
+
+				/** ctor. calculates all taps */
+				Plan(const int srcW, const int srcH, const int dstW, const int dstH, const Filter filter) :
+					srcW(srcW), srcH(srcH), filter(filter), ax(getAxis(srcW, dstW, filter)), ay(getAxis(srcH, dstH, filter)) {
+					;
+				}
+
+				int getSrcWidth() const {return srcW;}
+				int getSrcHeight() const {return srcH;}
+				int getDstWidth() const {return ax.num;}
+				int getDstHeight() const {return ay.num;}
+				Filter getFilter() const {return filter;}
+
+				/** does this plan describe the given resizing? */
+				bool matches(const int srcW, const int srcH, const int dstW, const int dstH, const Filter filter) const {
+					return this->srcW == srcW && this->srcH == srcH && ax.num == dstW && ay.num == dstH && this->filter == filter;
+				}
+
+				/**
+				 * resize src into dst (both with the plan's sizes).
+				 * runs the pass that shrinks the image the most first: the (SIMD) vertical pass
+				 * is cheaper per pixel than the horizontal one, that needs to gather its taps
+				 */
+				void run(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec = TileExecutor()) const {
+
+					_assertTrue(src.getWidth() == srcW && src.getHeight() == srcH, "source size does not match the plan");
+					_assertTrue(dst.getWidth() == ax.num && dst.getHeight() == ay.num, "destination size does not match the plan");
+					if (ax.num == 0 || ay.num == 0) {return;}
+
+					const double costHV = 4.0 * srcH * ax.num * ax.taps + (double) ay.num * ax.num * ay.taps;
+					const double costVH = (double) ay.num * srcW * ay.taps + 4.0 * ay.num * ax.num * ax.taps;
+
+					if (costHV <= costVH) {
+						ImageChannel tmp(ax.num, srcH);
+						horizontalPass(src, tmp, exec);
+						verticalPass(tmp, dst, exec);
+					} else {
+						ImageChannel tmp(srcW, ay.num);
+						verticalPass(src, tmp, exec);
+						horizontalPass(tmp, dst, exec);
+					}
+
+				}
+
+			private:
+
+				/** resize all rows of src horizontally into dst */
+				void horizontalPass(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec) const {
+					exec.run(src.getHeight(), 0, [&] (const TileBand& b) {
+						for (int y = b.y0; y < b.y1; ++y) {
+							horizontal(src.getData() + (size_t) y * (size_t) srcW, dst.getData() + (size_t) y * (size_t) ax.num);
+						}
+					});
+				}
+
+				/** resize all columns of src vertically into dst */
+				void verticalPass(const ImageChannel& src, ImageChannel& dst, const TileExecutor& exec) const {
+					const int w = src.getWidth();
+					exec.run(ay.num, 0, [&] (const TileBand& b) {
+						std::vector<const float*> rows(ay.taps);
+						for (int y = b.y0; y < b.y1; ++y) {
+							for (int k = 0; k < ay.taps; ++k) {rows[k] = src.getData() + (size_t) (ay.start[y] + k) * (size_t) w;}
+							vertical(rows.data(), y, dst.getData() + (size_t) y * (size_t) w, w);
+						}
+					});
+				}
+
+				/** one input row -> one (resized) row */
+				void horizontal(const float* in, float* out) const {
+					int i = 0;
+#ifdef K_CV_X86_SIMD
+					static const int simd = detectSIMD();
+					if (simd == 2) {i = horizontalAVX2(in, out);}
+#endif
+					for (; i < ax.num; ++i) {
+						const float* p = in + ax.start[i];
+						float val = 0;
+						for (int k = 0; k < ax.taps; ++k) {val += ax.weights[(size_t) k * (size_t) ax.num + (size_t) i] * p[k];}
+						out[i] = val;
+					}
+				}
+
+				/** the taps' rows (w pixels each) -> output row y */
+				void vertical(const float* const* rows, const int y, float* out, const int w) const {
+					int x = 0;
+#ifdef K_CV_X86_SIMD
+					static const int simd = detectSIMD();
+					if (simd >= 1) {x = verticalAVX(rows, y, out, w);}
+#endif
+					for (; x < w; ++x) {
+						float val = 0;
+						for (int k = 0; k < ay.taps; ++k) {val += ay.weights[(size_t) k * (size_t) ay.num + (size_t) y] * rows[k][x];}
+						out[x] = val;
+					}
+				}
+
+#ifdef K_CV_X86_SIMD
+
+				/** 0 = none, 1 = AVX, 2 = AVX2 */
+				static int detectSIMD() {
+					__builtin_cpu_init();
+					if (__builtin_cpu_supports("avx2"))	{return 2;}
+					if (__builtin_cpu_supports("avx"))	{return 1;}
+					return 0;
+				}
+
+				/** 8 output pixels at once, gathering their taps. returns the first unprocessed pixel */
+				__attribute__((target("avx2")))
+				int horizontalAVX2(const float* in, float* out) const {
+					int i = 0;
+					for (; i + 8 <= ax.num; i += 8) {
+						const __m256i idx = _mm256_loadu_si256((const __m256i*) (ax.start.data() + i));
+						__m256 val = _mm256_setzero_ps();
+						for (int k = 0; k < ax.taps; ++k) {
+							const __m256 v = _mm256_i32gather_ps(in, _mm256_add_epi32(idx, _mm256_set1_epi32(k)), 4);
+							const __m256 w = _mm256_loadu_ps(ax.weights.data() + (size_t) k * (size_t) ax.num + (size_t) i);
+							val = _mm256_add_ps(val, _mm256_mul_ps(w, v));
+						}
+						_mm256_storeu_ps(out + i, val);
+					}
+					return i;
+				}
+
+				/** 8 output pixels at once. returns the first unprocessed pixel */
+				__attribute__((target("avx")))
+				int verticalAVX(const float* const* rows, const int y, float* out, const int w) const {
+					int x = 0;
+					for (; x + 8 <= w; x += 8) {
+						__m256 val = _mm256_setzero_ps();
+						for (int k = 0; k < ay.taps; ++k) {
+							const __m256 w = _mm256_set1_ps(ay.weights[(size_t) k * (size_t) ay.num + (size_t) y]);
+							val = _mm256_add_ps(val, _mm256_mul_ps(w, _mm256_loadu_ps(rows[k] + x)));
+						}
+						_mm256_storeu_ps(out + x, val);
+					}
+					return x;
+				}
+
+#endif
+
+				/** the filter's value at distance x (in input pixels, unscaled) */
+				static double getWeight(const Filter filter, double x) {
+					x = std::abs(x);
+					switch (filter) {
+						case BICUBIC: {
+							const double a = -0.5;
+							if (x < 1) {return ((a + 2) * x - (a + 3)) * x * x + 1;}
+							if (x < 2) {return ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;}
+							return 0;
+						}
+						case LANCZOS3: {
+							if (x < 1e-8) {return 1;}
+							if (x >= 3) {return 0;}
+							const double px = M_PI * x;
+							return 3 * std::sin(px) * std::sin(px / 3) / (px * px);
+						}
+						default:
+							return (x < 1) ? (1 - x) : (0);
+					}
+				}
+
+				/** the filter's radius (in input pixels, unscaled) */
+				static double getSupport(const Filter filter) {
+					switch (filter) {
+						case BICUBIC:	return 2;
+						case LANCZOS3:	return 3;
+						default:		return 1;
+					}
+				}
+
+				/** calculate all taps for resizing in -> out pixels */
+				static Axis getAxis(const int in, const int out, const Filter filter) {
+
+					_assertTrue(in > 0 && out >= 0, "invalid size");
+					const double scale = (double) in / (double) out;
+
+					// the (non-zero) weights of each output pixel, starting at first[i]
+					std::vector<int> first(out);
+					std::vector<std::vector<double>> w(out);
+
+					for (int i = 0; i < out; ++i) {
+
+						if (filter == NEAREST) {
+							first[i] = std::min(in - 1, (int) ((i + 0.5) * scale));
+							w[i] = {1.0};
+							continue;
+						}
+
+						if (filter == AREA && scale > 1) {
+							// coverage of each input pixel
+							const double x0 = i * scale;
+							const double x1 = std::min((double) in, (i + 1) * scale);
+							first[i] = (int) x0;
+							for (int j = first[i]; j < x1; ++j) {
+								w[i].push_back(std::min(x1, j + 1.0) - std::max(x0, (double) j));
+							}
+						} else {
+							// widen the filter when downscaling
+							const Filter f = (filter == AREA) ? (BILINEAR) : (filter);
+							const double fs = std::max(1.0, scale);
+							const double support = getSupport(f) * fs;
+							const double center = (i + 0.5) * scale;
+							const int j0 = std::max(0, (int) std::floor(center - support + 0.5));
+							const int j1 = std::min(in, (int) std::floor(center + support + 0.5));
+							first[i] = j0;
+							for (int j = j0; j < j1; ++j) {w[i].push_back(getWeight(f, (j + 0.5 - center) / fs));}
+						}
+
+						// skip zero taps at both ends
+						while (w[i].size() > 1 && w[i].back() == 0)		{w[i].pop_back();}
+						while (w[i].size() > 1 && w[i].front() == 0)	{w[i].erase(w[i].begin()); ++first[i];}
+
+						// normalize
+						double sum = 0;
+						for (const double v : w[i]) {sum += v;}
+						if (sum != 0) {for (double& v : w[i]) {v /= sum;}}
+
+					}
+
+					// all output pixels use the same number of taps, the missing ones are 0
+					Axis a;
+					a.num = out;
+					for (const std::vector<double>& vec : w) {a.taps = std::max(a.taps, (int) vec.size());}
+					a.start.resize(out);
+					a.weights.resize((size_t) a.taps * (size_t) out, 0.0f);
+					for (int i = 0; i < out; ++i) {
+						a.start[i] = std::max(0, std::min(first[i], in - a.taps));
+						const int off = first[i] - a.start[i];
+						for (size_t k = 0; k < w[i].size(); ++k) {
+							a.weights[(off + k) * (size_t) out + (size_t) i] = (float) w[i][k];
+						}
+					}
+					return a;
+
+				}
+
+			};
+
+			/** get a plan for the given sizes. recently used plans are cached, e.g. for video frames */
+			static std::shared_ptr<const Plan> getPlan(const int srcW, const int srcH, const int dstW, const int dstH, const Filter filter) {
+
+				static std::mutex mtx;
+				static std::vector<std::shared_ptr<const Plan>> cache;		// most recent first
+				static constexpr size_t CACHE_SIZE = 8;
+
+				std::lock_guard<std::mutex> lock(mtx);
+				for (size_t i = 0; i < cache.size(); ++i) {
+					if (cache[i]->matches(srcW, srcH, dstW, dstH, filter)) {
+						std::rotate(cache.begin(), cache.begin() + i, cache.begin() + i + 1);
+						return cache.front();
+					}
+				}
+
+				cache.insert(cache.begin(), std::make_shared<const Plan>(srcW, srcH, dstW, dstH, filter));
+				if (cache.size() > CACHE_SIZE) {cache.pop_back();}
+				return cache.front();
+
+			}
+
+			/** resize to the given size using a (cached) plan for the given filter */
+			static K::ImageChannel apply(const ImageChannel& img, const int w, const int h, const Filter filter, const TileExecutor& exec = TileExecutor()) {
+				K::ImageChannel out(w, h);
+				apply(img, out, filter, exec);
+				return out;
+			}
+
+			/** resize img to the size of the preallocated out using a (cached) plan for the given filter */
+			static void apply(const ImageChannel& img, ImageChannel& out, const Filter filter, const TileExecutor& exec = TileExecutor()) {
+				getPlan(img.getWidth(), img.getHeight(), out.getWidth(), out.getHeight(), filter)->run(img, out, exec);
+			}
+
+			/** resize by the given factor using a (cached) plan for the given filter. the new size is rounded */
+			static K::ImageChannel apply(const ImageChannel& img, const float scaler, const Filter filter) {
+				const int w = (int) std::lround((float) img.getWidth() * scaler);
+				const int h = (int) std::lround((float) img.getHeight() * scaler);
+				return apply(img, w, h, filter);
+			}
+
 			/** resize to the new width */
 			template <typename Interpolator> static K::ImageChannel apply(const ImageChannel& img, const int w, const int h) {
 
@@ -37,6 +371,19 @@ namespace K {
 			}
 
 
+			/** resize img to the size of the preallocated out, using the bands of the given executor */
+			template <typename Interpolator> static void apply(const ImageChannel& img, ImageChannel& out, const TileExecutor& exec) {
+
+				const float rw = (float)img.getWidth()	/ (float)out.getWidth();
+				const float rh = (float)img.getHeight()	/ (float)out.getHeight();
+
+				// bands of output rows. the input is read-only -> no halo needed
+				exec.forEachPixel(out.getWidth(), out.getHeight(), 0, [&] (const int x, const int y) {
+					out.set(x, y, Interpolator::get(img, (float) x * rw, (float) y * rh));
+				});
+
+			}
+
 			template <typename Interpolator> static K::ImageChannel apply(const ImageChannel& img, const float scaler) {
 				return apply<Interpolator>(img, (int)(img.getWidth() * scaler), (int)(img.getHeight() * scaler));
 			}
@@ -2,7 +2,9 @@
 #define K_CV_ROTATE_H
 
 #include "../ImageChannel.h"
+#include "../TileExecutor.h"
 #include "Interpolation.h"
+#include "Remap.h"
 #include "../../geo/Point2.h"
 
 namespace K {
@@ -46,6 +48,38 @@ namespace K {
 
 			}
 
+			/** rotate img into the preallocated out (same size), using the bands of the given executor */
+			template <typename Interpolator> static void apply(const ImageChannel& img, ImageChannel& out, const Point2f center, const float rad, const TileExecutor& exec) {
+
+				_assertTrue(out.getWidth() == img.getWidth() && out.getHeight() == img.getHeight(), "size mismatch");
+
+				// bands of output rows. the input is read-only -> no halo needed
+				exec.run(out.getHeight(), 0, [&] (const TileBand& b) {
+					for (int y = b.y0; y < b.y1; ++y) {
+						for (int x = 0; x < out.getWidth(); ++x) {
+							K::Point2f p1 = K::Point2f((float)x, (float)y) - center;
+							p1.rotate(rad);
+							const K::Point2f pi = p1 + center;
+							out.set(x, y, Interpolator::get(img, pi.x, pi.y));
+						}
+					}
+				});
+
+			}
+
+			/**
+			 * get a remap plan for rotating images of the given size, for applying the same rotation to many images.
+			 * yields the same result as apply<Interpolation::Bilinear>()
+			 */
+			static Remap::Plan getPlan(const int w, const int h, const Point2f center, const float rad, const TileExecutor& exec = TileExecutor()) {
+				auto map = [&] (const int x, const int y) {
+					K::Point2f p1 = K::Point2f((float)x, (float)y) - center;
+					p1.rotate(rad);
+					return p1 + center;
+				};
+				return Remap::Plan(w, h, w, h, map, Remap::CLAMP, exec);
+			}
+
 		};
 
 	}
@@ -3,6 +3,7 @@
 
 #include "../ImageChannel.h"
 #include "../Convolve.h"
+#include "../TileExecutor.h"
 
 namespace K {
 
@@ -33,6 +34,16 @@ namespace K {
 
 			}
 
+			/** like apply() but using the bands of the given executor. dst must have the same size as img */
+			static void apply(const ImageChannel& img, ImageChannel& dst, const TileExecutor& exec) {
+				const Kernel k = getKernelXY();
+				exec.run(img.getHeight(), k.getHeight() / 2, [&] (const TileBand& b) {
+					Convolve::convolveRows(img, dst, k, true, b.y0, b.y1);
+					float* row = dst.getData() + b.y0 * dst.getWidth();
+					for (int i = 0; i < (b.y1 - b.y0) * dst.getWidth(); ++i) {row[i] += 0.5f;}	// center around 50%
+				});
+			}
+
 			static Kernel getKernelXY() {
 				float values[9] = {
 					-2, -2,  0,
@@ -3,6 +3,10 @@
 
 #include "../ImageChannel.h"
 #include "../Bitmap.h"
+#include "../IntegralImage.h"
+#include "../ImageBuffer.h"
+
+#include <cmath>
 
 namespace K {
 
@@ -34,27 +38,75 @@ namespace K {
 
 			}
 
+			/**
+			 * convert the image to black/white using a local threshold (Niblack):
+			 * mean + k * stdDev + offset of the (2*radius+1)^2 neighborhood.
+			 * mean and stdDev are determined in O(1) using integral images
+			 */
+			static ImageChannel local(const ImageChannel& img, const int radius, const float k = 0.0f, const float offset = 0.0f) {
+
+				const IntegralImage ii(img, k != 0);
+				ImageChannel out(img.getWidth(), img.getHeight());
+
+				#pragma omp parallel for
+				for (int y = 0; y < img.getHeight(); ++y) {
+					for (int x = 0; x < img.getWidth(); ++x) {
+						float threshold = ii.getMeanAround(x, y, radius, radius) + offset;
+						if (k != 0) {threshold += k * std::sqrt(ii.getVarianceAround(x, y, radius, radius));}
+						out.set(x, y, (img.get(x, y) > threshold) ? (1.0f) : (0.0f));
+					}
+				}
+
+				return out;
+
+			}
+
 			/** convert the given image into a true/false bitmap */
 			static Bitmap bitmap(const ImageChannel& img, const float threshold = 0.5f, const bool invert = false) {
 
-				// create new bitmap
+				// create new bitmap (all cleared)
 				Bitmap out(img.getWidth(), img.getHeight());
 
 				// fill
-				auto trans = [&] (const int x, const int y, const float v) {
-					if (!invert) {
-						if (v > threshold) {out.set(x,y);} else {out.clear(x,y);}
-					} else {
-						if (v > threshold) {out.clear(x,y);} else {out.set(x,y);}
-					}
-				};
-				img.forEach(trans);
+				for (int y = 0; y < img.getHeight(); ++y) {
+					const float* row = img.getData() + (size_t) y * (size_t) img.getWidth();
+					setRow(out, y, [&] (const int x) {return (row[x] > threshold) != invert;});
+				}
 
 				// done
 				return out;
 
 			}
 
+			/** convert the given 8/16 bit (or half/float) image into a true/false bitmap, without converting it to float */
+			template <typename T> static Bitmap bitmap(const ImageBuffer<T>& img, const T threshold, const bool invert = false) {
+
+				Bitmap out(img.getWidth(), img.getHeight());
+				for (int y = 0; y < img.getHeight(); ++y) {
+					const T* row = img.getRow(y);
+					setRow(out, y, [&] (const int x) {return (row[x] > threshold) != invert;});
+				}
+				return out;
+
+			}
+
+		private:
+
+			/** pack the (bool) result of isSet(x) for each pixel of the y-th row into the bitmap's words */
+			template <typename Func> static inline void setRow(Bitmap& out, const int y, Func&& isSet) {
+				Bitmap::Word* dst = out.getRow(y);
+				const int w = out.getWidth();
+				for (int i = 0; i < out.getStride(); ++i) {
+					const int x0 = i * Bitmap::BITS;
+					const int x1 = std::min(w, x0 + Bitmap::BITS);
+					Bitmap::Word word = 0;
+					for (int x = x0; x < x1; ++x) {
+						word |= (Bitmap::Word) isSet(x) << (x - x0);
+					}
+					dst[i] = word;
+				}
+			}
+
 
 		};
 
@@ -4,6 +4,7 @@
 #include <eigen3/Eigen/Dense>
 #include "../ImageChannel.h"
 #include "../filter/Interpolation.h"
+#include "../filter/Remap.h"
 
 namespace K {
 
@@ -41,6 +42,20 @@ namespace K {
 
 			}
 
+			/**
+			 * get a remap plan for the given transformation, for applying it to many images.
+			 * like affine(), but samples bilinear. destination pixels outside of the source remain untouched
+			 */
+			template <typename Scalar> static Remap::Plan getPlan(const Eigen::Matrix<Scalar,3,3>& matrix, const int srcW, const int srcH, const int dstW, const int dstH, const TileExecutor& exec = TileExecutor()) {
+				auto map = [&] (const int x, const int y) {
+					Eigen::Matrix<Scalar,3,1> vSrc; vSrc << (Scalar) x, (Scalar) y, 1;
+					Eigen::Matrix<Scalar,3,1> vDst;
+					transform(matrix, vSrc, vDst);
+					return Point2f((float) vDst(0), (float) vDst(1));
+				};
+				return Remap::Plan(srcW, srcH, dstW, dstH, map, Remap::SKIP, exec);
+			}
+
 		private:
 
 			static inline float sample(const float x, const float y, const ImageChannel& src) {
@@ -4,6 +4,8 @@
 #include "EllipseEstimator.h"
 #include "../ImageChannel.h"
 #include "../segmentation/Segmentation.h"
+#include "../segmentation/ConnectedComponents.h"
+#include "../TileExecutor.h"
 
 #include "../filter/Clean.h"
 #include "../filter/Gauss.h"
@@ -13,7 +15,11 @@
 #include "../ImageFactory.h"
 #include "../OpenCV.h"
 
-#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 namespace K {
 
@@ -25,6 +31,19 @@ namespace K {
 		bool combineSimilar = false;
 		float blurSigma = 1.75f;
 
+		/** labelling buffers, reused for every image */
+		K::ConnectedComponents cc;
+
+		/** skip segments that can not yield a valid ellipse before running RANSAC */
+		bool earlyReject = true;
+
+		/** segments are fitted in parallel */
+		TileExecutor exec;
+
+		/** two ellipses are similar when their centers and axes differ by less than */
+		static constexpr float SIMILAR_CENTER = 16;
+		static constexpr float SIMILAR_AXES = 6;
+
 	public:
 
 		EllipseDetection() {
@@ -53,6 +72,19 @@ namespace K {
 			this->blurSigma = sigma;
 		}
 
+		/**
+		 * whether to skip segments that are too short, too large or (nearly) straight before running RANSAC.
+		 * a heuristic: short arcs of large ellipses are skipped as well, although RANSAC might fit them
+		 */
+		void setEarlyReject(const bool reject) {
+			this->earlyReject = reject;
+		}
+
+		/** set the executor used for fitting the segments in parallel */
+		void setExecutor(const TileExecutor& exec) {
+			this->exec = exec;
+		}
+
 		/** perform ellipse-detection on a given black/white image with 1pixel wide,white edges */
 		std::vector<K::Ellipse::GeometricParams> getFromEdgeImage(const K::ImageChannel& imgEdges) {
 
@@ -66,26 +98,37 @@ namespace K {
 
 			const K::ImageChannel imgEdgesBlur = getBlurred(imgEdges);
 
-			std::vector<K::Ellipse::GeometricParams> ellipses;
-
-			//#pragma omp parallel for
-			for (size_t i = 0; i < splitSegments.size(); ++i) {
+			// fit all segments in parallel. each segment uses its own seed, thus the result
+			// does not depend on the scheduling. the results keep the segments' order.
+			// the RANSAC's debug callback is not expected to be thread-safe: serial then
+			const int num = (int) splitSegments.size();
+			std::vector<K::Ellipse::GeometricParams> results(num);
+			std::vector<uint8_t> valid(num, 0);
+			const TileExecutor fitExec = (ransac.callback) ? (TileExecutor(1)) : (exec);
+			fitExec.forEach(num, [&] (const int i) {
 
 				// current segment
-
 				const std::vector<K::Point2i>& set = splitSegments[i];
+				if (set.size() < 3) {return;}
+				if (earlyReject && !isCandidate(set)) {return;}
 
 				// perform detection for the current segment
 				K::EllipseEstimator::RANSACPixel::MatchStats stats;
-				K::Ellipse::CanonicalParams canon = ransac.get(set, imgEdgesBlur, stats);
+				K::Ellipse::CanonicalParams canon = ransac.get(set, imgEdgesBlur, stats, i + 1);
 
-				//if (canon.F < 0) {continue;}
+				//if (canon.F < 0) {return;}
 
 				K::Ellipse::GeometricParams geo = canon.toGeometric();
-				if (geo.a != geo.a || geo.b != geo.b) {continue;}
+				if (geo.a != geo.a || geo.b != geo.b) {return;}
+
+				results[i] = geo;
+				valid[i] = 1;
 
-				ellipses.push_back(geo);
+			});
 
+			std::vector<K::Ellipse::GeometricParams> ellipses;
+			for (int i = 0; i < num; ++i) {
+				if (valid[i]) {ellipses.push_back(results[i]);}
 			}
 
 //			return ellipses;
@@ -102,6 +145,58 @@ namespace K {
 
 	private:
 
+		/**
+		 * cheap checks whether RANSAC is likely to find a valid ellipse for the given segment.
+		 * the segment's points are expected to lie on (a part of) the ellipse's outline:
+		 * - too few points: each RANSAC sample averages 3 points, the SVD needs several samples
+		 * - extent: the segment can not be longer than the major axis of the largest allowed ellipse
+		 * - curvature: (nearly) straight segments yield degenerate conics
+		 */
+		bool isCandidate(const std::vector<K::Point2i>& seg) const {
+
+			if (seg.size() < 16) {return false;}
+
+			// principal axes of the points
+			double sx = 0, sy = 0;
+			for (const K::Point2i& p : seg) {sx += p.x; sy += p.y;}
+			const double mx = sx / (double) seg.size();
+			const double my = sy / (double) seg.size();
+			double cxx = 0, cxy = 0, cyy = 0;
+			for (const K::Point2i& p : seg) {
+				const double dx = p.x - mx;
+				const double dy = p.y - my;
+				cxx += dx*dx; cxy += dx*dy; cyy += dy*dy;
+			}
+			const double angle = 0.5 * std::atan2(2*cxy, cxx - cyy);
+			const double ux = std::cos(angle);
+			const double uy = std::sin(angle);
+
+			// the segment's extent along both axes
+			double min1 = +INFINITY, max1 = -INFINITY, min2 = +INFINITY, max2 = -INFINITY;
+			for (const K::Point2i& p : seg) {
+				const double d1 = (p.x - mx) * ux + (p.y - my) * uy;
+				const double d2 = (p.y - my) * ux - (p.x - mx) * uy;
+				min1 = std::min(min1, d1); max1 = std::max(max1, d1);
+				min2 = std::min(min2, d2); max2 = std::max(max2, d2);
+			}
+
+			// the largest allowed major axis: a+b <= maxSize and a/b <= maxRatio. +2 pixels tolerance
+			const float maxSize = ransac.getMaxSize();
+			const float maxRatio = ransac.getMaxRatio();
+			if (maxSize != ransac.IGNORE) {
+				const double maxA = (maxRatio != ransac.IGNORE) ? (maxSize * maxRatio / (1 + maxRatio)) : (maxSize);
+				if (max1 - min1 > 2 * maxA + 2) {return false;}
+			}
+
+			// a rasterized straight line is at most ~1.5 pixels thick. heuristic: this also
+			// rejects short arcs of large ellipses, whose outline might still be covered
+			if (max2 - min2 < 2) {return false;}
+
+			return true;
+
+		}
+
+#ifdef WITH_OPENCV
 		void debug(const std::vector<std::vector<K::Point2i>>& segments, const K::ImageChannel edges) {
 
 			for (const std::vector<K::Point2i>& seg : segments) {
@@ -114,6 +209,7 @@ namespace K {
 			}
 
 		}
+#endif
 
 
 		K::ImageChannel getBlurred(const K::ImageChannel& imgEdges) {
@@ -269,46 +365,67 @@ namespace K {
 
 		std::vector<std::vector<K::Point2i>> getSegments(const K::ImageChannel& imgEdges)  {
 
-			// get all segments within the image
-			std::vector<K::Segment<float>> segments = K::Segmentation::getSegments(imgEdges);
-			std::vector<std::vector<K::Point2i>> result;
+			// label all segments within the image
+			cc.run(imgEdges, 0.1f);
 
-			for (const K::Segment<float>& seg : segments) {
-
-				if (seg.points.size() < 16)	{continue;}							// ingore very small segments
-				if (seg.avg == 0)			{continue;}							// ignore black parts
-
-				result.push_back(seg.points);
-
-			}
-
-			return result;
+			// the stats allow skipping segments before collecting their points.
+			// RANSAC and the splitting need the points ordered along the edges
+			return cc.getPointsTraced(imgEdges, [] (const K::ConnectedComponents::Stats& s) {
+				if (s.area < 16)			{return false;}						// ingore very small segments
+				if (s.getAvg() == 0)		{return false;}						// ignore black parts
+				return true;
+			});
 
 		}
 
 	public:
 
-		/** combine ellipses that are similar and return a new ellipse which is given by their average */
+		/**
+		 * combine ellipses that are similar and return a new ellipse which is given by their average.
+		 * each ellipse is joined with the first similar one kept before. the kept ellipses are hashed
+		 * by their center (cells of the maximum center distance), thus only those within the 3x3
+		 * neighboring cells need to be compared
+		 */
 		static inline std::vector<K::Ellipse::GeometricParams> filterDuplicates(const std::vector<K::Ellipse::GeometricParams>& src) {
 
 			std::vector<K::Ellipse::GeometricParams> filtered;
+			std::unordered_map<uint64_t, std::vector<int>> cells;
 
 			for (const K::Ellipse::GeometricParams& e1 : src) {
 
-				bool unique = true;
-				for (K::Ellipse::GeometricParams& e2 : filtered) {
-
-					const float dCenterDiff = e1.center.getDistance(e2.center);
-					//const float dSizeRatio = std::max(e1.getCircumfence(), e2.getCircumfence()) / std::min(e1.getCircumfence(), e2.getCircumfence());
-					const float dAxis = std::sqrt(  ((e1.a - e2.a) * (e1.a - e2.a)) + ((e1.b - e2.b) * (e1.b - e2.b))  );
-					const bool isSimilar = (dCenterDiff < 16) && (dAxis < 6);// && (dSizeRatio < 1.12f);
-
-					// if this ellipse is similar to an existing one, join the two
-					if (isSimilar) { unique = false; e2.mix(e1, 0.50f); break; }
+				// NaN centers are never similar to anything
+				if (e1.center.x != e1.center.x || e1.center.y != e1.center.y) {filtered.push_back(e1); continue;}
+
+				// the first (kept) similar ellipse within the neighboring cells
+				const int64_t cx = getCell(e1.center.x);
+				const int64_t cy = getCell(e1.center.y);
+				int match = -1;
+				for (int64_t y = cy - 1; y <= cy + 1; ++y) {
+					for (int64_t x = cx - 1; x <= cx + 1; ++x) {
+						const auto it = cells.find(getKey(x, y));
+						if (it == cells.end()) {continue;}
+						for (const int idx : it->second) {
+							if ((match < 0 || idx < match) && isSimilar(e1, filtered[idx])) {match = idx;}
+						}
+					}
+				}
 
+				if (match < 0) {
+					cells[getKey(cx, cy)].push_back((int) filtered.size());
+					filtered.push_back(e1);
+					continue;
 				}
 
-				if (unique) { filtered.push_back(e1); }
+				// join the two. the center moves and might end up within another cell
+				K::Ellipse::GeometricParams& e2 = filtered[match];
+				const uint64_t oldKey = getKey(getCell(e2.center.x), getCell(e2.center.y));
+				e2.mix(e1, 0.50f);
+				const uint64_t newKey = getKey(getCell(e2.center.x), getCell(e2.center.y));
+				if (newKey != oldKey) {
+					std::vector<int>& old = cells[oldKey];
+					old.erase(std::find(old.begin(), old.end(), match));
+					cells[newKey].push_back(match);
+				}
 
 			}
 
@@ -316,7 +433,24 @@ namespace K {
 
 		}
 
+	private:
 
+		/** are the two ellipses similar? */
+		static inline bool isSimilar(const K::Ellipse::GeometricParams& e1, const K::Ellipse::GeometricParams& e2) {
+			const float dCenterDiff = e1.center.getDistance(e2.center);
+			//const float dSizeRatio = std::max(e1.getCircumfence(), e2.getCircumfence()) / std::min(e1.getCircumfence(), e2.getCircumfence());
+			const float dAxis = std::sqrt(  ((e1.a - e2.a) * (e1.a - e2.a)) + ((e1.b - e2.b) * (e1.b - e2.b))  );
+			return (dCenterDiff < SIMILAR_CENTER) && (dAxis < SIMILAR_AXES);// && (dSizeRatio < 1.12f);
+		}
+
+		/** the hash-cell of the given coordinate. clamping keeps neighboring cells adjacent */
+		static inline int64_t getCell(const float v) {
+			return (int64_t) std::min(std::max(std::floor(v / SIMILAR_CENTER), -1e9f), 1e9f);
+		}
+
+		static inline uint64_t getKey(const int64_t cx, const int64_t cy) {
+			return ((uint64_t) cx << 32) ^ (uint64_t) (uint32_t) cy;
+		}
 
 	};
 
@@ -40,6 +40,7 @@ namespace K {
 
 		public:
 
+			/** debug: called for each estimated ellipse. the const get() may call it from several threads */
 			std::function<void(const Ellipse::GeometricParams&)> callback = nullptr;
 
 		public:
@@ -184,17 +185,36 @@ namespace K {
 			/** set the number of samples to use for ellipse-SVD-estimation */
 			void setNumSamples(const int numSamples) {this->numSamples = numSamples;}
 
+			/** get the size constraint (a+b). IGNORE = unconstrained */
+			float getMinSize() const {return minSize;}
+			float getMaxSize() const {return maxSize;}
+
+			/** get the ratio constraint (a/b). IGNORE = unconstrained */
+			float getMinRatio() const {return minRatio;}
+			float getMaxRatio() const {return maxRatio;}
+
 			/** get an ellipse estimation */
 			template <typename Scalar> Ellipse::CanonicalParams get(const std::vector<Point2<Scalar>>& rndPoints, const K::ImageChannel& img, ImageMatchStats& _bestStats) {
+				static int seed = 0; ++seed;
+				return get(rndPoints, img, _bestStats, seed);
+			}
+
+			/**
+			 * get an ellipse estimation, drawing the random samples using the given seed.
+			 * thread-safe as long as the callback (if any) is
+			 */
+			template <typename Scalar> Ellipse::CanonicalParams get(const std::vector<Point2<Scalar>>& rndPoints, const K::ImageChannel& img, ImageMatchStats& _bestStats, const int seed) const {
 
 				ImageMatchStats bestStats;
 				Estimation bestParams;
 
+				// each sample averages the points idx-1, idx and idx+1
+				_assertTrue(rndPoints.size() >= 3, "at least 3 points are needed");
+
 				// provides random samples
 				//RandomIterator<Point2<Scalar>> it(rndPoints, numSamples);
-				static int seed = 0; ++seed;
 				std::minstd_rand gen(seed);
-				std::uniform_int_distribution<int> dist(1, rndPoints.size()-1);
+				std::uniform_int_distribution<int> dist(1, (int) rndPoints.size()-2);
 
 
 				// process X RANSAC runs
@@ -218,7 +238,7 @@ namespace K {
 					// get geometric representation (if possible)
 					Ellipse::CanonicalParams canon = params.toEllipse();
 					canon.fixF();
-					if (canon.F <= 0) {std::cout << "fix negative F" << std::endl; continue;}
+					if (canon.F <= 0) {continue;}
 
 					const Ellipse::GeometricParams geo = canon.toGeometric();
 
@@ -0,0 +1,100 @@
+#ifndef MATCHINGNCC_H
+#define MATCHINGNCC_H
+
+#include "../../geo/Point2.h"
+#include "../ImageChannel.h"
+#include "../IntegralImage.h"
+
+#include <cmath>
+
+namespace K {
+
+	/**
+	 * determine matching of two areas within two images
+	 * using a window around a given point, examining
+	 * the normalized cross-correlation of both windows.
+	 *
+	 * mean and variance of each window are O(1) using
+	 * integral images, only the cross term is summed up.
+	 * windows exceeding the image use clamped values
+	 * (like MatchingConvolution) and are summed up completely.
+	 */
+	class MatchingNCC {
+
+	private:
+
+		const ImageChannel& img1;
+		const ImageChannel& img2;
+		int size;
+
+		IntegralImage ii1;
+		IntegralImage ii2;
+
+	public:
+
+		/** ctor with both images */
+		MatchingNCC(const ImageChannel& img1, const ImageChannel& img2, const int winSize = 7) :
+			img1(img1), img2(img2), size(winSize/2), ii1(img1, true), ii2(img2, true) {
+			;
+		}
+
+		/** get the correlation [-1:+1] between the two given regions (0 for uniform regions) */
+		float getScore(const Point2i pImg1, const Point2i pImg2) const {
+
+			const int n = (2*size+1) * (2*size+1);
+			double s1, s2, sq1, sq2;
+			double s12 = 0;
+
+			if (isInside(img1, pImg1) && isInside(img2, pImg2)) {
+
+				s1 = ii1.getSumAround(pImg1.x, pImg1.y, size, size);
+				s2 = ii2.getSumAround(pImg2.x, pImg2.y, size, size);
+				sq1 = ii1.getSumSquared(pImg1.x-size, pImg1.y-size, pImg1.x+size+1, pImg1.y+size+1);
+				sq2 = ii2.getSumSquared(pImg2.x-size, pImg2.y-size, pImg2.x+size+1, pImg2.y+size+1);
+
+				for (int y = -size; y <= +size; ++y) {
+					const float* r1 = img1.getData() + (pImg1.y+y) * img1.getWidth() + pImg1.x;
+					const float* r2 = img2.getData() + (pImg2.y+y) * img2.getWidth() + pImg2.x;
+					for (int x = -size; x <= +size; ++x) {s12 += r1[x] * r2[x];}
+				}
+
+			} else {
+
+				s1 = s2 = sq1 = sq2 = 0;
+				for (int y = -size; y <= +size; ++y) {
+					for (int x = -size; x <= +size; ++x) {
+						const double v1 = img1.getClamped(pImg1.x+x, pImg1.y+y);
+						const double v2 = img2.getClamped(pImg2.x+x, pImg2.y+y);
+						s1 += v1; sq1 += v1*v1;
+						s2 += v2; sq2 += v2*v2;
+						s12 += v1*v2;
+					}
+				}
+
+			}
+
+			const double cov = s12 - s1*s2/n;
+			const double var1 = sq1 - s1*s1/n;
+			const double var2 = sq2 - s2*s2/n;
+			if (var1 <= 1e-12 || var2 <= 1e-12) {return 0;}
+			return (float) (cov / std::sqrt(var1*var2));
+
+		}
+
+		/** get the error [0:2] between the two given regions (for Matching::refine) */
+		float getError(const Point2i pImg1, const Point2i pImg2) const {
+			return 1.0f - getScore(pImg1, pImg2);
+		}
+
+	private:
+
+		/** is the window around p completely within the image? */
+		inline bool isInside(const ImageChannel& img, const Point2i p) const {
+			return p.x-size >= 0 && p.y-size >= 0 && p.x+size < img.getWidth() && p.y+size < img.getHeight();
+		}
+
+	};
+
+}
+
+#endif // MATCHINGNCC_H
@@ -3,6 +3,7 @@
 
 #include "../../geo/Point2.h"
 #include "../ImageChannel.h"
+#include "../IntegralImage.h"
 
 namespace K {
 
@@ -46,6 +47,38 @@ namespace K {
 
 		}
 
+		/**
+		 * get the error for every pixel p of img1 when matched against p+offset within img2.
+		 * same as getError(p, p+offset) for all p, but each window sum is O(1)
+		 * by using an integral image of the absolute differences
+		 */
+		ImageChannel getErrors(const Point2i offset) const {
+
+			// absolute differences, including a border of 'size' pixels (clamped access, like getError)
+			const int w = img1.getWidth() + 2*size;
+			const int h = img1.getHeight() + 2*size;
+			ImageChannel diff(w, h);
+			#pragma omp parallel for
+			for (int y = 0; y < h; ++y) {
+				for (int x = 0; x < w; ++x) {
+					const float v1 = img1.getClamped(x-size, y-size);
+					const float v2 = img2.getClamped(x-size+offset.x, y-size+offset.y);
+					diff.set(x, y, std::abs(v1-v2));
+				}
+			}
+
+			const IntegralImage ii(diff);
+			ImageChannel errors(img1.getWidth(), img1.getHeight());
+			#pragma omp parallel for
+			for (int y = 0; y < img1.getHeight(); ++y) {
+				for (int x = 0; x < img1.getWidth(); ++x) {
+					errors.set(x, y, (float) ii.getSum(x, y, x+2*size+1, y+2*size+1));
+				}
+			}
+			return errors;
+
+		}
+
 	};
 
 }
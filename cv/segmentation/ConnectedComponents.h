@@ -0,0 +1,356 @@
+#ifndef K_CV_CONNECTEDCOMPONENTS_H
+#define K_CV_CONNECTEDCOMPONENTS_H
+
+#include "../../geo/Point2.h"
+#include "../../geo/BBox2.h"
+#include "../ImageChannel.h"
+#include "../Bitmap.h"
+#include "../TileExecutor.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace K {
+
+	/**
+	 * connected-component labelling (8-neighborhood) using two passes and union-find.
+	 *
+	 * two adjacent pixels are connected when their difference is below the given threshold,
+	 * which yields the same segments as RegionGrowing started from every (unused) pixel.
+	 *
+	 * 1st pass: the image is split into bands of rows that are labelled in parallel.
+	 * each pixel is compared against its already visited neighbors (a b c above, d left)
+	 * and only joins those sets, that are not yet known to be joined (decision tree).
+	 * the bands are then merged along their borders.
+	 * 2nd pass: the final labels are assigned (ordered by the component's first pixel, row by row)
+	 * and area, bbox, centroid and average value of each component are gathered on the fly.
+	 *
+	 * the buffers are kept and reused when labelling several images.
+	 */
+	class ConnectedComponents {
+
+	public:
+
+		/** statistics of one component */
+		struct Stats {
+
+			/** the number of pixels */
+			int area = 0;
+
+			/** the pixels' bounding-box */
+			BBox2i bbox;
+
+			/** the component's first pixel (row by row) */
+			Point2i first;
+
+			/** the component's first pixel (column by column) */
+			Point2i firstColumn;
+
+			/** sum of all x/y coordinates and pixel values */
+			double sumX = 0;
+			double sumY = 0;
+			double sumVal = 0;
+
+			/** get the center of all pixels */
+			Point2f getCentroid() const {return Point2f((float) (sumX / area), (float) (sumY / area));}
+
+			/** get the average pixel value */
+			float getAvg() const {return (float) (sumVal / area);}
+
+		};
+
+	private:
+
+		/** image size */
+		int width = 0;
+		int height = 0;
+
+		/** union-find forest over pixel indices (-1 = excluded). each root is its set's smallest index */
+		std::vector<int> parent;
+
+		/** the threshold used by run() */
+		float threshold = 0;
+
+		/** the final label of each pixel (-1 = excluded) */
+		std::vector<int> labels;
+
+		/** the statistics for each label */
+		std::vector<Stats> stats;
+
+		/** pixels already walked by getPointsTraced() */
+		std::vector<uint8_t> visited;
+
+	public:
+
+		/**
+		 * label all connected pixels within the given image
+		 * @param img the image to label
+		 * @param threshold the maximum difference to allow between two adjacent pixels
+		 * @param used optional: pixels set within this bitmap are excluded (label -1)
+		 * @param exec the bands to label in parallel
+		 */
+		void run(const ImageChannel& img, const float threshold, const Bitmap* used = nullptr, const TileExecutor& exec = TileExecutor()) {
+
+			width = img.getWidth();
+			height = img.getHeight();
+			this->threshold = threshold;
+			const size_t num = (size_t) width * (size_t) height;
+			parent.resize(num);
+			labels.resize(num);
+			stats.clear();
+
+			// 1st pass: label each band independently
+			const std::vector<TileBand> bands = exec.getBands(height, 0);
+			exec.run(bands, [&] (const TileBand& b) {
+				for (int y = b.y0; y < b.y1; ++y) {
+					labelRow(img, threshold, used, y, y > b.y0);
+				}
+			});
+
+			// merge the bands along their borders
+			for (size_t i = 1; i < bands.size(); ++i) {
+				mergeRow(img, threshold, bands[i].y0);
+			}
+
+			// 2nd pass: final labels (roots come before all other pixels of their set) and stats
+			const float* data = img.getData();
+			int i = 0;
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x, ++i) {
+					if (parent[i] < 0) {labels[i] = -1; continue;}
+					const int r = findRoot(i);
+					if (r == i) {
+						labels[i] = (int) stats.size();
+						stats.push_back(Stats());
+						stats.back().first = Point2i(x, y);
+						stats.back().firstColumn = Point2i(x, y);
+					} else {
+						labels[i] = labels[r];
+					}
+					Stats& s = stats[labels[i]];
+					if (x < s.firstColumn.x) {s.firstColumn = Point2i(x, y);}
+					++s.area;
+					s.bbox.add(x, y);
+					s.sumX += x;
+					s.sumY += y;
+					s.sumVal += data[i];
+				}
+			}
+
+		}
+
+		/** get the number of labelled components */
+		int getNumComponents() const {return (int) stats.size();}
+
+		/** get the statistics of all components, indexed by label */
+		const std::vector<Stats>& getStats() const {return stats;}
+
+		/** get the statistics of the given component */
+		const Stats& getStats(const int label) const {return stats[label];}
+
+		/** get the label at (x,y). -1 = excluded */
+		int getLabel(const int x, const int y) const {
+			_assertBetween(x, 0, width-1, "x out of bounds");
+			_assertBetween(y, 0, height-1, "y out of bounds");
+			return labels[(size_t) y * (size_t) width + (size_t) x];
+		}
+
+		/** get all labels, row by row */
+		const std::vector<int>& getLabels() const {return labels;}
+
+		/** get the pixels of all components, ordered by label. the pixels are ordered row by row */
+		std::vector<std::vector<Point2i>> getPoints() const {
+			return getPoints([] (const Stats&) {return true;});
+		}
+
+		/**
+		 * get the pixels of all components accepted by keep(const Stats&), ordered by label.
+		 * the pixels are ordered row by row. rejected components are skipped
+		 */
+		template <typename Keep> std::vector<std::vector<Point2i>> getPoints(Keep keep) const {
+
+			// the output index of each label (-1 = rejected)
+			std::vector<int> idx(stats.size(), -1);
+			std::vector<std::vector<Point2i>> res;
+			for (size_t l = 0; l < stats.size(); ++l) {
+				if (!keep(stats[l])) {continue;}
+				idx[l] = (int) res.size();
+				res.emplace_back();
+				res.back().reserve((size_t) stats[l].area);
+			}
+
+			int i = 0;
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x, ++i) {
+					const int l = labels[i];
+					if (l >= 0 && idx[l] >= 0) {res[idx[l]].push_back(Point2i(x, y));}
+				}
+			}
+			return res;
+
+		}
+
+		/**
+		 * get the pixels of all components accepted by keep(const Stats&), like
+		 * Segmentation did by running RegionGrowing from each unused pixel, column by column:
+		 * the components are ordered by their first pixel (column by column) and the pixels by
+		 * RegionGrowing's depth-first walk, starting there. for thin structures (edges) this
+		 * (mostly) follows the curve, unlike the row by row order
+		 * @param img the image given to run()
+		 * @param keep skip components rejected by keep(const Stats&)
+		 */
+		template <typename Keep> std::vector<std::vector<Point2i>> getPointsTraced(const ImageChannel& img, Keep keep) {
+
+			_assertTrue(img.getWidth() == width && img.getHeight() == height, "image does not match the labelled one");
+
+			// the kept labels, column by column
+			std::vector<int> order;
+			for (size_t l = 0; l < stats.size(); ++l) {
+				if (keep(stats[l])) {order.push_back((int) l);}
+			}
+			std::sort(order.begin(), order.end(), [&] (const int a, const int b) {
+				const Point2i& pa = stats[a].firstColumn;
+				const Point2i& pb = stats[b].firstColumn;
+				return (pa.x != pb.x) ? (pa.x < pb.x) : (pa.y < pb.y);
+			});
+
+			const float* data = img.getData();
+			std::vector<std::vector<Point2i>> res;
+			visited.assign(labels.size(), 0);
+			std::vector<int> toCheck;
+
+			for (const int l : order) {
+
+				res.emplace_back();
+				std::vector<Point2i>& pts = res.back();
+				pts.reserve((size_t) stats[l].area);
+
+				// RegionGrowing's neighbor test: the difference to the current pixel
+				auto add = [&] (const int cur, const int x, const int y) {
+					const int i = y * width + x;
+					if (visited[i] || labels[i] != l) {return;}
+					if (std::abs(data[cur] - data[i]) > threshold) {return;}
+					visited[i] = 1;
+					pts.push_back(Point2i(x, y));
+					toCheck.push_back(i);
+				};
+
+				const Point2i& seed = stats[l].firstColumn;
+				const int iSeed = seed.y * width + seed.x;
+				add(iSeed, seed.x, seed.y);
+				while (!toCheck.empty()) {
+					const int i = toCheck.back();
+					toCheck.pop_back();
+					const int x = i % width;
+					const int y = i / width;
+					const bool le = x > 0;
+					const bool t = y > 0;
+					const bool r = x < width-1;
+					const bool b = y < height-1;
+
+					// same (clockwise) order as RegionGrowing
+					if (le)			{add(i, x-1, y  );}
+					if (le&&t)		{add(i, x-1, y-1);}
+					if (t)			{add(i, x  , y-1);}
+					if (r&&t)		{add(i, x+1, y-1);}
+					if (r)			{add(i, x+1, y  );}
+					if (r&&b)		{add(i, x+1, y+1);}
+					if (b)			{add(i, x  , y+1);}
+					if (le&&b)		{add(i, x-1, y+1);}
+				}
+
+			}
+			return res;
+
+		}
+
+	private:
+
+		/** find the root of i's set, halving the path */
+		inline int findRoot(int i) {
+			while (parent[i] != i) {
+				parent[i] = parent[parent[i]];
+				i = parent[i];
+			}
+			return i;
+		}
+
+		/** join the sets of i and j. the smaller index becomes the root */
+		inline void unite(const int i, const int j) {
+			const int ri = findRoot(i);
+			const int rj = findRoot(j);
+			if (ri < rj) {parent[rj] = ri;} else if (rj < ri) {parent[ri] = rj;}
+		}
+
+		/** are the two (adjacent) pixels connected? */
+		inline bool isConnected(const float* data, const int i, const int j, const float threshold) const {
+			return parent[i] >= 0 && parent[j] >= 0 && std::abs(data[i] - data[j]) <= threshold;
+		}
+
+		/** 1st pass for row y. hasAbove: the row above belongs to the same band */
+		void labelRow(const ImageChannel& img, const float threshold, const Bitmap* used, const int y, const bool hasAbove) {
+
+			const float* data = img.getData();
+			const int i0 = y * width;
+
+			// excluded pixels first, the neighbor checks depend on them
+			const Bitmap::Word* usedRow = (used) ? (used->getRow(y)) : (nullptr);
+			for (int x = 0; x < width; ++x) {
+				const bool excluded = usedRow && ((usedRow[x / Bitmap::BITS] >> (x % Bitmap::BITS)) & 1);
+				parent[i0 + x] = (excluded) ? (-1) : (i0 + x);
+			}
+
+			for (int x = 0; x < width; ++x) {
+
+				const int i = i0 + x;
+				if (parent[i] < 0) {continue;}
+
+				// neighbors:  a b c
+				//             d i
+				const int ia = i - width - 1;
+				const int ib = i - width;
+				const int ic = i - width + 1;
+				const int id = i - 1;
+				const bool l = x > 0;
+				const bool r = x < width - 1;
+
+				const bool cb = hasAbove && isConnected(data, i, ib, threshold);
+				const bool ca = hasAbove && l && isConnected(data, i, ia, threshold);
+				const bool cc = hasAbove && r && isConnected(data, i, ic, threshold);
+				const bool cd = l && isConnected(data, i, id, threshold);
+
+				// join the neighbors, skipping those already joined via a neighbor handled before:
+				// a-b and b-c are adjacent (joined within the row above), d-a (d's b) and d-b (d's c)
+				int first = -1;
+				auto join = [&] (const int j) {
+					if (first < 0) {parent[i] = j; first = j;} else {unite(i, j);}
+				};
+				if (cb) {join(ib);}
+				if (ca && !(cb && isConnected(data, ia, ib, threshold))) {join(ia);}
+				if (cc && !(cb && isConnected(data, ib, ic, threshold))) {join(ic);}
+				if (cd && !(cb && isConnected(data, id, ib, threshold)) && !(ca && isConnected(data, id, ia, threshold))) {join(id);}
+
+			}
+
+		}
+
+		/** join the first row (y) of a band with the last row of the band above */
+		void mergeRow(const ImageChannel& img, const float threshold, const int y) {
+			const float* data = img.getData();
+			const int i0 = y * width;
+			for (int x = 0; x < width; ++x) {
+				const int i = i0 + x;
+				if (parent[i] < 0) {continue;}
+				if (x > 0 && isConnected(data, i, i - width - 1, threshold))			{unite(i, i - width - 1);}
+				if (isConnected(data, i, i - width, threshold))						{unite(i, i - width);}
+				if (x < width - 1 && isConnected(data, i, i - width + 1, threshold))	{unite(i, i - width + 1);}
+			}
+		}
+
+	};
+
+}
+
+#endif // K_CV_CONNECTEDCOMPONENTS_H
@@ -4,6 +4,7 @@
 #include "Segment.h"
 #include "../ImageChannel.h"
 #include "RegionGrowing.h"
+#include "ConnectedComponents.h"
 
 #include "unordered_set"
 
@@ -33,30 +34,29 @@ namespace K {
 		}
 
 		/**
-		 * get all connected segments within the given image
+		 * get all connected segments within the given image.
+		 * the segments are ordered by their first pixel (column by column), their pixels
+		 * in RegionGrowing's flood-fill order, starting there
 		 * @param img the image to segmentize
-		 * @param used respect the given bitmap of already used (segmentized) pixels
+		 * @param used respect the given bitmap of already used (segmentized) pixels. marks all new segments as used
 		 * @param threshold the maximum difference to allow between two adjacent pixels
 		 * @return
 		 */
 		static std::vector<Segment<float>> getSegments(const ImageChannel& img, Bitmap& used, const float threshold = 0.1f) {
 
-			// all detected segments
-			std::vector<Segment<float>> segments;
-
-			// process all points of the image
-			Point2i p(0,0);
-			for (p.x = 0; p.x < img.getWidth(); ++p.x) {
-				for (p.y = 0; p.y < img.getHeight(); ++p.y) {
-
-					// skip all points already belonging to a segment
-					if (used.isSet(p.x, p.y)) {continue;}
-
-					// get the segment belonging to the seed "p"
-					const Segment<float> s = RegionGrowing::get(img, p, used, threshold);
-					segments.push_back(s);
-
-				}
+			// label all (not yet used) pixels at once
+			ConnectedComponents cc;
+			cc.run(img, threshold, &used);
+
+			// all detected segments. the pixels in flood-fill order, which follows thin structures (edges)
+			std::vector<std::vector<Point2i>> points = cc.getPointsTraced(img, [] (const ConnectedComponents::Stats&) {return true;});
+			std::vector<Segment<float>> segments(points.size());
+			for (size_t l = 0; l < points.size(); ++l) {
+				Segment<float>& seg = segments[l];
+				seg.points = std::move(points[l]);
+				seg.avg = 0;
+				for (const Point2i& p : seg.points) {used.set(p); seg.avg += img.get(p.x, p.y);}
+				seg.avg /= (float) seg.points.size();
 			}
 
 			// done
@@ -64,8 +64,6 @@ namespace K {
 
 		}
 
-
-
 	};
 
 }
@@ -2,6 +2,7 @@
 #define K_DATA_JSON_JSONARRAY_H
 
 #include <vector>
+#include <memory_resource>
 #include "JSONValue.h"
 
 namespace K {
@@ -16,13 +17,16 @@ namespace K {
 		friend class JSONWriter;
 
 		/** all entries within the array */
-		std::vector<JSONValue> entries;
+		std::pmr::vector<JSONValue> entries;
 
 	public:
 
 		/** ctor */
 		JSONArray() {;}
 
+		/** ctor: allocate all entries from the given resource (e.g. an Arena) */
+		explicit JSONArray(std::pmr::memory_resource* res) : entries(res) {;}
+
 		/** dtor */
 		~JSONArray() {;}
 
@@ -67,9 +71,9 @@ namespace K {
 		}
 
 
-		std::vector<JSONValue>::const_iterator begin() const {return entries.begin();}
+		std::pmr::vector<JSONValue>::const_iterator begin() const {return entries.begin();}
 
-		std::vector<JSONValue>::const_iterator end() const {return entries.end();}
+		std::pmr::vector<JSONValue>::const_iterator end() const {return entries.end();}
 
 
 		/** get the idx-th entry within the array */
@@ -104,7 +108,7 @@ namespace K {
  * dunno why i need to add this one here instead of JSONValue.h.
  * putting it there fails to declare JSONArray.h somehow...
  */
-K::JSONValue::~JSONValue() {
+inline K::JSONValue::~JSONValue() {
 	switch(type) {
 		case JSONValueType::EMPTY:
 		case JSONValueType::BOOLEAN:
@@ -112,11 +116,14 @@ K::JSONValue::~JSONValue() {
 		case JSONValueType::DOUBLE:
 			break;
 		case JSONValueType::STRING:
-			delete[] s; s = nullptr; break;
+			if (!inArena) {delete[] s;}
+			s = nullptr; break;
 		case JSONValueType::JSON_OBJECT:
-			delete obj; obj = nullptr; break;
+			if (inArena) {if (obj) {obj->~JSONObject();}} else {delete obj;}
+			obj = nullptr; break;
 		case JSONValueType::JSON_ARRAY:
-			delete arr; arr = nullptr; break;
+			if (inArena) {if (arr) {arr->~JSONArray();}} else {delete arr;}
+			arr = nullptr; break;
 	}
 }
 
@@ -2,7 +2,10 @@
 #define K_DATA_JSON_JSONOBJECT_H
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <map>
+#include <tuple>
+#include <memory_resource>
 #include <cstdint>
 
 #include "JSONValue.h"
@@ -21,59 +24,75 @@ namespace K {
 
 		friend class JSONWriter;
 
-		/** all key-value pairs within this object */
-		std::unordered_map<std::string, JSONValue> keyVal;
+		/**
+		 * all key-value pairs within this object. keys are allocated from the same resource.
+		 * ordered with a transparent comparator: lookups compare against the given key without copying it
+		 */
+		std::pmr::map<std::pmr::string, JSONValue, std::less<>> keyVal;
+
+		/** the value for the given key. inserts a null-value (copying the key into the map's resource) if not yet present */
+		JSONValue& slot(const std::string& key) {
+			const auto it = keyVal.find(std::string_view(key));
+			if (it != keyVal.end()) {return it->second;}
+			return keyVal.emplace(std::piecewise_construct, std::forward_as_tuple(key.data(), key.size()), std::forward_as_tuple()).first->second;
+		}
 
 	public:
 
+		/** ctor */
+		JSONObject() {;}
+
+		/** ctor: allocate all key-value pairs from the given resource (e.g. an Arena) */
+		explicit JSONObject(std::pmr::memory_resource* res) : keyVal(res) {;}
+
 		/** set a null-value for the given key */
 		void putNull(const std::string& key) {
-			keyVal[key] = JSONValue();
+			slot(key) = JSONValue();
 		}
 
 		/** set a boolean-value for the given key */
 		void put(const std::string& key, const bool b) {
-			keyVal[key] = JSONValue(b);
+			slot(key) = JSONValue(b);
 		}	
 
 		/** set a double-value for the given key */
 		void put(const std::string& key, const double d) {
-			keyVal[key] = JSONValue(d);
+			slot(key) = JSONValue(d);
 		}
 
 		/** set an integer-value for the given key */
 		void put(const std::string& key, const long i) {
-			keyVal[key] = JSONValue(i);
+			slot(key) = JSONValue(i);
 		}
 
 		/** set a string-value for the given key */
 		void put(const std::string& key, const char* str) {
-			keyVal[key] = JSONValue(str);
+			slot(key) = JSONValue(str);
 		}
 
 		/** set a json-object for the given key */
 		void put(const std::string& key, JSONObject* obj) {
-			keyVal[key] = JSONValue(obj);
+			slot(key) = JSONValue(obj);
 		}
 
 		/** set a json-array for the given key */
 		void put(const std::string& key, JSONArray* arr) {
-			keyVal[key] = JSONValue(arr);
+			slot(key) = JSONValue(arr);
 		}
 
 		/** set something for the given key */
 		void put(const std::string& key, JSONValue&& val) {
-			keyVal[key] = std::move(val);
+			slot(key) = std::move(val);
 		}
 
 		/** does the object contain a value for the given key? */
 		bool containsValue(const std::string& key) {
-			return (keyVal.find(key) != keyVal.end());
+			return (keyVal.find(std::string_view(key)) != keyVal.end());
 		}
 
 		/** get the value for the given key. throws an exception if no such value is present */
 		const JSONValue& getValue(const std::string& key) const {
-			const auto& it = keyVal.find(key);
+			const auto it = keyVal.find(std::string_view(key));
 			if (it == keyVal.end()) {throw "value for key not present";}
 			return it->second;
 		}
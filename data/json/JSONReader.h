@@ -3,6 +3,7 @@
 
 #include "JSONArray.h"
 #include "JSONObject.h"
+#include "../../streams/MappedFileInputStream.h"
 #include <cassert>
 
 namespace K {
@@ -22,57 +23,92 @@ namespace K {
 
 		const char* start;
 		const char* str;
-		const int len;
+		const size_t len;
 
 		/** ctor */
-		Reader(const std::string& str) : start(str.c_str()), str(str.c_str()), len((int)str.length()) {;}
+		Reader(const std::string& str) : start(str.c_str()), str(str.c_str()), len(str.length()) {;}
+
+		/** ctor. the given memory does not need to be null-terminated */
+		Reader(const char* str, const size_t len) : start(str), str(str), len(len) {;}
 
 		/** assert the next available char is c and hereafter consume it */
 		void consume(const char c) {
-			if (str[0] != c) {
-				throw JSONReaderException(std::string("found unexpected token: expected '") + c + "' got '" + str[0] + "'");
+			if (peek() != c) {
+				throw JSONReaderException(std::string("found unexpected token: expected '") + c + "' got '" + peek() + "'");
 			}
 			++str;}
 
 		/** consume the next available char. no matter what it is */
-		char consume() {char c = str[0]; ++str; return c;}
+		char consume() {
+			if (isEmpty()) {throw JSONReaderException("unexpected end of input");}
+			char c = str[0]; ++str; return c;
+		}
 
 		/** if the next available char is c, consume it and return true, else keep it and return false */
 		bool tryConsume(const char c) {
-			if (str[0] == c) {++str; return true;} else {return false;}
+			if (peek() == c) {++str; return true;} else {return false;}
 		}
 
-		/** peek into the next available char */
-		char peek() const {return str[0];}
+		/** peek into the next available char. '\0' at the end of the input */
+		char peek() const {return (isEmpty()) ? ('\0') : (str[0]);}
 
 		/** peek whether the next available char is c */
 		bool peek(const char c) {return peek() == c;}
 
 		/** is the buffer empty? */
-		bool isEmpty() const {return str == (start + len);}
+		bool isEmpty() const {return str >= (start + len);}
+
+		/** get the (remaining) unparsed input, e.g. for error messages */
+		std::string remaining() const {return (isEmpty()) ? ("") : (std::string(str, start + len - str));}
 
 	};
 
 
 
+	/**
+	 * parse JSON input into a JSONValue graph.
+	 *
+	 * when constructed with an Arena, all objects, arrays and strings are
+	 * allocated within the arena instead of using new/delete per node.
+	 * the arena must outlive the returned value.
+	 */
 	class JSONReader {
 
+	private:
+
+		/** allocate the graph from this arena (if any) */
+		Arena* arena;
+
 	public:
 
+		/** ctor */
+		explicit JSONReader(Arena* arena = nullptr) : arena(arena) {;}
+
 		/** parse the given input data */
 		JSONValue parse(const std::string& str) {
-			Reader r(str);
+			return parse(str.data(), str.length());
+		}
+
+		/** parse the given memory region. the data does not need to be null-terminated */
+		JSONValue parse(const char* str, const size_t len) {
+			Reader r(str, len);
 			JSONValue res = switchOA(r);
 
 			// the buffer must now be empty. else there is suspicious data at the end
 			if (!r.isEmpty()) {
-				throw JSONReaderException(std::string("found unexpected trailing data:\n") + r.str);
+				throw JSONReaderException(std::string("found unexpected trailing data:\n") + r.remaining());
 			}
 
 			return res;
 
 		}
 
+		/** parse the given file. the file is memory-mapped instead of being copied */
+		JSONValue parseFile(const std::string& file) {
+			MappedFileInputStream is(file);
+			return parse((const char*) is.getData(), is.getLength());
+		}
+
 	private:
 
 		/** decide whether the next object is a JSONArray or a JSONObject */
@@ -88,7 +124,7 @@ namespace K {
 		/** parse and return a JSONArray */
 		JSONValue parseArray(Reader& r) const {
 			r.consume('[');
-			JSONArray* arr = new JSONArray();
+			JSONArray* arr = (arena) ? (arena->create<JSONArray>(arena->getResource())) : (new JSONArray());
 			try {
 				skipWhitespaces(r);
 				if (!r.tryConsume(']')) {
@@ -100,17 +136,17 @@ namespace K {
 					r.consume(']');
 				}
 			} catch (...) {
-				delete arr;
+				if (arena) {arr->~JSONArray();} else {delete arr;}
 				throw;
 			}
 			skipWhitespaces(r);
-			return JSONValue(arr);
+			return (arena) ? (JSONValue(arr, *arena)) : (JSONValue(arr));
 		}
 
 		/** parse and return a JSONObject */
 		JSONValue parseObject(Reader& r) const {
 			r.consume('{');
-			JSONObject* obj = new JSONObject();
+			JSONObject* obj = (arena) ? (arena->create<JSONObject>(arena->getResource())) : (new JSONObject());
 			skipWhitespaces(r);
 			try {
 				if (!r.tryConsume('}')) {
@@ -127,12 +163,12 @@ namespace K {
 					r.consume('}');
 				}
 			} catch (...) {
-				delete obj;
+				if (arena) {obj->~JSONObject();} else {delete obj;}
 				throw;
 			}
 
 			skipWhitespaces(r);
-			return JSONValue(obj);
+			return (arena) ? (JSONValue(obj, *arena)) : (JSONValue(obj));
 		}
 
 		/** skip all kinds of whitespaces */
@@ -144,9 +180,9 @@ namespace K {
 		std::string getKey(Reader& r) const {
 			r.consume('"');
 			const char* start = r.str;
-			while(true) {
+			while (r.peek() != '"') {
+				if (r.isEmpty()) {throw JSONReaderException("unexpected end of input within key");}
 				++r.str;
-				if (r.peek() == '"') {break;}
 			}
 			std::string key(start, r.str - start);
 			r.consume('"');
@@ -155,7 +191,7 @@ namespace K {
 
 		/** parse a json-value */
 		JSONValue getValue(Reader& r) const {
-			switch (r.str[0]) {
+			switch (r.peek()) {
 				case 't': case 'f':
 					return getBoolean(r);
 				case 'n':
@@ -168,13 +204,13 @@ namespace K {
 					return parseObject(r);
 				case '[':
 					return parseArray(r);
-				default: throw JSONReaderException(std::string("expected one of boolean/int/double/string/object/array but got\n") + std::string(r.str));
+				default: throw JSONReaderException(std::string("expected one of boolean/int/double/string/object/array but got\n") + r.remaining());
 			}
 		}
 
 		/** parse and consume a null-value */
 		JSONValue getNull(Reader& r) const {
-			if (r.peek() != 'n') {throw JSONReaderException("expected 'null' but got\n" + std::string(r.str));}
+			if (r.peek() != 'n') {throw JSONReaderException("expected 'null' but got\n" + r.remaining());}
 			r.consume('n'); r.consume('u'); r.consume('l'); r.consume('l');
 			return JSONValue();
 		}
@@ -183,7 +219,7 @@ namespace K {
 		JSONValue getBoolean(Reader& r) const {
 			if (r.peek() == 't') {r.consume('t'); r.consume('r'); r.consume('u'); r.consume('e'); return JSONValue(true);}
 			if (r.peek() == 'f') {r.consume('f'); r.consume('a'); r.consume('l'); r.consume('s'); r.consume('e'); return JSONValue(false);}
-			throw JSONReaderException("expected one of true/false but got\n" + std::string(r.str));
+			throw JSONReaderException("expected one of true/false but got\n" + r.remaining());
 		}
 
 		/** parse and consume a number-value (int/double) */
@@ -213,7 +249,7 @@ namespace K {
 				else							{str += r.consume();}
 			}
 			r.consume('"');
-			return JSONValue(str);
+			return (arena) ? (JSONValue(str.data(), str.size(), *arena)) : (JSONValue(str));
 		}
 
 	};
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <cstdint>
 #include "JSONTypes.h"
+#include "../../memory/Arena.h"
 
 namespace K {
 
@@ -15,6 +16,10 @@ namespace K {
 	 * describes a (variant) JSON-value.
 	 * a value is one of:
 	 *		null,boolean,integer,double,string,json-object,json-array
+	 *
+	 * strings, objects and arrays are either owned via new/delete or
+	 * live within an Arena. for the latter, only the destructors are
+	 * called, the memory is reclaimed by the arena.
 	 */
 	class JSONValue {
 
@@ -23,6 +28,9 @@ namespace K {
 		/** the type of contained value (variant) */
 		JSONValueType type;
 
+		/** string/object/array allocated within an arena? */
+		bool inArena = false;
+
 		/** union to access the value (depends on above type) */
 		union {
 
@@ -57,6 +65,14 @@ namespace K {
 			s = new char[str.size()+1];
 			strcpy(s, str.c_str());
 		}
+		/** ctor: json-object allocated within an arena */
+		explicit JSONValue(JSONObject* obj, Arena&) : type(JSONValueType::JSON_OBJECT), inArena(true), obj(obj) {;}
+		/** ctor: json-array allocated within an arena */
+		explicit JSONValue(JSONArray* arr, Arena&) : type(JSONValueType::JSON_ARRAY), inArena(true), arr(arr) {;}
+		/** ctor: string-value copied into the given arena */
+		explicit JSONValue(const char* str, const size_t len, Arena& arena) : type(JSONValueType::STRING), inArena(true) {
+			s = arena.copyString(str, len);
+		}
 
 		/** dtor */
 		~JSONValue();
@@ -67,6 +83,7 @@ namespace K {
 		/** move ctor */
 		JSONValue(JSONValue&& o) {
 			this->type = o.type;
+			this->inArena = o.inArena;
 			this->d = o.d;
 			o.i = 0;
 		}
@@ -74,6 +91,7 @@ namespace K {
 		/** move assignment operator */
 		JSONValue& operator= (JSONValue&& o) {
 			this->type = o.type;
+			this->inArena = o.inArena;
 			this->d = o.d;
 			o.i = 0;
 			return *this;
@@ -110,7 +110,7 @@ namespace K {
 			if (num && prettyPrint) {out << "\n"; ++lvl;}
 			int i = 0;
 			for (auto& it : obj.keyVal) {
-				switchEl(it.first, it.second, lvl);
+				switchEl(std::string(it.first.data(), it.first.size()), it.second, lvl);
 				if (++i < num) {out << ",";}
 				if (prettyPrint) {out << "\n";}
 			}
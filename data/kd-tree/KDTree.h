@@ -9,6 +9,7 @@
 #include "KDTreeHelper.h"
 
 #include "../../Assertions.h"
+#include "../../memory/Arena.h"
 
 namespace K {
 
@@ -23,6 +24,16 @@ namespace K {
 	/**
 	 * a very basic KD-Tree to sort user-Elements of a given Dimension
 	 *
+	 * nodes and leafs are allocated using new/delete, or from an Arena when
+	 * provided. using an arena, building the tree does not involve malloc()
+	 * and tearing it down is O(1): the tree just forgets its nodes, their
+	 * memory is reclaimed when the user resets the arena. the arena must
+	 * outlive the tree.
+	 * leafs reserve room for maxPerLeaf entries up front. still, replaced
+	 * nodes/leafs and leafs growing beyond that (maxDepth reached) stay within
+	 * the arena until its next reset(). for trees that see many add()/remove()
+	 * calls, reset the arena and rebuild the tree from time to time.
+	 *
 	 * Example:
 	 *		Scalar:		float
 	 *		DataSource:	PointCloud
@@ -59,10 +70,19 @@ namespace K {
 		/** the user's data source */
 		const DataSource* source;
 
+		/** allocate nodes and leafs from this arena (if any) */
+		Arena* arena;
+
 	public:
 
-		/** ctor */
-		KDTree(const int maxDepth = 10, const int maxPerLeaf = 32) : root(nullptr), maxDepth(maxDepth), maxPerLeaf(maxPerLeaf), source(nullptr) {
+		/**
+		 * ctor
+		 * @param maxDepth the maximum depth to use when building the tree
+		 * @param maxPerLeaf the maximum number of elements per leaf
+		 * @param arena optional arena to allocate all nodes and leafs from
+		 */
+		KDTree(const int maxDepth = 10, const int maxPerLeaf = 32, Arena* arena = nullptr) :
+			root(nullptr), maxDepth(maxDepth), maxPerLeaf(maxPerLeaf), source(nullptr), arena(arena) {
 			;
 		}
 
@@ -93,7 +113,7 @@ namespace K {
 			cleanup();
 
 			// start with an empty root
-			root = new _KDTreeLeaf(nullptr);
+			root = createLeaf(nullptr);
 
 
 		}
@@ -112,7 +132,7 @@ namespace K {
 			cleanup();
 
 			// add all element-indicies to the first leaf
-			_KDTreeLeaf* leaf = new _KDTreeLeaf(nullptr);
+			_KDTreeLeaf* leaf = createLeaf(nullptr);
 			leaf->entries.resize(cnt);
 			for (KDIdx i = 0; i < cnt; ++i) {leaf->entries[i] = i;}
 
@@ -135,13 +155,14 @@ namespace K {
 			leaf->entries.add(idx);
 
 			// split the leaf (if needed)
-			const int axis = (!leaf->parent) ? (0) : (nextAxis(leaf->parent->asNode()->splitAxis));
+			_KDTreeNode* parent = leaf->getParent();
+			const int axis = (!parent) ? (0) : (nextAxis(parent->splitAxis));
 			_KDTreeElem* elem = (_KDTreeNode*) splitIfNeeded(leaf, axis, 0);
 
 			// changed? (leaf is deleted by now!)
 			if (elem != leaf) {
-				if (leaf == root)	{root = elem;}									// new root
-				if (leaf->parent)	{leaf->getParent()->switchChild(leaf, elem);}	// update association
+				if (leaf == root)	{root = elem;}							// new root
+				if (parent)			{parent->switchChild(leaf, elem);}		// update association
 			}
 
 			// perform balancing?
@@ -308,14 +329,19 @@ namespace K {
 			const Scalar center = splitter.getCenter(source, leaf->entries, axis, Config());
 
 			// new data-structure (new node + 2 leafs)
-			_KDTreeNode* newNode = new _KDTreeNode(center, axis, leaf->parent);
-			_KDTreeLeaf* newLeft = new _KDTreeLeaf(newNode);
-			_KDTreeLeaf* newRight = new _KDTreeLeaf(newNode);
+			_KDTreeNode* newNode = createNode(center, axis, leaf->parent);
+			_KDTreeLeaf* newLeft = createLeaf(newNode);
+			_KDTreeLeaf* newRight = createLeaf(newNode);
 			newNode->attach(newLeft, newRight);
 
 			// reserve space (slightly faster)
-			newLeft->entries.reserve( leaf->entries.size() * 6 / 10 );
-			newRight->entries.reserve( leaf->entries.size() * 6 / 10 );
+			if (arena) {
+				reserveArenaLeaf(newLeft, (KDIdx) (leaf->entries.size() * 6 / 10));
+				reserveArenaLeaf(newRight, (KDIdx) (leaf->entries.size() * 6 / 10));
+			} else {
+				newLeft->entries.reserve( leaf->entries.size() * 6 / 10 );
+				newRight->entries.reserve( leaf->entries.size() * 6 / 10 );
+			}
 
 			// split the old leaf into the 2 new ones
 			for (int i = 0; i < leaf->entries.size(); ++i) {
@@ -326,7 +352,7 @@ namespace K {
 
 			// the current axis does NOT provide any splitting? -> cleanup and skip this axis
 			if (newLeft->entries.size() == 0 || newRight->entries.size() == 0) {
-				delete newNode;
+				destroyTree(newNode);
 				return splitIfNeeded(leaf, nextAxis(axis), depth);
 			}
 
@@ -335,7 +361,7 @@ namespace K {
 			newNode->right =	splitIfNeeded(newRight, nextAxis(axis), depth + 1 );
 
 			// delete the old leaf
-			delete leaf;
+			destroy(leaf);
 
 			// done (replace leaf with the new node)
 			return newNode;
@@ -394,7 +420,49 @@ namespace K {
 
 		/** data cleanup */
 		void cleanup() {
-			if (root) {delete root; root = nullptr;}
+			if (root) {destroyTree(root); root = nullptr;}
+		}
+
+		/** create a new leaf (arena or heap) */
+		_KDTreeLeaf* createLeaf(_KDTreeElem* parent) {
+			if (arena) {
+				_KDTreeLeaf* leaf = arena->create<_KDTreeLeaf>(parent, arena->getResource());
+				reserveArenaLeaf(leaf, 0);
+				return leaf;
+			}
+			return new _KDTreeLeaf(parent);
+		}
+
+		/**
+		 * the arena does not free the old buffer when a leaf's vector grows.
+		 * reserve enough for the leaf to fill up until it is split again
+		 */
+		void reserveArenaLeaf(_KDTreeLeaf* leaf, const KDIdx size) {
+			leaf->entries.reserve( std::max(size, maxPerLeaf + 1) );
+		}
+
+		/** create a new node (arena or heap) */
+		_KDTreeNode* createNode(const Scalar splitValue, const int splitAxis, _KDTreeElem* parent) {
+			if (arena) {return arena->create<_KDTreeNode>(splitValue, splitAxis, parent);}
+			return new _KDTreeNode(splitValue, splitAxis, parent);
+		}
+
+		/** destroy one element (not its subtrees). arena memory is reclaimed by the arena itself */
+		void destroy(_KDTreeElem* elem) {
+			if (arena) {return;}
+			if (elem->isLeaf())	{delete (_KDTreeLeaf*) elem;}
+			else				{delete (_KDTreeNode*) elem;}
+		}
+
+		/** destroy the given element including all of its subtrees */
+		void destroyTree(_KDTreeElem* elem) {
+			if (!elem || arena) {return;}
+			if (elem->isNode()) {
+				_KDTreeNode* node = (_KDTreeNode*) elem;
+				destroyTree(node->left);
+				destroyTree(node->right);
+			}
+			destroy(elem);
 		}
 
 		/** rebuild the given node */
@@ -408,7 +476,7 @@ namespace K {
 			getElementsBelow(node, entries);
 
 			// 2) create a new leaf
-			_KDTreeLeaf* leaf = new _KDTreeLeaf(node->parent);
+			_KDTreeLeaf* leaf = createLeaf(node->parent);
 			leaf->entries.addAll(entries);
 
 			// 3) replkace the old branch with the new leaf
@@ -423,6 +491,9 @@ namespace K {
 				}
 			}
 
+			// 4) the old branch is no longer needed
+			destroyTree(node);
+
 		}
 
 
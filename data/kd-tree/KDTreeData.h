@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <memory_resource>
 
 namespace K {
 
@@ -68,11 +69,8 @@ namespace K {
 		KDTreeNode(const float splitValue, const int splitAxis, KDTreeElem<Scalar>* parent) :
 			KDTreeElem<Scalar>(false, parent), splitValue(splitValue), splitAxis(splitAxis), left(nullptr), right(nullptr) {;}
 
-		/** dtor */
-		~KDTreeNode() {
-			delete left; left = nullptr;
-			delete right; right = nullptr;
-		}
+		/** the subtrees are destroyed by the KDTree (which knows how they were allocated) */
+		~KDTreeNode() {;}
 
 		/** no-copy */
 		KDTreeNode(const KDTreeNode& o) = delete;
@@ -104,10 +102,13 @@ namespace K {
 	private:
 
 		/** internal data structure */
-		std::vector<KDIdx> indices;
+		std::pmr::vector<KDIdx> indices;
 
 	public:
 
+		/** ctor */
+		explicit KDTreeLeafEntries(std::pmr::memory_resource* res = std::pmr::get_default_resource()) : indices(res) {;}
+
 		/** number of entries within this leaf */
 		inline int size() const {return (int) indices.size();}
 
@@ -146,7 +147,8 @@ namespace K {
 		KDTreeLeafEntries entries;
 
 		/** ctor */
-		KDTreeLeaf(KDTreeElem<Scalar>* parent) : KDTreeElem<Scalar>(true, parent) {;}
+		KDTreeLeaf(KDTreeElem<Scalar>* parent, std::pmr::memory_resource* res = std::pmr::get_default_resource()) :
+			KDTreeElem<Scalar>(true, parent), entries(res) {;}
 
 		/** get this leaf's parent node (if any) */
 		inline KDTreeNode<Scalar>* getParent() {return (KDTreeNode<Scalar>*) KDTreeElem<Scalar>::parent;}
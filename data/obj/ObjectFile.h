@@ -6,6 +6,7 @@
 
 #include <sstream>
 #include "../Tokenizer.h"
+#include "../../streams/MappedFileInputStream.h"
 
 namespace K {
 
@@ -69,17 +70,26 @@ namespace K {
 
 		/** read .obj from the given file */
 		void readFile(const std::string& file) {
-			std::ifstream is(file);
-			std::string line;
-			while(getline(is, line)) {parseLine(line);}
-			is.close();
+			MappedFileInputStream is(file);
+			readData((const char*) is.getData(), is.getLength());
 		}
 
 		/** read obj from the given data string (.obj file contents) */
 		void readData(const std::string& data) {
-			std::stringstream is(data);
+			readData(data.data(), data.length());
+		}
+
+		/** read obj from the given memory region (.obj file contents) */
+		void readData(const char* str, const size_t len) {
+			const char* end = str + len;
 			std::string line;
-			while(getline(is, line)) {parseLine(line);}
+			while (str < end) {
+				const char* eol = (const char*) memchr(str, '\n', end - str);
+				if (!eol) {eol = end;}
+				line.assign(str, eol - str);
+				parseLine(line);
+				str = eol + 1;
+			}
 		}
 
 		/** get the parsed data */
@@ -2,7 +2,10 @@
 #define XYZFILE_H
 
 #include <string>
-#include <fstream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include "../../streams/MappedFileInputStream.h"
 
 namespace K {
 
@@ -33,10 +36,16 @@ namespace K {
 		/** ctor with the file to load */
 		XYZFileReader(const std::string& file, const bool swapXY = false) : swapXY(swapXY) {
 
-			std::ifstream is(file);
-			std::string line;
-			while(getline(is, line)) {parseLine(line);}
-			is.close();
+			// parse directly from the mapped file, line by line
+			MappedFileInputStream is(file);
+			const char* str = (const char*) is.getData();
+			const char* end = str + is.getLength();
+			while (str < end) {
+				const char* eol = (const char*) memchr(str, '\n', end - str);
+				if (!eol) {eol = end;}
+				parseLine(str, eol);
+				str = eol + 1;
+			}
 
 		}
 
@@ -45,19 +54,20 @@ namespace K {
 
 	private:
 
-		void parseLine(const std::string& line) {
+		/** parse the line [str:end[ */
+		void parseLine(const char* str, const char* end) {
 
 			// store temporal values. uninitialized!
 			double tmp[32];
 
 			// read all space/tab-separated float values
 			int cnt = 0;
-			size_t start = 0;
+			const char* start = str;
 
-			for (int i = 0; i < (int) line.length(); ++i) {
+			for (const char* pos = str; pos <= end && cnt < 32; ++pos) {
 
-				// next char
-				const char c = line[i];
+				// next char. the line's end is a separator as well
+				const char c = (pos < end) ? (*pos) : ('\n');
 
 				// what to do
 				switch (c) {
@@ -65,14 +75,15 @@ namespace K {
 					case '\t':
 					case '\n':
 					case '\r':
-						const size_t end = i;
-						const size_t len = end-start;
-						if (len > 0) {
-							const std::string number = line.substr(start, end-start);
-							tmp[cnt] = std::stod(number);
-							start = end+1;
+						const size_t len = pos-start;
+						if (len > 0 && len < 64) {
+							char number[64];
+							memcpy(number, start, len);
+							number[len] = '\0';
+							tmp[cnt] = std::strtod(number, nullptr);
 							++cnt;
 						}
+						start = pos+1;
 				}
 
 				if (c == '\r') {break;}
@@ -0,0 +1,273 @@
+#ifndef K_MEMORY_ARENA_H
+#define K_MEMORY_ARENA_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <memory_resource>
+
+#include "../Exception.h"
+
+namespace K {
+
+	class Arena;
+
+	/**
+	 * std::pmr compatible memory resource around an Arena.
+	 * deallocation is a no-op, memory is reclaimed by Arena::reset()
+	 */
+	class ArenaResource : public std::pmr::memory_resource {
+
+	private:
+
+		Arena& arena;
+
+	public:
+
+		/** ctor */
+		explicit ArenaResource(Arena& arena) : arena(arena) {;}
+
+		/** get the underlying arena */
+		Arena& getArena() const {return arena;}
+
+	protected:
+
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+			(void) p; (void) bytes; (void) alignment;
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override {
+			return this == &o;
+		}
+
+	};
+
+	/**
+	 * monotonic bump-pointer allocator.
+	 *
+	 * allocations simply advance a pointer within the current memory block.
+	 * single allocations can not be freed. instead, reset() rewinds the arena
+	 * in O(1), keeping all blocks for reuse. release() returns them to the OS.
+	 *
+	 * objects from create() are never destructed by the arena. thus, only use
+	 * it for trivially destructible types or for types whose memory is owned by
+	 * the arena as well (e.g. std::pmr containers using getResource()).
+	 * for all other types, use createOwned(): the arena calls their destructor
+	 * on reset() / destruction (in reverse order of construction).
+	 *
+	 * NOT thread-safe
+	 */
+	class Arena {
+
+	private:
+
+		/** one block of memory */
+		struct Block {
+			uint8_t* data;
+			size_t size;
+		};
+
+		/** destructor to call on reset(), stored within the arena itself */
+		struct Finalizer {
+			void (*fn) (void*);
+			void* obj;
+			Finalizer* next;
+		};
+
+		/** blocks never grow beyond this size (unless a single allocation needs more) */
+		static constexpr size_t MAX_BLOCK_SIZE = 16*1024*1024;
+
+	public:
+
+		/**
+		 * ctor
+		 * @param blockSize the size of the first memory block. subsequent blocks double in size
+		 */
+		explicit Arena(const size_t blockSize = 64*1024) : blockSize(blockSize), resource(*this) {
+			if (blockSize == 0) {throw Exception("Arena: blockSize must be > 0");}
+		}
+
+		/** dtor */
+		~Arena() {
+			release();
+		}
+
+		/** no copy */
+		Arena(const Arena&) = delete;
+		Arena& operator = (const Arena&) = delete;
+
+
+		/** allocate the given number of bytes with the given alignment (power of two) */
+		void* alloc(const size_t bytes, const size_t align = alignof(std::max_align_t)) {
+
+			// fits into the current block?
+			if (cur < blocks.size()) {
+				uint8_t* p = alignUp(blocks[cur].data + pos, align);
+				if (p + bytes <= blocks[cur].data + blocks[cur].size) {
+					pos = (p + bytes) - blocks[cur].data;
+					used += bytes;
+					return p;
+				}
+			}
+
+			return allocSlow(bytes, align);
+
+		}
+
+		/** allocate uninitialized memory for num elements of type T */
+		template <typename T> T* allocArray(const size_t num) {
+			return (T*) alloc(num * sizeof(T), alignof(T));
+		}
+
+		/**
+		 * construct a new T within the arena.
+		 * its destructor is never called by the arena!
+		 */
+		template <typename T, typename... Args> T* create(Args&&... args) {
+			void* mem = alloc(sizeof(T), alignof(T));
+			return new (mem) T(std::forward<Args>(args)...);
+		}
+
+		/**
+		 * construct a new T within the arena.
+		 * its destructor is called on reset() or when the arena is destroyed
+		 */
+		template <typename T, typename... Args> T* createOwned(Args&&... args) {
+			T* obj = create<T>(std::forward<Args>(args)...);
+			if (!std::is_trivially_destructible<T>::value) {
+				Finalizer* f = create<Finalizer>();
+				f->fn = [] (void* o) {((T*) o)->~T();};
+				f->obj = obj;
+				f->next = finalizers;
+				finalizers = f;
+			}
+			return obj;
+		}
+
+		/** copy the given string into the arena (null-terminated) */
+		char* copyString(const char* str, const size_t len) {
+			char* dst = (char*) alloc(len + 1, 1);
+			memcpy(dst, str, len);
+			dst[len] = '\0';
+			return dst;
+		}
+
+		/**
+		 * rewind the arena. all previous allocations become invalid.
+		 * O(1) apart from calling the destructors of createOwned() objects.
+		 * the memory is kept for subsequent allocations.
+		 */
+		void reset() {
+			runFinalizers();
+			cur = 0;
+			pos = 0;
+			used = 0;
+		}
+
+		/** like reset() but also returns all memory to the OS */
+		void release() {
+			reset();
+			for (Block& b : blocks) {::free(b.data);}
+			blocks.clear();
+		}
+
+		/** get the number of bytes handed out since the last reset */
+		size_t getNumBytesUsed() const {
+			return used;
+		}
+
+		/** get the number of bytes currently held by the arena */
+		size_t getNumBytesReserved() const {
+			size_t sum = 0;
+			for (const Block& b : blocks) {sum += b.size;}
+			return sum;
+		}
+
+		/** get a std::pmr memory resource allocating from this arena */
+		std::pmr::memory_resource* getResource() {
+			return &resource;
+		}
+
+	private:
+
+		static inline uint8_t* alignUp(uint8_t* p, const size_t align) {
+			return (uint8_t*) (((uintptr_t) p + (align - 1)) & ~((uintptr_t) align - 1));
+		}
+
+		/** continue with the next (large enough) block, allocate a new one if needed */
+		void* allocSlow(const size_t bytes, const size_t align) {
+
+			// blocks kept from before the last reset()
+			for (++cur; cur < blocks.size(); ++cur) {
+				uint8_t* p = alignUp(blocks[cur].data, align);
+				if (p + bytes <= blocks[cur].data + blocks[cur].size) {
+					pos = (p + bytes) - blocks[cur].data;
+					used += bytes;
+					return p;
+				}
+			}
+
+			// new block. doubles in size up to MAX_BLOCK_SIZE
+			size_t size = (blocks.empty()) ? (blockSize) : (blocks.back().size * 2);
+			if (size > MAX_BLOCK_SIZE) {size = (blockSize > MAX_BLOCK_SIZE) ? (blockSize) : (MAX_BLOCK_SIZE);}
+			if (size < bytes + align) {size = bytes + align;}
+
+			Block b;
+			b.data = (uint8_t*) ::malloc(size);
+			if (!b.data) {throw Exception("Arena: out of memory");}
+			b.size = size;
+			blocks.push_back(b);
+			cur = blocks.size() - 1;
+
+			uint8_t* p = alignUp(b.data, align);
+			pos = (p + bytes) - b.data;
+			used += bytes;
+			return p;
+
+		}
+
+		void runFinalizers() {
+			while (finalizers) {
+				Finalizer* f = finalizers;
+				finalizers = f->next;
+				f->fn(f->obj);
+			}
+		}
+
+		/** the size of the first block */
+		const size_t blockSize;
+
+		/** all allocated blocks */
+		std::vector<Block> blocks;
+
+		/** index of the current block */
+		size_t cur = 0;
+
+		/** the next free byte within the current block */
+		size_t pos = 0;
+
+		/** number of bytes handed out */
+		size_t used = 0;
+
+		/** objects to destruct on reset (newest first) */
+		Finalizer* finalizers = nullptr;
+
+		/** pmr adapter */
+		ArenaResource resource;
+
+	};
+
+	inline void* ArenaResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+		return arena.alloc(bytes, alignment);
+	}
+
+}
+
+#endif // K_MEMORY_ARENA_H
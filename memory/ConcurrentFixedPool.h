@@ -0,0 +1,468 @@
+#ifndef K_MEMORY_CONCURRENTFIXEDPOOL_H
+#define K_MEMORY_CONCURRENTFIXEDPOOL_H
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+#include "../Exception.h"
+
+namespace K {
+
+	/**
+	 * thread-safe variant of FixedPool:
+	 * fast allocation for many small, fixed-size elements shared between threads.
+	 *
+	 * every thread owns a cache of two magazines (small stacks of free entries).
+	 * alloc() and free() only touch the calling thread's cache. full and empty
+	 * magazines are exchanged with a lock-free global depot. only growing the
+	 * pool (allocating a new chunk / magazine) requires a lock.
+	 *
+	 * elements may be freed by another thread than the one allocating them.
+	 *
+	 * alloc() returns uninitialized memory for one element,
+	 * use placement-new for non-trivial types.
+	 */
+	template <typename T> class ConcurrentFixedPool {
+
+	public:
+
+		/** usage statistics, e.g. for monitoring */
+		struct Stats {
+
+			/** the number of currently allocated elements */
+			int64_t numLive = 0;
+
+			/** the number of chunks currently held by the pool */
+			size_t numChunks = 0;
+
+			/** the number of bytes currently held by all chunks */
+			size_t numBytes = 0;
+
+			/** the number of alloc() / free() calls */
+			uint64_t numAllocs = 0;
+			uint64_t numFrees = 0;
+
+			/** the number of alloc() calls served by the thread's own cache */
+			uint64_t numCacheHits = 0;
+
+			/** the fraction of alloc() calls served by the thread's own cache */
+			double getHitRate() const {
+				return (numAllocs) ? ((double) numCacheHits / (double) numAllocs) : (0);
+			}
+
+		};
+
+	private:
+
+		/** one entry. either free (then: next pointer) or in use (the element) */
+		union Slot {
+			Slot* next;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type element;
+		};
+
+		/** one chunk of memory */
+		struct Chunk {
+			Slot* slots;
+			size_t numEntries;
+		};
+
+		/** a stack of free entries */
+		struct Magazine {
+
+			/** 1-based index of the next magazine within the depot (0 = none) */
+			std::atomic<uint32_t> next;
+
+			/** 1-based index of this magazine */
+			uint32_t idx;
+
+			/** the number of used slots */
+			uint32_t count;
+
+			/** free entries */
+			std::vector<Slot*> slots;
+
+		};
+
+		/** per-thread cache */
+		struct Cache {
+
+			Cache(const uint64_t poolID) : poolID(poolID) {;}
+
+			/** the pool this cache belongs to */
+			const uint64_t poolID;
+
+			/** the currently used magazine and the previous one */
+			Magazine* loaded = nullptr;
+			Magazine* previous = nullptr;
+
+			/** the owning thread has terminated. the cache may be adopted by the pool */
+			std::atomic<bool> orphaned {false};
+
+			/** the pool has been destroyed. the cache is unusable */
+			std::atomic<bool> poolDead {false};
+
+			/** counters. written by the owning thread only */
+			std::atomic<uint64_t> numAllocs {0};
+			std::atomic<uint64_t> numFrees {0};
+			std::atomic<uint64_t> numHits {0};
+
+		};
+
+		/** all caches of one thread (one per pool) */
+		struct ThreadCaches {
+
+			std::vector<std::shared_ptr<Cache>> caches;
+
+			/** the last used cache */
+			uint64_t lastID = 0;
+			Cache* last = nullptr;
+
+			~ThreadCaches() {
+				for (std::shared_ptr<Cache>& c : caches) {c->orphaned.store(true, std::memory_order_release);}
+			}
+
+		};
+
+		/** the magazine table grows in segments of this many magazines */
+		static constexpr uint32_t SEGMENT_SIZE = 256;
+
+		/** the maximum number of segments */
+		static constexpr uint32_t MAX_SEGMENTS = 4096;
+
+	public:
+
+		/**
+		 * ctor
+		 * @param entriesPerChunk the number of entries to allocate at once when growing
+		 * @param magazineSize the number of entries within each thread-local magazine
+		 */
+		ConcurrentFixedPool(const size_t entriesPerChunk = 4096, const uint32_t magazineSize = 64) :
+			entriesPerChunk(entriesPerChunk), magazineSize(magazineSize), poolID(nextPoolID()),
+			segments(new std::atomic<Magazine*>[MAX_SEGMENTS]) {
+
+			if (entriesPerChunk == 0)	{throw Exception("ConcurrentFixedPool: entriesPerChunk must be > 0");}
+			if (magazineSize == 0)		{throw Exception("ConcurrentFixedPool: magazineSize must be > 0");}
+			for (uint32_t i = 0; i < MAX_SEGMENTS; ++i) {segments[i].store(nullptr, std::memory_order_relaxed);}
+
+		}
+
+		/** dtor. all elements must have been freed (or are lost) */
+		~ConcurrentFixedPool() {
+			std::lock_guard<std::mutex> lock(mutex);
+			for (std::shared_ptr<Cache>& c : caches) {c->poolDead.store(true, std::memory_order_release);}
+			for (Chunk& c : chunks) {delete[] c.slots;}
+			for (uint32_t i = 0; i < MAX_SEGMENTS; ++i) {delete[] segments[i].load(std::memory_order_relaxed);}
+		}
+
+		/** no copy */
+		ConcurrentFixedPool(const ConcurrentFixedPool&) = delete;
+		ConcurrentFixedPool& operator = (const ConcurrentFixedPool&) = delete;
+
+
+		/** allocate a new element */
+		T* alloc() {
+
+			Cache* c = getCache();
+			inc(c->numAllocs);
+
+			// served by the thread's own magazines?
+			if (!c->loaded->count && c->previous->count) {std::swap(c->loaded, c->previous);}
+			if (c->loaded->count) {
+				inc(c->numHits);
+				return pop(c->loaded);
+			}
+
+			// exchange the empty previous magazine for a full one from the depot
+			Magazine* full = popDepot(depotFull);
+			if (full) {
+				pushDepot(depotEmpty, c->previous);
+				c->previous = c->loaded;
+				c->loaded = full;
+				return pop(c->loaded);
+			}
+
+			// the pool must grow
+			refill(c->loaded);
+			return pop(c->loaded);
+
+		}
+
+		/** free the given element */
+		void free(T* elem) {
+
+			Cache* c = getCache();
+			inc(c->numFrees);
+			Slot* s = reinterpret_cast<Slot*>(elem);
+
+			if (c->loaded->count == magazineSize && c->previous->count == 0) {std::swap(c->loaded, c->previous);}
+
+			// both magazines full -> hand the previous one to the depot
+			if (c->loaded->count == magazineSize) {
+				Magazine* empty = popDepot(depotEmpty);
+				if (!empty) {empty = newMagazine();}
+				pushDepot(depotFull, c->previous);
+				c->previous = c->loaded;
+				c->loaded = empty;
+			}
+
+			c->loaded->slots[c->loaded->count++] = s;
+
+		}
+
+		/**
+		 * return all chunks without any allocated element to the OS.
+		 * only considers free entries within the depot, the calling thread's cache
+		 * and the caches of terminated threads. entries cached by other (running)
+		 * threads keep their chunk alive.
+		 * returns the number of released chunks.
+		 */
+		size_t trim() {
+
+			Cache* own = getCache();
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// collect all free entries we are allowed to touch
+			std::vector<Slot*> free;
+			auto collect = [&] (Magazine* m) {
+				free.insert(free.end(), m->slots.begin(), m->slots.begin() + m->count);
+				m->count = 0;
+			};
+			collect(own->loaded);
+			collect(own->previous);
+			for (size_t i = 0; i < caches.size(); ) {
+				Cache* c = caches[i].get();
+				if (c->orphaned.load(std::memory_order_acquire)) {
+					collect(c->loaded);
+					collect(c->previous);
+					pushDepot(depotEmpty, c->loaded);
+					pushDepot(depotEmpty, c->previous);
+					retired.numAllocs += c->numAllocs.load(std::memory_order_relaxed);
+					retired.numFrees += c->numFrees.load(std::memory_order_relaxed);
+					retired.numCacheHits += c->numHits.load(std::memory_order_relaxed);
+					caches.erase(caches.begin() + i);
+				} else {
+					++i;
+				}
+			}
+			while (Magazine* m = popDepot(depotFull)) {
+				collect(m);
+				pushDepot(depotEmpty, m);
+			}
+
+			// count the free entries per chunk (chunks are sorted by address)
+			std::vector<size_t> numFree(chunks.size(), 0);
+			for (Slot* s : free) {++numFree[getChunkIndex(s)];}
+			if (bumpLeft) {numFree[getChunkIndex(bump)] += bumpLeft;}
+
+			// release all completely free chunks
+			std::vector<bool> released(chunks.size(), false);
+			size_t numReleased = 0;
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				if (numFree[i] != chunks[i].numEntries) {continue;}
+				if (bumpLeft && getChunkIndex(bump) == i) {bump = nullptr; bumpLeft = 0;}
+				released[i] = true;
+				++numReleased;
+			}
+			std::vector<Slot*> keep;
+			for (Slot* s : free) {
+				if (!released[getChunkIndex(s)]) {keep.push_back(s);}
+			}
+			std::vector<Chunk> remaining;
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				if (released[i]) {delete[] chunks[i].slots;} else {remaining.push_back(chunks[i]);}
+			}
+			chunks.swap(remaining);
+
+			// the remaining free entries go back to the depot
+			for (size_t i = 0; i < keep.size(); ) {
+				Magazine* m = popDepot(depotEmpty);
+				if (!m) {m = newMagazineLocked();}
+				while (m->count < magazineSize && i < keep.size()) {m->slots[m->count++] = keep[i++];}
+				pushDepot(depotFull, m);
+			}
+
+			return numReleased;
+
+		}
+
+		/** get the current usage statistics */
+		Stats getStats() const {
+			std::lock_guard<std::mutex> lock(mutex);
+			Stats s = retired;
+			for (const std::shared_ptr<Cache>& c : caches) {
+				s.numAllocs += c->numAllocs.load(std::memory_order_relaxed);
+				s.numFrees += c->numFrees.load(std::memory_order_relaxed);
+				s.numCacheHits += c->numHits.load(std::memory_order_relaxed);
+			}
+			s.numLive = (int64_t) (s.numAllocs - s.numFrees);
+			s.numChunks = chunks.size();
+			for (const Chunk& c : chunks) {s.numBytes += c.numEntries * sizeof(Slot);}
+			return s;
+		}
+
+	private:
+
+		/** unique ID for each pool instance, never reused */
+		static uint64_t nextPoolID() {
+			static std::atomic<uint64_t> id(0);
+			return ++id;
+		}
+
+		/** counters are only written by the owning thread: no atomic RMW needed */
+		static inline void inc(std::atomic<uint64_t>& cnt) {
+			cnt.store(cnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		static inline T* pop(Magazine* m) {
+			return reinterpret_cast<T*>(m->slots[--m->count]);
+		}
+
+		/** get (or create) the calling thread's cache for this pool */
+		Cache* getCache() {
+
+			static thread_local ThreadCaches tls;
+			if (tls.lastID == poolID) {return tls.last;}
+
+			// drop caches of destroyed pools
+			tls.caches.erase(std::remove_if(tls.caches.begin(), tls.caches.end(), [] (const std::shared_ptr<Cache>& c) {
+				return c->poolDead.load(std::memory_order_acquire);
+			}), tls.caches.end());
+
+			Cache* found = nullptr;
+			for (std::shared_ptr<Cache>& c : tls.caches) {
+				if (c->poolID == poolID) {found = c.get(); break;}
+			}
+
+			if (!found) {
+				std::shared_ptr<Cache> c = std::make_shared<Cache>(poolID);
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					c->loaded = newMagazineLocked();
+					c->previous = newMagazineLocked();
+					caches.push_back(c);
+				}
+				tls.caches.push_back(c);
+				found = c.get();
+			}
+
+			tls.lastID = poolID;
+			tls.last = found;
+			return found;
+
+		}
+
+		/** get the magazine for the given (1-based) index */
+		Magazine* getMagazine(const uint32_t idx) const {
+			return segments[(idx - 1) / SEGMENT_SIZE].load(std::memory_order_acquire) + ((idx - 1) % SEGMENT_SIZE);
+		}
+
+		/** lock-free push onto one of the depot's stacks. the tag prevents ABA */
+		void pushDepot(std::atomic<uint64_t>& head, Magazine* m) {
+			uint64_t h = head.load(std::memory_order_relaxed);
+			do {
+				m->next.store((uint32_t) h, std::memory_order_relaxed);
+			} while (!head.compare_exchange_weak(h, (((h >> 32) + 1) << 32) | m->idx, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/** lock-free pop from one of the depot's stacks. nullptr if empty */
+		Magazine* popDepot(std::atomic<uint64_t>& head) {
+			uint64_t h = head.load(std::memory_order_acquire);
+			while (true) {
+				const uint32_t idx = (uint32_t) h;
+				if (!idx) {return nullptr;}
+				Magazine* m = getMagazine(idx);
+				const uint32_t next = m->next.load(std::memory_order_relaxed);
+				if (head.compare_exchange_weak(h, (((h >> 32) + 1) << 32) | next, std::memory_order_acquire, std::memory_order_acquire)) {return m;}
+			}
+		}
+
+		Magazine* newMagazine() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return newMagazineLocked();
+		}
+
+		/** create a new (empty) magazine. mutex must be held */
+		Magazine* newMagazineLocked() {
+			const uint32_t i = numMagazines;
+			if (i / SEGMENT_SIZE >= MAX_SEGMENTS) {throw Exception("ConcurrentFixedPool: too many magazines");}
+			Magazine* seg = segments[i / SEGMENT_SIZE].load(std::memory_order_relaxed);
+			if (!seg) {
+				seg = new Magazine[SEGMENT_SIZE];
+				segments[i / SEGMENT_SIZE].store(seg, std::memory_order_release);
+			}
+			Magazine* m = seg + (i % SEGMENT_SIZE);
+			m->next.store(0, std::memory_order_relaxed);
+			m->idx = i + 1;
+			m->count = 0;
+			m->slots.resize(magazineSize);
+			++numMagazines;
+			return m;
+		}
+
+		/** fill the given (empty) magazine with never-used entries, allocate a new chunk if needed */
+		void refill(Magazine* m) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!bumpLeft) {
+				Chunk c;
+				c.numEntries = entriesPerChunk;
+				c.slots = new Slot[entriesPerChunk];
+				chunks.insert(std::upper_bound(chunks.begin(), chunks.end(), c, [] (const Chunk& a, const Chunk& b) {return a.slots < b.slots;}), c);
+				bump = c.slots;
+				bumpLeft = entriesPerChunk;
+			}
+			while (m->count < magazineSize && bumpLeft) {
+				m->slots[m->count++] = bump++;
+				--bumpLeft;
+			}
+		}
+
+		/** index of the chunk containing the given slot. mutex must be held */
+		size_t getChunkIndex(const Slot* s) const {
+			const size_t i = std::upper_bound(chunks.begin(), chunks.end(), s, [] (const Slot* p, const Chunk& c) {return p < c.slots;}) - chunks.begin();
+			return i - 1;
+		}
+
+
+		/** the number of entries to allocate at once */
+		const size_t entriesPerChunk;
+
+		/** the number of entries per magazine */
+		const uint32_t magazineSize;
+
+		/** this pool's unique ID */
+		const uint64_t poolID;
+
+		/** protects chunks, caches and the creation of magazines */
+		mutable std::mutex mutex;
+
+		/** all chunks, sorted by address */
+		std::vector<Chunk> chunks;
+
+		/** never used entries of the newest chunk */
+		Slot* bump = nullptr;
+		size_t bumpLeft = 0;
+
+		/** the magazine table */
+		std::unique_ptr<std::atomic<Magazine*>[]> segments;
+		uint32_t numMagazines = 0;
+
+		/** the depot: tagged (tag << 32 | index) heads of the full / empty stacks */
+		std::atomic<uint64_t> depotFull {0};
+		std::atomic<uint64_t> depotEmpty {0};
+
+		/** all thread caches */
+		std::vector<std::shared_ptr<Cache>> caches;
+
+		/** counters of caches from terminated threads */
+		Stats retired;
+
+	};
+
+}
+
+#endif // K_MEMORY_CONCURRENTFIXEDPOOL_H
@@ -7,6 +7,8 @@ namespace K {
 
 	/**
 	 * fast allocation for many small, fixed-size elements
+	 *
+	 * NOT thread-safe. see ConcurrentFixedPool when sharing a pool between threads
 	 */
 	template <typename T> class FixedPool {
 
@@ -23,6 +23,9 @@ namespace K {
 	 *
 	 * thus, this is somehow a tradeoff between raw memory operations and linked lists
 	 *
+	 * for FIFO usage (steady producer/consumer) use RingBuffer instead,
+	 * which never moves its content to reclaim free space.
+	 *
 	 */
 	template <typename T> class Buffer {
 
@@ -115,7 +118,9 @@ namespace K {
 			usedEntries -= numEntries;
 			freeAtFront += numEntries;
 			firstUsed += numEntries;
-			if (freeAtFront > FREE_LIMIT) {removeFreeAtFront();}
+
+			// only reclaim when the free space exceeds the data to move (amortized O(1))
+			if (freeAtFront > FREE_LIMIT && freeAtFront >= usedEntries) {removeFreeAtFront();}
 		}
 
 		/**
@@ -242,6 +247,9 @@ namespace K {
 			// already enough space?
 			if ((totalEntries - usedEntries - freeAtFront) > numElems) {return;}
 
+			// enough space when reclaiming the free space at the front?
+			if ((totalEntries - usedEntries) > numElems && freeAtFront >= usedEntries) {removeFreeAtFront(); return;}
+
 			// try doubling the buffer's size
 			size_t newSize = (unsigned int) totalEntries * 2;
 			if (newSize - usedEntries - freeAtFront < numElems) {newSize = usedEntries + numElems + freeAtFront;}
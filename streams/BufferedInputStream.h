@@ -12,7 +12,7 @@
 #include <cstdint>
 #include <cstring>
 #include "InputStreamPeek.h"
-#include "Buffer.h"
+#include "RingBuffer.h"
 #include "StreamException.h"
 
 namespace K {
@@ -26,7 +26,7 @@ public:
 
 	/** ctor */
 	BufferedInputStream(InputStream* is, const unsigned int blockSize = 4096) :
-		is(is), blockSize(blockSize), eof(false) {
+		is(is), blockSize(blockSize), borrowed(0), eof(false) {
 		;
 	}
 
@@ -37,6 +37,9 @@ public:
 
 	int read() override {
 
+		// release bytes handed out by a previous borrow()
+		release();
+
 		// try to fill the buffer (at least 1 byte)
 		fillBuffer(1);
 
@@ -58,6 +61,9 @@ public:
 
 	int peek() override {
 
+		// release bytes handed out by a previous borrow()
+		release();
+
 		// try to fill the buffer (at least 1 byte)
 		fillBuffer(1);
 
@@ -80,6 +86,17 @@ public:
 	/** read the given number of bytes into the buffer */
 	ssize_t read(uint8_t* data, const size_t len) override {
 
+		// release bytes handed out by a previous borrow()
+		release();
+
+		// large reads on an empty buffer bypass the buffer (no double copy)
+		if (buffer.empty() && len >= blockSize && !eof) {
+			const ssize_t fetched = is->read(data, len);
+			if (fetched == ERR_FAILED)		{eof = true; return ERR_FAILED;}
+			if (fetched == ERR_TRY_AGAIN)	{return 0;}
+			return fetched;
+		}
+
 		// try to fill the buffer (at least len bytes)
 		fillBuffer(len);
 
@@ -94,10 +111,35 @@ public:
 		}
 
 		// everything fine
-		const size_t toRead = (len < buffer.getNumUsed()) ? (len) : (buffer.getNumUsed());
-		memcpy(data, &buffer[0], toRead);
-		buffer.remove(toRead);
-		return toRead;
+		return buffer.get(data, len);
+
+	}
+
+	/** borrow the given number of bytes directly from the internal buffer */
+	ssize_t borrow(const uint8_t*& data, const size_t len) override {
+
+		// release bytes handed out by a previous borrow()
+		release();
+
+		// try to fill the buffer (at least 1 byte)
+		fillBuffer(1);
+
+		// buffer empty even if we tried to fill it?
+		if (buffer.empty()) {
+
+			// detected EOF? -> we failed
+			if (eof) {return ERR_FAILED;}
+
+			return 0;
+
+		}
+
+		// the borrowed bytes are removed from the buffer on the next call.
+		// removing them now could allow overwriting them while refilling
+		const RingBuffer<uint8_t>::Span span = buffer.getReadSpan();
+		borrowed = (len < span.len) ? (len) : (span.len);
+		data = span.data;
+		return borrowed;
 
 	}
 
@@ -106,12 +148,24 @@ public:
 	}
 
 	void skip(const uint64_t n) override {
-		(void) n;
-		throw StreamException("BufferedInputStream.skip() not yet implemented");
+
+		// release bytes handed out by a previous borrow()
+		release();
+
+		// skip buffered bytes first, the remainder within the underlying stream
+		const size_t fromBuffer = (n < buffer.getNumUsed()) ? (n) : (buffer.getNumUsed());
+		buffer.remove(fromBuffer);
+		if (n > fromBuffer) {is->skip(n - fromBuffer);}
+
 	}
 
 private:
 
+	/** remove the bytes handed out by the last borrow() from the buffer */
+	inline void release() {
+		if (borrowed) {buffer.remove(borrowed); borrowed = 0;}
+	}
+
 	/** ensure the buffer contains the given number of bytes */
 	void fillBuffer(const size_t needed) {
 
@@ -122,15 +176,25 @@ private:
 		const size_t toFetch = (needed < blockSize) ? (blockSize) : (needed);
 
 		// make space for those bytes
-		buffer.resize(buffer.getNumUsed() + toFetch);
+		buffer.ensureMinSize(buffer.getNumUsed() + toFetch);
 
-		// try to fetch from underlying layer
-		const ssize_t fetched = is->read(buffer.getFirstFree(), toFetch);
-		if (fetched == ERR_FAILED)		{eof = true; return;}
-		if (fetched == ERR_TRY_AGAIN)	{return;}
+		// try to fetch from underlying layer, directly into the free region.
+		// the free region might wrap around -> continue with its 2nd part if needed
+		size_t remaining = toFetch;
+		while (remaining) {
 
-		// everything fine
-		buffer.setNumUsed(buffer.getNumUsed() + fetched);
+			const RingBuffer<uint8_t>::Span span = buffer.getWriteSpan();
+			const size_t toRead = (remaining < span.len) ? (remaining) : (span.len);
+			const ssize_t fetched = is->read(span.data, toRead);
+			if (fetched == ERR_FAILED)		{eof = true; return;}
+			if (fetched == ERR_TRY_AGAIN)	{return;}
+			buffer.commit(fetched);
+			remaining -= fetched;
+
+			// stop as soon as the underlying layer has nothing more right now
+			if ((size_t) fetched < toRead || buffer.getNumUsed() >= needed) {break;}
+
+		}
 
 	}
 
@@ -138,11 +202,14 @@ private:
 	InputStream* is;
 
 	/** the internal buffer */
-	Buffer<uint8_t> buffer;
+	RingBuffer<uint8_t> buffer;
 
 	/** the number of bytes to read every time */
 	const unsigned int blockSize;
 
+	/** the number of bytes handed out by the last borrow() */
+	size_t borrowed;
+
 	/** eof from underlying layer? */
 	bool eof;
 
@@ -9,6 +9,7 @@
 #define BUFFEREDOUTPUTSTREAM_H_
 
 #include "OutputStream.h"
+#include "Buffer.h"
 
 namespace K {
 
@@ -7,7 +7,7 @@
 
 #include "InputStream.h"
 #include "OutputStream.h"
-#include "Buffer.h"
+#include "RingBuffer.h"
 #include "StreamException.h"
 
 namespace K {
@@ -41,10 +41,7 @@ public:
 
 	ssize_t read(uint8_t* data, const size_t len) override {
 		if (buffer.empty()) {return -1;}
-		const ssize_t toRead = (buffer.getNumUsed() >= len) ? (len) : (buffer.getNumUsed());
-		memcpy(data, buffer.getData(), toRead);
-		buffer.remove(toRead);
-		return toRead;
+		return buffer.get(data, len);
 	}
 
 
@@ -74,7 +71,7 @@ public:
 private:
 
 	/** the internal buffer */
-	Buffer<uint8_t> buffer;
+	RingBuffer<uint8_t> buffer;
 
 };
 
@@ -43,6 +43,15 @@ public:
 		return toRead;
 	}
 
+	ssize_t borrow(const uint8_t*& data, const size_t len) override {
+		if (this->len == 0) {return -1;}
+		const size_t toBorrow = (this->len >= len) ? (len) : (this->len);
+		data = this->data;
+		this->data += toBorrow;
+		this->len -= toBorrow;
+		return toBorrow;
+	}
+
 	void close() override {
 		;
 	}
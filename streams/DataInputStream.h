@@ -36,6 +36,10 @@ public:
 		return is.read(data, len);
 	}
 
+	ssize_t borrow(const uint8_t*& data, const size_t len) override {
+		return is.borrow(data, len);
+	}
+
 	uint8_t readByte() {
 		int i = read();
 		if (i == -1) {throw StreamException("reading error");}
@@ -72,6 +76,17 @@ public:
 		return Endian::fromLittleEndian(ret);
 	}
 
+	/**
+	 * read num values (e.g. int16_t, float, double) stored in the given byte order.
+	 * one bulk read followed by one (vectorized) in-place conversion,
+	 * which is skipped when the order matches the host's one
+	 */
+	template <typename T> void readArray(T* dst, const size_t num, const ByteOrder order = ByteOrder::LITTLE) {
+		const size_t bytes = num * sizeof(T);
+		if (readFully((uint8_t*) dst, bytes) != (ssize_t) bytes) {throw StreamException("reading error");}
+		Endian::toHost(dst, num, order);
+	}
+
 	void close() override {
 		is.close();
 	}
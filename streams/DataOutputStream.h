@@ -83,6 +83,28 @@ public:
 		write((uint8_t*)&data, 8);
 	}
 
+	/**
+	 * write num values (e.g. int16_t, float, double) using the given byte order.
+	 * written as-is when the order matches the host's one, otherwise
+	 * converted (vectorized) in chunks via a small stack buffer
+	 */
+	template <typename T> void writeArray(const T* src, const size_t num, const ByteOrder order = ByteOrder::LITTLE) {
+
+		if (order == Endian::getHostOrder() || sizeof(T) == 1) {
+			write((const uint8_t*) src, num * sizeof(T));
+			return;
+		}
+
+		T buf[4096 / sizeof(T)];
+		const size_t chunk = sizeof(buf) / sizeof(T);
+		for (size_t i = 0; i < num; i += chunk) {
+			const size_t cnt = (num - i < chunk) ? (num - i) : (chunk);
+			Endian::fromHost(src + i, buf, cnt, order);
+			write((const uint8_t*) buf, cnt * sizeof(T));
+		}
+
+	}
+
 
 private:
 
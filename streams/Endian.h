@@ -8,6 +8,15 @@
 #ifndef ENDIAN_H_
 #define ENDIAN_H_
 
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define K_ENDIAN_X86_SIMD
+#endif
+
 namespace K {
 
 #define K_SWAP_16(x)	__builtin_bswap16(x)
@@ -21,6 +30,12 @@ namespace K {
 
 #endif
 
+/** byte order of multi-byte values within a stream / file */
+enum class ByteOrder {
+	LITTLE,
+	BIG,
+};
+
 /**
  * provides endianness conversion
  */
@@ -120,7 +135,7 @@ public:
 #ifdef K_IS_LITTLE_ENDIAN
 		return K_SWAP_32(in);
 #else
-		return val
+		return in;
 #endif
 	}
 	
@@ -129,10 +144,128 @@ public:
 #ifdef K_IS_LITTLE_ENDIAN
 		return K_SWAP_16(in);
 #else
-		return val
+		return in;
 #endif
 	}
-	
+
+
+	/** the host's byte order */
+	static constexpr ByteOrder getHostOrder() {
+#ifdef K_IS_LITTLE_ENDIAN
+		return ByteOrder::LITTLE;
+#else
+		return ByteOrder::BIG;
+#endif
+	}
+
+	/**
+	 * convert num values between the host's byte order and the given one.
+	 * the conversion is symmetric, src and dst may be the same (in-place).
+	 * a plain copy (or nothing) when the orders match.
+	 */
+	template <typename T> static void convert(const T* src, T* dst, const size_t num, const ByteOrder order) {
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "unsupported element size");
+		if (sizeof(T) == 1 || order == getHostOrder()) {
+			if (src != dst) {memcpy(dst, src, num * sizeof(T));}
+		} else {
+			swapArray(src, dst, num, sizeof(T));
+		}
+	}
+
+	/** convert num values from the given byte order to the host's one (in-place) */
+	template <typename T> static void toHost(T* values, const size_t num, const ByteOrder order) {
+		convert(values, values, num, order);
+	}
+
+	/** convert num values from the host's byte order to the given one */
+	template <typename T> static void fromHost(const T* src, T* dst, const size_t num, const ByteOrder order) {
+		convert(src, dst, num, order);
+	}
+
+	/**
+	 * reverse the bytes of num elements of the given size (2, 4, 8) from src to dst.
+	 * uses AVX2 / SSSE3 shuffles (chosen at runtime) or a scalar fallback.
+	 * src and dst may be the same
+	 */
+	static void swapArray(const void* src, void* dst, const size_t num, const size_t elemSize) {
+
+		const uint8_t* s = (const uint8_t*) src;
+		uint8_t* d = (uint8_t*) dst;
+		const size_t bytes = num * elemSize;
+		size_t done = 0;
+
+#ifdef K_ENDIAN_X86_SIMD
+		static const int simd = detectSIMD();
+		if (simd == 2)		{done = swapAVX2(s, d, bytes, elemSize);}
+		else if (simd == 1)	{done = swapSSSE3(s, d, bytes, elemSize);}
+#endif
+
+		swapScalar(s + done, d + done, (bytes - done) / elemSize, elemSize);
+
+	}
+
+private:
+
+	/** byte-reversal of whole elements, one at a time */
+	static void swapScalar(const uint8_t* s, uint8_t* d, const size_t num, const size_t elemSize) {
+		switch (elemSize) {
+			case 2: for (size_t i = 0; i < num; ++i) {uint16_t v; memcpy(&v, s+2*i, 2); v = K_SWAP_16(v); memcpy(d+2*i, &v, 2);} break;
+			case 4: for (size_t i = 0; i < num; ++i) {uint32_t v; memcpy(&v, s+4*i, 4); v = K_SWAP_32(v); memcpy(d+4*i, &v, 4);} break;
+			case 8: for (size_t i = 0; i < num; ++i) {uint64_t v; memcpy(&v, s+8*i, 8); v = K_SWAP_64(v); memcpy(d+8*i, &v, 8);} break;
+			default: break;
+		}
+	}
+
+#ifdef K_ENDIAN_X86_SIMD
+
+	/** 0 = none, 1 = SSSE3, 2 = AVX2 */
+	static int detectSIMD() {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))		{return 2;}
+		if (__builtin_cpu_supports("ssse3"))	{return 1;}
+		return 0;
+	}
+
+	/** pshufb pattern reversing each element of the given size within 16 bytes */
+	static inline void getShuffle(uint8_t* mask, const size_t elemSize) {
+		for (size_t i = 0; i < 16; ++i) {mask[i] = (uint8_t) ((i / elemSize) * elemSize + (elemSize - 1 - i % elemSize));}
+	}
+
+	/** swap as many 16-byte blocks as possible. returns the number of processed bytes */
+	__attribute__((target("ssse3")))
+	static size_t swapSSSE3(const uint8_t* s, uint8_t* d, const size_t bytes, const size_t elemSize) {
+		uint8_t m[16];
+		getShuffle(m, elemSize);
+		const __m128i mask = _mm_loadu_si128((const __m128i*) m);
+		size_t i = 0;
+		for (; i + 16 <= bytes; i += 16) {
+			const __m128i v = _mm_loadu_si128((const __m128i*) (s+i));
+			_mm_storeu_si128((__m128i*) (d+i), _mm_shuffle_epi8(v, mask));
+		}
+		return i;
+	}
+
+	/** swap as many 32-byte blocks as possible (rest: SSSE3). returns the number of processed bytes */
+	__attribute__((target("avx2")))
+	static size_t swapAVX2(const uint8_t* s, uint8_t* d, const size_t bytes, const size_t elemSize) {
+		uint8_t m[16];
+		getShuffle(m, elemSize);
+		const __m128i m128 = _mm_loadu_si128((const __m128i*) m);
+		const __m256i mask = _mm256_broadcastsi128_si256(m128);
+		size_t i = 0;
+		for (; i + 32 <= bytes; i += 32) {
+			const __m256i v = _mm256_loadu_si256((const __m256i*) (s+i));
+			_mm256_storeu_si256((__m256i*) (d+i), _mm256_shuffle_epi8(v, mask));
+		}
+		if (i + 16 <= bytes) {
+			const __m128i v = _mm_loadu_si128((const __m128i*) (s+i));
+			_mm_storeu_si128((__m128i*) (d+i), _mm_shuffle_epi8(v, m128));
+			i += 16;
+		}
+		return i;
+	}
+
+#endif
 	
 };
 
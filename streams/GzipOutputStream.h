@@ -10,8 +10,13 @@
 
 #ifdef WITH_ZLIB
 
-#include "OutputStream.h"
 #include <zlib.h>
+#include <vector>
+#include <cstring>
+
+#include "OutputStream.h"
+#include "Buffer.h"
+#include "StreamException.h"
 
 namespace K {
 
@@ -26,9 +31,32 @@ enum class GzipOutputStreamHeader {
 
 };
 
+/**
+ * settings for compressing on several threads
+ */
+struct GzipParallelSettings {
+
+	/** the (uncompressed) size of one independently deflated block */
+	size_t blockSize = 128*1024;
+
+	/**
+	 * the number of blocks to compress in parallel.
+	 * bounds the in-flight memory to about 2 * numParallel * blockSize
+	 */
+	unsigned int numParallel = 8;
+
+};
+
 /**
  * An OutputStream compressing all provided data-chunks
  * using GZIP
+ *
+ * when constructed with GzipParallelSettings, the input is split into
+ * blocks that are deflated in parallel (OpenMP), pigz-style: each block's
+ * dictionary is primed with the 32 KB of input preceding it and ends on a
+ * byte boundary (sync flush). the blocks are written in order and form one
+ * single, regular deflate stream, the checksum is combined across blocks.
+ * the output is thus readable by GzipInputStream (and gzip/zlib) as usual.
  */
 class GzipOutputStream : public OutputStream {
 
@@ -41,7 +69,7 @@ public:
 	 */
 	GzipOutputStream(OutputStream& os,
 			GzipOutputStreamHeader header = GzipOutputStreamHeader::MODE_DEFLATE,
-			int level = Z_DEFAULT_COMPRESSION) : os(os) {
+			int level = Z_DEFAULT_COMPRESSION) : os(os), parallel(false) {
 
 		settings.level = level;
 		settings.header = header;
@@ -52,10 +80,50 @@ public:
 
 	}
 
+	/**
+	 * ctor for compressing on several threads
+	 * @param os the stream to send the compressed data to
+	 * @param header the header (and checksum) format to use
+	 * @param level the compression level between 1 (fastest) and 9 (best)
+	 * @param par block size and parallelization settings
+	 */
+	GzipOutputStream(OutputStream& os,
+			GzipOutputStreamHeader header,
+			int level,
+			const GzipParallelSettings& par) : os(os), parallel(true), par(par), workers(par.numParallel) {
+
+		if (par.numParallel == 0) {throw StreamException("Gzip: numParallel must be > 0");}
+		if (par.blockSize == 0) {throw StreamException("Gzip: blockSize must be > 0");}
+
+		settings.level = level;
+		settings.header = header;
+
+		// unused in parallel mode
+		memset(&stream, 0, sizeof(stream));
+		buffer.data = nullptr;
+
+		// one raw-deflate state per parallel block. never moved after init (zlib keeps a back-pointer)
+		for (z_stream& w : workers) {
+			memset(&w, 0, sizeof(w));
+			const int ret = deflateInit2(&w, level, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+			if (ret != Z_OK) {throw StreamException("Gzip: error while initializing deflate");}
+		}
+
+		blocksComp.resize(par.numParallel);
+		blocksCompLen.resize(par.numParallel);
+		blocksCheck.resize(par.numParallel);
+		check = (header == GzipOutputStreamHeader::MODE_GZIP) ? (crc32(0, Z_NULL, 0)) : (adler32(0, Z_NULL, 0));
+
+	}
+
 	/** dtor */
 	~GzipOutputStream() {
 		free(buffer.data); buffer.data = nullptr;
-		deflateEnd(&stream);
+		if (parallel) {
+			for (z_stream& w : workers) {deflateEnd(&w);}
+		} else {
+			deflateEnd(&stream);
+		}
 	}
 
 
@@ -65,6 +133,11 @@ public:
 
 	void write(const uint8_t* data, const size_t len) override {
 
+		if (parallel) {
+			writeParallel(data, len);
+			return;
+		}
+
 		// what to compress
 		stream.next_in = (unsigned char*) data;
 		stream.avail_in = (uInt) len;
@@ -74,18 +147,175 @@ public:
 	}
 
 	void flush() override {
-		compress(Z_SYNC_FLUSH);
+		if (parallel) {
+			compressBlocks(false);
+		} else {
+			compress(Z_SYNC_FLUSH);
+		}
 		os.flush();
 	}
 
 	void close() override {
-		compress(Z_FINISH);
+		if (parallel) {
+			if (closed) {return;}
+			compressBlocks(true);
+			writeTrailer();
+			closed = true;
+		} else {
+			compress(Z_FINISH);
+		}
 		os.close();
 	}
 
 
 private:
 
+	/** feed at most one batch at a time to bound the in-flight memory */
+	void writeParallel(const uint8_t* data, const size_t len) {
+		const size_t batchSize = par.blockSize * par.numParallel;
+		size_t pos = 0;
+		while (pos < len) {
+			const size_t free = batchSize - input.getNumUsed();
+			const size_t toAdd = (len - pos < free) ? (len - pos) : (free);
+			input.add(data + pos, toAdd);
+			pos += toAdd;
+			if (input.getNumUsed() >= batchSize) {compressBlocks(false);}
+		}
+	}
+
+	/** the zlib header's FLEVEL bits, as zlib itself derives them from the level */
+	int getLevelFlags() const {
+		const int level = (settings.level == Z_DEFAULT_COMPRESSION) ? (6) : (settings.level);
+		if (level < 2) {return 0;}
+		if (level < 6) {return 1;}
+		if (level == 6) {return 2;}
+		return 3;
+	}
+
+	/** write the gzip or zlib header */
+	void writeHeader() {
+
+		if (settings.header == GzipOutputStreamHeader::MODE_GZIP) {
+			// magic, deflate, no flags, no mtime, no extra flags, OS: unix
+			const uint8_t header[10] = {0x1f, 0x8b, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+			os.write(header, 10);
+		} else {
+			// 32 KB window, deflate. FCHECK makes the 16 bit value a multiple of 31
+			const unsigned int cmf = 0x78;
+			unsigned int flg = getLevelFlags() << 6;
+			flg += 31 - ((cmf * 256 + flg) % 31);
+			const uint8_t header[2] = {(uint8_t) cmf, (uint8_t) flg};
+			os.write(header, 2);
+		}
+
+		headerWritten = true;
+
+	}
+
+	/** write the checksum (and size) of the uncompressed content */
+	void writeTrailer() {
+
+		if (settings.header == GzipOutputStreamHeader::MODE_GZIP) {
+			// crc32 and size modulo 2^32, both little endian
+			uint8_t tail[8];
+			for (int i = 0; i < 4; ++i) {tail[i+0] = (uint8_t) (check >> (8*i));}
+			for (int i = 0; i < 4; ++i) {tail[i+4] = (uint8_t) (totalIn >> (8*i));}
+			os.write(tail, 8);
+		} else {
+			// adler32, big endian
+			uint8_t tail[4];
+			for (int i = 0; i < 4; ++i) {tail[i] = (uint8_t) (check >> (24-8*i));}
+			os.write(tail, 4);
+		}
+
+	}
+
+	/**
+	 * deflate all buffered input as (up to numParallel) blocks in parallel.
+	 * the last block of the stream is finished, all others are sync-flushed.
+	 */
+	void compressBlocks(const bool last) {
+
+		if (!headerWritten) {writeHeader();}
+
+		// the final block is needed even without pending input
+		const size_t used = input.getNumUsed();
+		if (used == 0 && !last) {return;}
+
+		const uint8_t* src = input.getData();
+		const int numBlocks = (used == 0) ? (1) : ((int) ((used + par.blockSize - 1) / par.blockSize));
+		const bool gzip = settings.header == GzipOutputStreamHeader::MODE_GZIP;
+
+		#pragma omp parallel for if(numBlocks > 1)
+		for (int i = 0; i < numBlocks; ++i) {
+
+			const size_t start = i * par.blockSize;
+			const size_t len = (used - start < par.blockSize) ? (used - start) : (par.blockSize);
+
+			// prime the dictionary with the preceding 32 KB (of this batch or the previous one)
+			const uint8_t* dict = (start) ? (src + start - ((start < DICT_SIZE) ? (start) : (DICT_SIZE))) : (history.data());
+			const size_t dictLen = (start) ? ((start < DICT_SIZE) ? (start) : (DICT_SIZE)) : (history.size());
+
+			const bool finish = last && (i == numBlocks - 1);
+			blocksCompLen[i] = deflateBlock(workers[i], src + start, len, dict, dictLen, finish, blocksComp[i]);
+			blocksCheck[i] = (gzip) ? (crc32(0, src + start, (uInt) len)) : (adler32(1, src + start, (uInt) len));
+
+		}
+
+		// write them in order and combine the checksums
+		for (int i = 0; i < numBlocks; ++i) {
+			if (blocksCompLen[i] == ERR_BLOCK) {throw StreamException("Gzip: error while compressing data chunk");}
+			const size_t start = i * par.blockSize;
+			const size_t len = (used - start < par.blockSize) ? (used - start) : (par.blockSize);
+			os.write(blocksComp[i].data(), blocksCompLen[i]);
+			check = (gzip) ? (crc32_combine(check, blocksCheck[i], (z_off_t) len)) : (adler32_combine(check, blocksCheck[i], (z_off_t) len));
+		}
+		totalIn += used;
+
+		// the tail of this batch primes the next one
+		if (used >= DICT_SIZE) {
+			history.assign(src + used - DICT_SIZE, src + used);
+		} else {
+			history.insert(history.end(), src, src + used);
+			if (history.size() > DICT_SIZE) {history.erase(history.begin(), history.end() - DICT_SIZE);}
+		}
+
+		input.clear();
+
+	}
+
+	/**
+	 * raw-deflate one block into dst using the given dictionary.
+	 * returns the number of bytes written to dst, or ERR_BLOCK.
+	 * runs within the parallel region and thus must not throw.
+	 */
+	static size_t deflateBlock(z_stream& strm, const uint8_t* src, const size_t len, const uint8_t* dict, const size_t dictLen, const bool finish, std::vector<uint8_t>& dst) {
+
+		deflateReset(&strm);
+		if (dictLen) {deflateSetDictionary(&strm, dict, (uInt) dictLen);}
+
+		// bound + room for the sync-flush marker
+		dst.resize(deflateBound(&strm, (uLong) len) + 16);
+
+		strm.next_in = (unsigned char*) src;
+		strm.avail_in = (uInt) len;
+		size_t written = 0;
+
+		while (true) {
+			strm.next_out = dst.data() + written;
+			strm.avail_out = (uInt) (dst.size() - written);
+			const int ret = deflate(&strm, (finish) ? (Z_FINISH) : (Z_SYNC_FLUSH));
+			if (ret == Z_STREAM_ERROR) {return ERR_BLOCK;}
+			written = dst.size() - strm.avail_out;
+			if (finish && ret == Z_STREAM_END) {break;}
+			if (!finish && strm.avail_out != 0) {break;}
+			dst.resize(dst.size() * 2);
+		}
+
+		return written;
+
+	}
+
 	void compress(int flush) {
 
 		unsigned int compressedBytes;
@@ -156,6 +386,49 @@ private:
 	} buffer;
 
 
+	/** marks a block that failed to compress */
+	static constexpr size_t ERR_BLOCK = (size_t) -1;
+
+	/** size of the deflate window used as dictionary for the next block */
+	static constexpr size_t DICT_SIZE = 32*1024;
+
+	/** compress on several threads? */
+	const bool parallel;
+
+	/** settings for the parallel mode */
+	GzipParallelSettings par;
+
+	/** one raw-deflate state per parallel block */
+	std::vector<z_stream> workers;
+
+	/** uncompressed input awaiting the next batch */
+	Buffer<uint8_t> input;
+
+	/** the last (up to) 32 KB of the previous batch */
+	std::vector<uint8_t> history;
+
+	/** per-block compressed output */
+	std::vector<std::vector<uint8_t>> blocksComp;
+
+	/** per-block number of bytes within blocksComp */
+	std::vector<size_t> blocksCompLen;
+
+	/** per-block checksum of the uncompressed data */
+	std::vector<uLong> blocksCheck;
+
+	/** the combined checksum (crc32 or adler32) of all input so far */
+	uLong check = 0;
+
+	/** the number of uncompressed bytes so far */
+	uint64_t totalIn = 0;
+
+	/** header already written? */
+	bool headerWritten = false;
+
+	/** already closed? */
+	bool closed = false;
+
+
 };
 
 }
@@ -25,6 +25,9 @@ public:
 	/** reading failed as nothing is available. try again */
 	static constexpr int ERR_TRY_AGAIN = -2;
 
+	/** the stream does not support the requested operation (e.g. borrow) */
+	static constexpr int ERR_NOT_SUPPORTED = -3;
+
 
 	/** dtor */
 	virtual ~InputStream() {;}
@@ -41,19 +44,39 @@ public:
 	 * returns the number of read bytes (if everything was fine)
 	 * returns 0 if nothing was available for reading (but could be in the future)
 	 * returns ERR_FAILED if reading failed
+	 *
+	 * this default falls back to the single-byte read() and should only
+	 * be used for prototyping. every stream should provide a native block-read.
 	 */
 	virtual ssize_t read(uint8_t* data, size_t len) {
 		size_t bytesRead = 0;
-		while (--len) {
-			int ret = read();
-			if (ret == -1) {break;}
-			*data = (uint8_t) ret;
-			++data;
+		while (bytesRead < len) {
+			const int ret = read();
+			if (ret == ERR_TRY_AGAIN) {break;}
+			if (ret == ERR_FAILED) {return (bytesRead == 0) ? (ERR_FAILED) : ((ssize_t) bytesRead);}
+			data[bytesRead] = (uint8_t) ret;
 			++bytesRead;
 		}
 		return bytesRead;
 	}
 
+	/**
+	 * zero-copy read: borrow (at most) the next len bytes directly from
+	 * the stream's internal buffer instead of copying them into a caller-provided one.
+	 * on success, data points to the borrowed bytes. those are consumed and remain
+	 * valid until the next call to any other method of this stream.
+	 * returns the number of borrowed bytes (if everything was fine)
+	 * returns 0 if nothing was available for reading (but could be in the future)
+	 * returns ERR_FAILED if reading failed
+	 * returns ERR_NOT_SUPPORTED if the stream has no internal buffer to borrow from.
+	 * in this case nothing is consumed and the caller should use read() instead.
+	 */
+	virtual ssize_t borrow(const uint8_t*& data, const size_t len) {
+		(void) data;
+		(void) len;
+		return ERR_NOT_SUPPORTED;
+	}
+
 	/**
 	 * try the read the given number of bytes.
 	 * will block until everything could be read.
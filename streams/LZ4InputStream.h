@@ -9,21 +9,34 @@
 #define LZ4INPUTSTREAM_H_
 
 #include "lz4/lz4.h"
+#include "lz4/LZ4Frame.h"
 #include "InputStream.h"
 #include "Buffer.h"
 #include "StreamException.h"
 
+#include <vector>
+
 namespace K {
 
 /**
- * stream to decompress LZ4-compressed input data
+ * stream to decompress LZ4-compressed input data.
+ *
+ * supports both, the legacy format written by LZ4OutputStream (default)
+ * and standard LZ4 frames (independent blocks only). the format is
+ * detected automatically. frame blocks are decompressed in parallel.
  */
 class LZ4InputStream : public InputStream {
 
 public:
 
-	/** ctor */
-	LZ4InputStream(InputStream& is) : is(is), eof(false) {
+	/**
+	 * ctor
+	 * @param is the compressed InputStream to read from
+	 * @param numParallel the number of frame blocks to decompress in parallel
+	 */
+	LZ4InputStream(InputStream& is, const unsigned int numParallel = 4) :
+		is(is), borrowed(0), eof(false), format(Format::UNKNOWN),
+		numParallel((numParallel) ? (numParallel) : (1)), inFrame(false) {
 		bufferDecomp.resize(4*1024);
 	}
 
@@ -33,12 +46,14 @@ public:
 	}
 
 	int read() override {
+		release();
 		if (bufferDecomp.empty()) {decompressBlock();}
 		if (bufferDecomp.empty()) {return -1;}
 		return bufferDecomp.get();
 	}
 
 	ssize_t read(uint8_t* data, const size_t len) override {
+		release();
 		if (bufferDecomp.empty()) {decompressBlock();}
 		if (bufferDecomp.empty()) {return -1;}
 		const size_t toRead = (len <= bufferDecomp.getNumUsed()) ? (len) : (bufferDecomp.getNumUsed());
@@ -47,6 +62,16 @@ public:
 		return toRead;
 	}
 
+	/** borrow decompressed bytes directly from the decompression buffer */
+	ssize_t borrow(const uint8_t*& data, const size_t len) override {
+		release();
+		if (bufferDecomp.empty()) {decompressBlock();}
+		if (bufferDecomp.empty()) {return -1;}
+		borrowed = (len <= bufferDecomp.getNumUsed()) ? (len) : (bufferDecomp.getNumUsed());
+		data = bufferDecomp.getData();
+		return borrowed;
+	}
+
 	void close() override {
 		is.close();
 	}
@@ -58,26 +83,76 @@ public:
 
 private:
 
+	/** the detected input format */
+	enum class Format {
+		UNKNOWN,
+		LEGACY,
+		FRAME,
+	};
+
+	/** one compressed frame block */
+	struct FrameBlock {
+		std::vector<uint8_t> data;
+		uint32_t len;
+		bool raw;
+		int decompressed;
+		bool checksumOK;
+	};
+
+	/** remove the bytes handed out by the last borrow() from the buffer */
+	inline void release() {
+		if (borrowed) {bufferDecomp.remove(borrowed); borrowed = 0;}
+	}
+
 	/**
-	 * read the next compressed block from the underlying input stream
-	 * and decompress it into a temporal buffer.
+	 * read the next compressed block(s) from the underlying input stream
+	 * and decompress it/them into a temporal buffer.
 	 */
 	void decompressBlock() {
 
-		// read block length
-		int blockSize;
-		int read = is.readFully( (uint8_t*)&blockSize, 4);
-		if (read == -1) {return;}
+		if (eof) {return;}
+
+		// the first 4 bytes are either the frame magic or the first legacy block's length
+		if (format == Format::UNKNOWN) {
+			uint8_t head[4];
+			if (is.readFully(head, 4) != 4) {eof = true; return;}
+			const uint32_t val = LZ4Frame::read32(head);
+			if (val == LZ4Frame::MAGIC || (val & 0xFFFFFFF0) == LZ4Frame::MAGIC_SKIPPABLE) {
+				format = Format::FRAME;
+				if (!startFrame(val)) {eof = true; return;}
+			} else {
+				format = Format::LEGACY;
+				decompressLegacyBlock((int) val);
+				return;
+			}
+		}
+
+		if (format == Format::LEGACY) {
+			int blockSize;
+			const ssize_t read = is.readFully( (uint8_t*)&blockSize, 4);
+			if (read == -1) {eof = true; return;}
+			decompressLegacyBlock(blockSize);
+		} else {
+			decompressFrameBlocks();
+		}
+
+	}
+
+	/** read and decompress one block of the legacy format */
+	void decompressLegacyBlock(const int blockSize) {
+
 		//std::cout << "next block: " << blockSize << std::endl;
 
 		// read compressed data
-		uint8_t buf[blockSize];
-		read = is.readFully(buf, blockSize);
-		if (read != blockSize) {throw "could not read block";}
+		if (blockSize < 0) {throw "could not read block";}
+		std::vector<uint8_t> buf( (size_t) blockSize );
+		const ssize_t read = is.readFully(buf.data(), (size_t) blockSize);
+		if (read != (ssize_t) blockSize) {throw "could not read block";}
 
 		// decompress
 		again:
-		int decomp = LZ4_decompress_safe( (const char*) buf, (char*) bufferDecomp.getData(), blockSize, bufferDecomp.getSize() );
+		// the buffer never grows beyond 32 MB (see below) and thus fits into an int
+		int decomp = LZ4_decompress_safe( (const char*) buf.data(), (char*) bufferDecomp.getData(), blockSize, (int) bufferDecomp.getSize() );
 
 
 		// check whether the buffer was able to catch all decompressed bytes
@@ -91,7 +166,6 @@ private:
 
 			// resize the buffer
 			bufferDecomp.resize(bufferDecomp.getSize()*2);
-			std::cout << "growing to " << bufferDecomp.getSize() << std::endl;
 
 			// try decompression
 			goto again;
@@ -103,6 +177,134 @@ private:
 
 	}
 
+	/**
+	 * start a new frame, given its already-read magic number.
+	 * skippable frames are skipped until a real frame is found.
+	 * returns false on EOF.
+	 */
+	bool startFrame(uint32_t magic) {
+
+		uint8_t buf[8];
+
+		while ((magic & 0xFFFFFFF0) == LZ4Frame::MAGIC_SKIPPABLE) {
+			if (is.readFully(buf, 4) != 4) {throw StreamException("LZ4: truncated skippable frame");}
+			is.skip(LZ4Frame::read32(buf));
+			if (is.readFully(buf, 4) != 4) {return false;}
+			magic = LZ4Frame::read32(buf);
+		}
+		if (magic != LZ4Frame::MAGIC) {throw StreamException("LZ4: invalid frame magic");}
+
+		// frame descriptor
+		uint8_t desc[2+8+4];
+		if (is.readFully(desc, 2) != 2) {throw StreamException("LZ4: truncated frame header");}
+		const uint8_t flg = desc[0];
+		const uint8_t bd = desc[1];
+		if ((flg & 0xC0) != LZ4Frame::FLG_VERSION)			{throw StreamException("LZ4: unsupported frame version");}
+		if (!(flg & LZ4Frame::FLG_BLOCK_INDEPENDENT))		{throw StreamException("LZ4: dependent blocks are not supported");}
+		if (flg & LZ4Frame::FLG_DICT_ID)					{throw StreamException("LZ4: dictionaries are not supported");}
+		size_t descLen = 2;
+		if (flg & LZ4Frame::FLG_CONTENT_SIZE) {
+			if (is.readFully(desc+descLen, 8) != 8) {throw StreamException("LZ4: truncated frame header");}
+			descLen += 8;
+		}
+		if (is.readFully(buf, 1) != 1) {throw StreamException("LZ4: truncated frame header");}
+		if (buf[0] != LZ4Frame::getHeaderChecksum(desc, descLen)) {throw StreamException("LZ4: frame header checksum mismatch");}
+
+		const uint8_t bsID = (bd >> 4) & 0x07;
+		if (bsID < 4) {throw StreamException("LZ4: invalid block size");}
+		blockBytes = LZ4Frame::getBlockBytes(bsID);
+		hasBlockChecksum = flg & LZ4Frame::FLG_BLOCK_CHECKSUM;
+		hasContentChecksum = flg & LZ4Frame::FLG_CONTENT_CHECKSUM;
+		contentHash.reset();
+		inFrame = true;
+		return true;
+
+	}
+
+	/** read (up to numParallel) frame blocks and decompress them in parallel */
+	void decompressFrameBlocks() {
+
+		uint8_t buf[4];
+		size_t numBlocks = 0;
+		bool frameEnd = false;
+		uint32_t expectedChecksum = 0;
+
+		// fetch the next compressed blocks (until the end of the current frame)
+		while (numBlocks < numParallel) {
+
+			// next frame (concatenated frames)
+			if (!inFrame) {
+				if (is.readFully(buf, 4) != 4) {break;}
+				if (!startFrame(LZ4Frame::read32(buf))) {break;}
+			}
+
+			if (is.readFully(buf, 4) != 4) {throw StreamException("LZ4: truncated frame");}
+			const uint32_t size = LZ4Frame::read32(buf);
+
+			// end mark
+			if (size == 0) {
+				if (hasContentChecksum) {
+					if (is.readFully(buf, 4) != 4) {throw StreamException("LZ4: truncated frame");}
+					expectedChecksum = LZ4Frame::read32(buf);
+				}
+				frameEnd = true;
+				inFrame = false;
+				break;
+			}
+
+			if (blocks.size() <= numBlocks) {blocks.resize(numBlocks+1);}
+			FrameBlock& block = blocks[numBlocks];
+			block.raw = size & LZ4Frame::BLOCK_UNCOMPRESSED;
+			block.len = size & ~LZ4Frame::BLOCK_UNCOMPRESSED;
+			if (block.len > blockBytes) {throw StreamException("LZ4: block exceeds the maximum block size");}
+			const uint32_t total = block.len + ((hasBlockChecksum) ? (4) : (0));
+			block.data.resize(total);
+			if (is.readFully(block.data.data(), total) != (ssize_t) total) {throw StreamException("LZ4: truncated block");}
+			++numBlocks;
+
+		}
+
+		// decompress all blocks into their slot within the output buffer
+		bufferDecomp.clear();
+		bufferDecomp.ensureMinSize(numBlocks * blockBytes);
+		uint8_t* dst = bufferDecomp.getData();
+
+		#pragma omp parallel for if(numBlocks > 1)
+		for (int i = 0; i < (int) numBlocks; ++i) {
+			FrameBlock& block = blocks[i];
+			uint8_t* out = dst + i * (size_t) blockBytes;
+			block.checksumOK = !hasBlockChecksum || LZ4Frame::read32(block.data.data() + block.len) == XXH32::hash(block.data.data(), block.len);
+			if (block.raw) {
+				memcpy(out, block.data.data(), block.len);
+				block.decompressed = (int) block.len;
+			} else {
+				block.decompressed = LZ4_decompress_safe((const char*) block.data.data(), (char*) out, (int) block.len, (int) blockBytes);
+			}
+		}
+
+		// close the gaps behind short blocks (usually only the last one of a frame) and verify
+		size_t used = 0;
+		for (size_t i = 0; i < numBlocks; ++i) {
+			const FrameBlock& block = blocks[i];
+			if (!block.checksumOK)		{throw StreamException("LZ4: block checksum mismatch");}
+			if (block.decompressed < 0)	{throw StreamException("LZ4: stream corrupted");}
+			const uint8_t* out = dst + i * (size_t) blockBytes;
+			if (out != dst + used) {memmove(dst + used, out, block.decompressed);}
+			if (hasContentChecksum) {contentHash.update(dst + used, block.decompressed);}
+			used += block.decompressed;
+		}
+		bufferDecomp.setNumUsed(used);
+
+		if (frameEnd && hasContentChecksum && contentHash.digest() != expectedChecksum) {
+			throw StreamException("LZ4: content checksum mismatch");
+		}
+
+		// nothing decompressed but not yet at EOF? (e.g. an empty frame) -> continue
+		if (used == 0 && frameEnd) {decompressBlock();}
+		else if (used == 0) {eof = true;}
+
+	}
+
 
 	/** the compressed InputStream to read from */
 	InputStream& is;
@@ -110,9 +312,34 @@ private:
 	/** the decompression buffer */
 	Buffer<uint8_t> bufferDecomp;
 
+	/** the number of bytes handed out by the last borrow() */
+	size_t borrowed;
+
 	/** eof reached? */
 	bool eof;
 
+	/** legacy or frame format? */
+	Format format;
+
+	/** the number of frame blocks to decompress in parallel */
+	const unsigned int numParallel;
+
+	/** currently within a frame? (otherwise: expect the next frame's magic) */
+	bool inFrame;
+
+	/** maximum (uncompressed) size of one block of the current frame */
+	uint32_t blockBytes = 0;
+
+	/** current frame's flags */
+	bool hasBlockChecksum = false;
+	bool hasContentChecksum = false;
+
+	/** checksum of the current frame's uncompressed content */
+	XXH32 contentHash;
+
+	/** compressed frame blocks, decompressed in parallel */
+	std::vector<FrameBlock> blocks;
+
 };
 
 }
@@ -10,14 +10,55 @@
 
 #include "lz4/lz4.h"
 #include "lz4/lz4.hc"
+#include "lz4/LZ4Frame.h"
 #include "OutputStream.h"
 #include "Buffer.h"
+#include "StreamException.h"
+
+#include <vector>
 
 namespace K {
 
 
+/**
+ * settings for writing standard LZ4 frames
+ */
+struct LZ4FrameSettings {
+
+	/** the maximum (uncompressed) size of one block */
+	LZ4Frame::BlockSize blockSize = LZ4Frame::BlockSize::KB_256;
+
+	/**
+	 * the number of blocks to compress in parallel.
+	 * bounds the in-flight memory to about 2 * numParallel * blockSize
+	 */
+	unsigned int numParallel = 8;
+
+	/** append a checksum of the uncompressed content to the frame */
+	bool contentChecksum = true;
+
+	/** append a checksum to each (compressed) block */
+	bool blockChecksum = false;
+
+	/**
+	 * append a block index (skippable frame) behind the frame, mapping
+	 * uncompressed offsets to compressed ones. allows random access
+	 * via LZ4SeekableInputStream. other readers simply skip it
+	 */
+	bool blockIndex = false;
+
+};
+
+
 /**
  * stream to compress data using LZ4
+ *
+ * by default, the data is written in a simple (legacy) format:
+ * each block is prefixed with its compressed length.
+ *
+ * when constructed with LZ4FrameSettings, the output is a standard
+ * LZ4 frame (readable by the lz4 tool) made of independent blocks.
+ * those blocks are compressed in parallel (OpenMP) and written in order.
  */
 class LZ4OutputStream : public OutputStream {
 
@@ -28,10 +69,26 @@ public:
 	 * @param os the OutputStream to write the compressed data to
 	 * @param bufferSize the number of bytes to buffer before compressing the data
 	 */
-	LZ4OutputStream(OutputStream& os, unsigned int bufferSize = 4096) : os(os), bufferSize(bufferSize) {
+	LZ4OutputStream(OutputStream& os, unsigned int bufferSize = 4096) :
+		os(os), bufferSize(bufferSize), framed(false), headerWritten(false), closed(false) {
 		;
 	}
 
+	/**
+	 * ctor for writing standard LZ4 frames
+	 * @param os the OutputStream to write the compressed frame to
+	 * @param settings frame and parallelization settings
+	 */
+	LZ4OutputStream(OutputStream& os, const LZ4FrameSettings& settings) :
+		os(os), framed(true), settings(settings), headerWritten(false), closed(false) {
+
+		if (settings.numParallel == 0) {throw StreamException("LZ4: numParallel must be > 0");}
+		blockBytes = LZ4Frame::getBlockBytes((uint8_t) settings.blockSize);
+		bufferSize = blockBytes * settings.numParallel;
+		buffer.resize(bufferSize);
+
+	}
+
 	/** dtor */
 	~LZ4OutputStream() {
 		close();
@@ -44,8 +101,23 @@ public:
 	}
 
 	void write(const uint8_t* data, const size_t len) override {
-		buffer.add(data, len);
-		checkCompress();
+
+		if (!framed) {
+			buffer.add(data, len);
+			checkCompress();
+			return;
+		}
+
+		// feed at most one batch at a time to bound the in-flight memory
+		size_t pos = 0;
+		while (pos < len) {
+			const size_t free = bufferSize - buffer.getNumUsed();
+			const size_t toAdd = (len - pos < free) ? (len - pos) : (free);
+			buffer.add(data + pos, toAdd);
+			pos += toAdd;
+			checkCompress();
+		}
+
 	}
 
 	void flush() override {
@@ -54,8 +126,12 @@ public:
 	}
 
 	void close() override {
+		if (closed) {return;}
 		compress();
+		if (framed) {finishFrame();}
+		if (framed && settings.blockIndex) {writeBlockIndex();}
 		os.close();
+		closed = true;
 	}
 
 private:
@@ -68,6 +144,11 @@ private:
 
 	/** perform compression */
 	void compress() {
+		if (framed) {compressFrameBlocks();} else {compressLegacy();}
+	}
+
+	/** perform compression using the legacy format */
+	void compressLegacy() {
 
 		// nothing to compress?
 		if (buffer.empty()) {return;}
@@ -91,6 +172,122 @@ private:
 
 	}
 
+	/** write the frame's header: magic, FLG, BD, HC */
+	void writeFrameHeader() {
+
+		uint8_t header[7];
+		LZ4Frame::write32(header, LZ4Frame::MAGIC);
+		header[4] = LZ4Frame::FLG_VERSION | LZ4Frame::FLG_BLOCK_INDEPENDENT;
+		if (settings.blockChecksum)		{header[4] |= LZ4Frame::FLG_BLOCK_CHECKSUM;}
+		if (settings.contentChecksum)	{header[4] |= LZ4Frame::FLG_CONTENT_CHECKSUM;}
+		header[5] = (uint8_t) ((uint8_t) settings.blockSize << 4);
+		header[6] = LZ4Frame::getHeaderChecksum(header+4, 2);
+		os.write(header, 7);
+		bytesWritten += 7;
+		headerWritten = true;
+
+	}
+
+	/** compress all buffered data into (up to numParallel) independent frame blocks */
+	void compressFrameBlocks() {
+
+		if (!headerWritten) {writeFrameHeader();}
+
+		// nothing to compress?
+		const size_t used = buffer.getNumUsed();
+		if (used == 0) {return;}
+
+		// the content checksum covers the uncompressed data, in order
+		if (settings.contentChecksum) {contentHash.update(buffer.getData(), used);}
+
+		// ensure each block's output buffer provides enough space
+		// [4 byte size][compressed data][optional 4 byte checksum]
+		const int numBlocks = (int) ((used + blockBytes - 1) / blockBytes);
+		blocksComp.resize(numBlocks);
+		blocksCompLen.resize(numBlocks);
+		for (int i = 0; i < numBlocks; ++i) {
+			blocksComp[i].resize(4 + LZ4_compressBound(blockBytes) + 4);
+		}
+
+		// compress all blocks independently
+		const uint8_t* src = buffer.getData();
+		#pragma omp parallel for if(numBlocks > 1)
+		for (int i = 0; i < numBlocks; ++i) {
+			const size_t start = i * (size_t) blockBytes;
+			const size_t len = (used - start < blockBytes) ? (used - start) : (blockBytes);
+			blocksCompLen[i] = compressFrameBlock(src + start, (int) len, blocksComp[i].data());
+		}
+
+		// write them in order
+		for (int i = 0; i < numBlocks; ++i) {
+			if (settings.blockIndex) {
+				index.push_back(bytesIn + i * (uint64_t) blockBytes);
+				index.push_back(bytesWritten);
+			}
+			os.write(blocksComp[i].data(), blocksCompLen[i]);
+			bytesWritten += blocksCompLen[i];
+		}
+		bytesIn += used;
+
+		// remove available input
+		buffer.clear();
+
+	}
+
+	/**
+	 * compress one block into dst: [4 byte size][data][optional checksum].
+	 * returns the number of bytes written to dst.
+	 * blocks that do not shrink are stored uncompressed.
+	 */
+	size_t compressFrameBlock(const uint8_t* src, const int len, uint8_t* dst) const {
+
+		int outSize = LZ4_compress_limitedOutput((const char*) src, (char*) dst+4, len, len-1);
+
+		if (outSize <= 0) {
+			memcpy(dst+4, src, len);
+			outSize = len;
+			LZ4Frame::write32(dst, (uint32_t) len | LZ4Frame::BLOCK_UNCOMPRESSED);
+		} else {
+			LZ4Frame::write32(dst, (uint32_t) outSize);
+		}
+
+		if (settings.blockChecksum) {
+			LZ4Frame::write32(dst+4+outSize, XXH32::hash(dst+4, outSize));
+			return 4 + outSize + 4;
+		}
+
+		return 4 + outSize;
+
+	}
+
+	/** write the frame's end-mark and content checksum */
+	void finishFrame() {
+		if (!headerWritten) {writeFrameHeader();}
+		uint8_t tail[8];
+		LZ4Frame::write32(tail, 0);
+		LZ4Frame::write32(tail+4, contentHash.digest());
+		os.write(tail, (settings.contentChecksum) ? (8) : (4));
+	}
+
+	/** write the block index as skippable frame behind the LZ4 frame */
+	void writeBlockIndex() {
+
+		const uint32_t numBlocks = (uint32_t) (index.size() / 2);
+		const size_t payload = numBlocks * LZ4Frame::INDEX_ENTRY_SIZE + LZ4Frame::INDEX_TRAILER_SIZE;
+		std::vector<uint8_t> buf(8 + payload);
+
+		LZ4Frame::write32(buf.data()+0, LZ4Frame::MAGIC_SKIPPABLE);
+		LZ4Frame::write32(buf.data()+4, (uint32_t) payload);
+		uint8_t* dst = buf.data() + 8;
+		for (const uint64_t val : index) {LZ4Frame::write64(dst, val); dst += 8;}
+		LZ4Frame::write64(dst, bytesIn);
+		LZ4Frame::write32(dst+8, numBlocks);
+		LZ4Frame::write32(dst+12, LZ4Frame::INDEX_TAG);
+
+		os.write(buf.data(), buf.size());
+
+	}
+
 	/** the stream to write to */
 	OutputStream& os;
 
@@ -103,6 +300,37 @@ private:
 	/** compression buffer */
 	Buffer<uint8_t> bufferComp;
 
+	/** write standard LZ4 frames instead of the legacy format? */
+	const bool framed;
+
+	/** settings when writing frames */
+	LZ4FrameSettings settings;
+
+	/** maximum (uncompressed) size of one frame block */
+	uint32_t blockBytes = 0;
+
+	/** frame header already written? */
+	bool headerWritten;
+
+	/** already closed? */
+	bool closed;
+
+	/** checksum of the uncompressed content */
+	XXH32 contentHash;
+
+	/** per-block compression buffers when writing frames */
+	std::vector<std::vector<uint8_t>> blocksComp;
+
+	/** per-block number of bytes within blocksComp */
+	std::vector<size_t> blocksCompLen;
+
+	/** the number of uncompressed / compressed bytes of the frame so far */
+	uint64_t bytesIn = 0;
+	uint64_t bytesWritten = 0;
+
+	/** pairs of uncompressed and compressed offsets, one per block */
+	std::vector<uint64_t> index;
+
 };
 
 
@@ -0,0 +1,240 @@
+#ifndef K_STREAMS_LZ4SEEKABLEINPUTSTREAM_H
+#define K_STREAMS_LZ4SEEKABLEINPUTSTREAM_H
+
+#include "lz4/lz4.h"
+#include "lz4/LZ4Frame.h"
+#include "InputStream.h"
+#include "MappedFileInputStream.h"
+#include "StreamException.h"
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+namespace K {
+
+/**
+ * random-access reader for LZ4 frames written by LZ4OutputStream
+ * with LZ4FrameSettings::blockIndex enabled.
+ *
+ * the block index behind the frame maps uncompressed offsets to
+ * compressed ones. seek() thus only needs to decompress the block
+ * containing the requested offset, instead of everything before it.
+ *
+ * the compressed data must be completely accessible, either as
+ * memory region or as (memory-mapped) file.
+ *
+ * the content checksum can not be verified when seeking, block
+ * checksums (if any) are verified for every decompressed block.
+ */
+class LZ4SeekableInputStream : public InputStream {
+
+public:
+
+	/**
+	 * ctor
+	 * @param data the compressed frame (including the block index)
+	 * @param len the number of bytes within data
+	 */
+	LZ4SeekableInputStream(const uint8_t* data, const size_t len) : data(data), len(len) {
+		init();
+	}
+
+	/**
+	 * ctor
+	 * @param file the file containing the compressed frame (including the block index)
+	 */
+	LZ4SeekableInputStream(const std::string& file) : mapped(new MappedFileInputStream(file)) {
+		data = mapped->getData();
+		len = mapped->getLength();
+		init();
+	}
+
+	/** no copy */
+	LZ4SeekableInputStream(const LZ4SeekableInputStream&) = delete;
+	LZ4SeekableInputStream& operator = (const LZ4SeekableInputStream&) = delete;
+
+	int read() override {
+		if (!ensureBlock()) {return ERR_FAILED;}
+		return block[pos++ - blockStart];
+	}
+
+	ssize_t read(uint8_t* dst, const size_t numBytes) override {
+		const uint8_t* src;
+		const ssize_t num = borrow(src, numBytes);
+		if (num > 0) {memcpy(dst, src, num);}
+		return num;
+	}
+
+	/** borrow decompressed bytes directly from the current block (up to the block's end) */
+	ssize_t borrow(const uint8_t*& dst, const size_t numBytes) override {
+		if (!ensureBlock()) {return ERR_FAILED;}
+		const size_t avail = blockEnd - pos;
+		const size_t num = (numBytes < avail) ? (numBytes) : (avail);
+		dst = block.data() + (pos - blockStart);
+		pos += num;
+		return num;
+	}
+
+	void close() override {
+		if (mapped) {mapped->close();}
+		data = nullptr;
+		len = 0;
+		contentSize = 0;
+		pos = 0;
+	}
+
+	void skip(const size_t n) override {
+		if (contentSize - pos < n) {throw StreamException("out of bounds while trying to skip some bytes");}
+		pos += n;
+	}
+
+	/** jump to the given (uncompressed) offset */
+	void seek(const uint64_t offset) {
+		if (offset > contentSize) {throw StreamException("out of bounds while trying to seek");}
+		pos = offset;
+	}
+
+	/** get the current (uncompressed) read position */
+	uint64_t getPosition() const {
+		return pos;
+	}
+
+	/** get the size of the uncompressed content */
+	uint64_t getLength() const {
+		return contentSize;
+	}
+
+	/** get the number of blocks within the frame */
+	size_t getNumBlocks() const {
+		return offsetsIn.size();
+	}
+
+private:
+
+	/** parse the frame header and the block index */
+	void init() {
+
+		// frame header
+		if (len < 7 || LZ4Frame::read32(data) != LZ4Frame::MAGIC) {throw StreamException("LZ4: invalid frame magic");}
+		const uint8_t flg = data[4];
+		const uint8_t bd = data[5];
+		if ((flg & 0xC0) != LZ4Frame::FLG_VERSION)			{throw StreamException("LZ4: unsupported frame version");}
+		if (!(flg & LZ4Frame::FLG_BLOCK_INDEPENDENT))		{throw StreamException("LZ4: dependent blocks are not supported");}
+		if (flg & LZ4Frame::FLG_DICT_ID)					{throw StreamException("LZ4: dictionaries are not supported");}
+		const size_t descLen = (flg & LZ4Frame::FLG_CONTENT_SIZE) ? (10) : (2);
+		if (len < 4 + descLen + 1) {throw StreamException("LZ4: truncated frame header");}
+		if (data[4 + descLen] != LZ4Frame::getHeaderChecksum(data + 4, descLen)) {throw StreamException("LZ4: frame header checksum mismatch");}
+		const uint8_t bsID = (bd >> 4) & 0x07;
+		if (bsID < 4) {throw StreamException("LZ4: invalid block size");}
+		blockBytes = LZ4Frame::getBlockBytes(bsID);
+		hasBlockChecksum = flg & LZ4Frame::FLG_BLOCK_CHECKSUM;
+		block.resize(blockBytes);
+
+		// block index: fixed trailer at the very end
+		const size_t minIndex = 8 + LZ4Frame::INDEX_TRAILER_SIZE;
+		if (len < 7 + minIndex || LZ4Frame::read32(data + len - 4) != LZ4Frame::INDEX_TAG) {
+			throw StreamException("LZ4: no block index found");
+		}
+		const uint32_t numBlocks = LZ4Frame::read32(data + len - 8);
+		contentSize = LZ4Frame::read64(data + len - 16);
+		const size_t payload = numBlocks * LZ4Frame::INDEX_ENTRY_SIZE + LZ4Frame::INDEX_TRAILER_SIZE;
+		if (len < 7 + 8 + payload) {throw StreamException("LZ4: corrupted block index");}
+		const uint8_t* idx = data + len - payload - 8;
+		if (LZ4Frame::read32(idx) != LZ4Frame::MAGIC_SKIPPABLE || LZ4Frame::read32(idx + 4) != payload) {
+			throw StreamException("LZ4: corrupted block index");
+		}
+
+		// entries must be increasing and point into the frame
+		const size_t frameEnd = len - payload - 8;
+		offsetsIn.resize(numBlocks);
+		offsetsComp.resize(numBlocks);
+		for (uint32_t i = 0; i < numBlocks; ++i) {
+			offsetsIn[i] = LZ4Frame::read64(idx + 8 + i * LZ4Frame::INDEX_ENTRY_SIZE);
+			offsetsComp[i] = LZ4Frame::read64(idx + 8 + i * LZ4Frame::INDEX_ENTRY_SIZE + 8);
+			const uint64_t next = (i + 1 < numBlocks) ? (LZ4Frame::read64(idx + 8 + (i+1) * LZ4Frame::INDEX_ENTRY_SIZE)) : (contentSize);
+			if (offsetsComp[i] + 4 > frameEnd)	{throw StreamException("LZ4: corrupted block index");}
+			if (i > 0 && offsetsComp[i] <= offsetsComp[i-1])	{throw StreamException("LZ4: corrupted block index");}
+			if (next <= offsetsIn[i] || next - offsetsIn[i] > blockBytes)	{throw StreamException("LZ4: corrupted block index");}
+		}
+		if (numBlocks == 0 && contentSize != 0)	{throw StreamException("LZ4: corrupted block index");}
+		if (numBlocks > 0 && offsetsIn[0] != 0)	{throw StreamException("LZ4: corrupted block index");}
+		dataEnd = frameEnd;
+
+	}
+
+	/** ensure the block containing the current position is decompressed. false on EOF */
+	bool ensureBlock() {
+
+		if (pos >= contentSize) {return false;}
+		if (pos >= blockStart && pos < blockEnd) {return true;}
+
+		// the last block starting at or before the current position
+		const size_t idx = (std::upper_bound(offsetsIn.begin(), offsetsIn.end(), pos) - offsetsIn.begin()) - 1;
+		const uint64_t expected = ((idx + 1 < offsetsIn.size()) ? (offsetsIn[idx+1]) : (contentSize)) - offsetsIn[idx];
+
+		// [4 byte size][data][optional checksum]
+		const uint8_t* src = data + offsetsComp[idx];
+		const uint32_t size = LZ4Frame::read32(src);
+		const bool raw = size & LZ4Frame::BLOCK_UNCOMPRESSED;
+		const uint32_t compLen = size & ~LZ4Frame::BLOCK_UNCOMPRESSED;
+		const size_t total = 4 + compLen + ((hasBlockChecksum) ? (4) : (0));
+		if (compLen > blockBytes || offsetsComp[idx] + total > dataEnd) {throw StreamException("LZ4: stream corrupted");}
+		if (hasBlockChecksum && LZ4Frame::read32(src + 4 + compLen) != XXH32::hash(src + 4, compLen)) {
+			throw StreamException("LZ4: block checksum mismatch");
+		}
+
+		int decompressed;
+		if (raw) {
+			memcpy(block.data(), src + 4, compLen);
+			decompressed = (int) compLen;
+		} else {
+			decompressed = LZ4_decompress_safe((const char*) src + 4, (char*) block.data(), (int) compLen, (int) blockBytes);
+		}
+		if (decompressed < 0 || (uint64_t) decompressed != expected) {throw StreamException("LZ4: stream corrupted");}
+
+		blockStart = offsetsIn[idx];
+		blockEnd = blockStart + expected;
+		return true;
+
+	}
+
+
+	/** the mapped file (if any) */
+	std::unique_ptr<MappedFileInputStream> mapped;
+
+	/** the compressed data */
+	const uint8_t* data;
+
+	/** the number of compressed bytes (including the index) */
+	size_t len;
+
+	/** the end of the LZ4 frame (start of the block index) */
+	size_t dataEnd = 0;
+
+	/** maximum (uncompressed) size of one block */
+	uint32_t blockBytes = 0;
+
+	/** blocks followed by a checksum? */
+	bool hasBlockChecksum = false;
+
+	/** the size of the uncompressed content */
+	uint64_t contentSize = 0;
+
+	/** per block: uncompressed and compressed offset */
+	std::vector<uint64_t> offsetsIn;
+	std::vector<uint64_t> offsetsComp;
+
+	/** the current (uncompressed) read position */
+	uint64_t pos = 0;
+
+	/** the currently decompressed block and its (uncompressed) region */
+	std::vector<uint8_t> block;
+	uint64_t blockStart = 0;
+	uint64_t blockEnd = 0;
+
+};
+
+}
+
+#endif // K_STREAMS_LZ4SEEKABLEINPUTSTREAM_H
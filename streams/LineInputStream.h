@@ -95,6 +95,10 @@ namespace K {
 			return is->read(data, len);
 		}
 
+		ssize_t borrow(const uint8_t*& data, const size_t len) override {
+			return is->borrow(data, len);
+		}
+
 		void close() override {
 			is->close();
 		}
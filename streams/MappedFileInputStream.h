@@ -0,0 +1,159 @@
+#ifndef K_STREAMS_MAPPEDFILEINPUTSTREAM_H
+#define K_STREAMS_MAPPEDFILEINPUTSTREAM_H
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "InputStreamPeek.h"
+#include "StreamException.h"
+#include "../fs/File.h"
+
+namespace K {
+
+/**
+ * Stream to read data from a memory-mapped file.
+ *
+ * the whole file is mapped read-only into the address space and
+ * the kernel is advised to read ahead sequentially. reading does not
+ * involve any FILE* buffering: borrow() and getData() provide
+ * direct access to the mapped pages without copying anything.
+ *
+ * POSIX only.
+ */
+class MappedFileInputStream : public InputStreamPeek {
+
+public:
+
+	/** ctor */
+	MappedFileInputStream(const std::string& file) : data(nullptr), len(0), pos(0) {
+		open(file);
+	}
+
+	MappedFileInputStream(const File& file) : MappedFileInputStream(file.getAbsolutePath()) {
+		;
+	}
+
+	/** dtor */
+	~MappedFileInputStream() {
+		close();
+	}
+
+	/** no copy */
+	MappedFileInputStream(const MappedFileInputStream&) = delete;
+	MappedFileInputStream& operator = (const MappedFileInputStream&) = delete;
+
+	int peek() override {
+		if (pos >= len) {return ERR_FAILED;}
+		return data[pos];
+	}
+
+	int read() override {
+		if (pos >= len) {return ERR_FAILED;}
+		return data[pos++];
+	}
+
+	ssize_t read(uint8_t* dst, const size_t numBytes) override {
+		if (pos >= len) {return ERR_FAILED;}
+		const size_t toRead = (numBytes < len - pos) ? (numBytes) : (len - pos);
+		memcpy(dst, data + pos, toRead);
+		pos += toRead;
+		return toRead;
+	}
+
+	ssize_t borrow(const uint8_t*& dst, const size_t numBytes) override {
+		if (pos >= len) {return ERR_FAILED;}
+		const size_t toBorrow = (numBytes < len - pos) ? (numBytes) : (len - pos);
+		dst = data + pos;
+		pos += toBorrow;
+		return toBorrow;
+	}
+
+	void close() override {
+		if (data) {munmap((void*) data, len); data = nullptr;}
+		len = 0;
+		pos = 0;
+	}
+
+	void skip(const size_t n) override {
+		if (len - pos < n) {throw StreamException("out of bounds while trying to skip some bytes");}
+		pos += n;
+	}
+
+	/** jump to the given absolute position within the file */
+	void seek(const size_t position) {
+		if (position > len) {throw StreamException("out of bounds while trying to seek");}
+		pos = position;
+	}
+
+	/** get the current (absolute) read position within the file */
+	size_t getPosition() const {
+		return pos;
+	}
+
+	/** get the number of bytes available for reading */
+	size_t getNumAvailable() const {
+		return len - pos;
+	}
+
+	/** get the size of the whole file (in bytes) */
+	size_t getLength() const {
+		return len;
+	}
+
+	/**
+	 * get the whole file's content. use getLength() for its size.
+	 * the memory stays valid until the stream is closed.
+	 * the content is NOT null-terminated!
+	 */
+	const uint8_t* getData() const {
+		return data;
+	}
+
+	/** get the content starting at the current read position. use getNumAvailable() for its size */
+	const uint8_t* getCurrent() const {
+		return data + pos;
+	}
+
+private:
+
+	void open(const std::string& file) {
+
+		const int fd = ::open(file.c_str(), O_RDONLY);
+		if (fd < 0) {throw StreamException("could not open file: " + file);}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) {::close(fd); throw StreamException("could not stat file: " + file);}
+		len = (size_t) st.st_size;
+
+		// mmap() refuses empty mappings. nothing to read anyways
+		if (len == 0) {::close(fd); return;}
+
+		void* ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (ptr == MAP_FAILED) {len = 0; throw StreamException("could not map file: " + file);}
+
+		// we read front to back: aggressive read-ahead, pages may be dropped once passed
+		madvise(ptr, len, MADV_SEQUENTIAL);
+		madvise(ptr, len, MADV_WILLNEED);
+
+		data = (const uint8_t*) ptr;
+
+	}
+
+	/** the mapped file */
+	const uint8_t* data;
+
+	/** the size of the mapped file */
+	size_t len;
+
+	/** the current read position */
+	size_t pos;
+
+};
+
+}
+
+#endif // K_STREAMS_MAPPEDFILEINPUTSTREAM_H
@@ -0,0 +1,277 @@
+#ifndef K_STREAMS_READAHEADINPUTSTREAM_H
+#define K_STREAMS_READAHEADINPUTSTREAM_H
+
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
+#include <atomic>
+
+#include "InputStream.h"
+#include "StreamException.h"
+
+namespace K {
+
+/** statistics of a ReadAheadInputStream */
+struct ReadAheadStats {
+
+	/** the number of buffers filled by the background thread */
+	uint64_t numFilled = 0;
+
+	/** how often the consumer had to wait for the next buffer */
+	uint64_t numConsumerWaits = 0;
+
+	/** the total time (in microseconds) the consumer spent waiting */
+	uint64_t consumerWaitUS = 0;
+
+	/** how often the background thread had to wait for a free buffer (consumer too slow) */
+	uint64_t numProducerWaits = 0;
+
+};
+
+/**
+ * decorator reading the underlying stream ahead on a background thread.
+ *
+ * the thread fills a small set (depth) of large buffers while the consumer
+ * processes previously read data. this way, I/O (or decompression) of the
+ * underlying stream overlaps with whatever the consumer does.
+ *
+ * buffers are handed over when they are full, at EOF, or as soon as the underlying
+ * stream delivers less than requested (e.g. a socket with nothing more available yet).
+ * thus slow sources do not block the consumer until a whole buffer has arrived.
+ *
+ * after construction, the underlying stream must only be used by this class.
+ * exceptions thrown by the underlying stream are re-thrown to the consumer
+ * once it reaches the corresponding position.
+ */
+class ReadAheadInputStream : public InputStream {
+
+private:
+
+	/** one buffer filled by the background thread */
+	struct Chunk {
+		std::vector<uint8_t> data;
+		size_t len = 0;
+		size_t pos = 0;
+	};
+
+public:
+
+	/**
+	 * ctor
+	 * @param is the stream to read ahead from
+	 * @param bufferSize the size of each buffer
+	 * @param depth the number of buffers (>= 2). at most depth-1 are filled ahead
+	 */
+	ReadAheadInputStream(InputStream& is, const size_t bufferSize = 1024*1024, const unsigned int depth = 4) :
+		is(is), chunks(depth) {
+
+		if (bufferSize == 0)	{throw StreamException("ReadAhead: bufferSize must be > 0");}
+		if (depth < 2)			{throw StreamException("ReadAhead: depth must be >= 2");}
+
+		for (Chunk& c : chunks) {c.data.resize(bufferSize); idle.push_back(&c);}
+		thread = std::thread(&ReadAheadInputStream::run, this);
+
+	}
+
+	/** dtor. stops the background thread (the underlying stream is not closed) */
+	~ReadAheadInputStream() {
+		stop();
+	}
+
+	/** no copy */
+	ReadAheadInputStream(const ReadAheadInputStream&) = delete;
+	ReadAheadInputStream& operator = (const ReadAheadInputStream&) = delete;
+
+	int read() override {
+		if (!next()) {return ERR_FAILED;}
+		return cur->data[cur->pos++];
+	}
+
+	ssize_t read(uint8_t* data, const size_t len) override {
+		const uint8_t* src;
+		const ssize_t num = borrow(src, len);
+		if (num > 0) {memcpy(data, src, num);}
+		return num;
+	}
+
+	/** borrow bytes directly from the current buffer (up to its end) */
+	ssize_t borrow(const uint8_t*& data, const size_t len) override {
+		if (!next()) {return ERR_FAILED;}
+		const size_t num = (len < cur->len - cur->pos) ? (len) : (cur->len - cur->pos);
+		data = cur->data.data() + cur->pos;
+		cur->pos += num;
+		return num;
+	}
+
+	void skip(const size_t n) override {
+		size_t left = n;
+		while (left) {
+			if (!next()) {throw StreamException("out of bounds while trying to skip some bytes");}
+			const size_t num = (left < cur->len - cur->pos) ? (left) : (cur->len - cur->pos);
+			cur->pos += num;
+			left -= num;
+		}
+	}
+
+	/** stop the background thread and close the underlying stream */
+	void close() override {
+		stop();
+		filled.clear();
+		cur = nullptr;
+		error = nullptr;
+		is.close();
+	}
+
+	/** get the current statistics */
+	ReadAheadStats getStats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return stats;
+	}
+
+private:
+
+	/** ensure the current buffer has unread data. false on EOF */
+	bool next() {
+
+		if (cur && cur->pos < cur->len) {return true;}
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		// hand the consumed buffer back to the background thread
+		if (cur) {
+			idle.push_back(cur);
+			cur = nullptr;
+			cvFree.notify_one();
+		}
+
+		// wait for the next one
+		if (filled.empty() && !done) {
+			++stats.numConsumerWaits;
+			const auto start = std::chrono::steady_clock::now();
+			cvFilled.wait(lock, [this] {return !filled.empty() || done;});
+			stats.consumerWaitUS += (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		if (filled.empty()) {
+			if (error) {std::exception_ptr e = error; error = nullptr; std::rethrow_exception(e);}
+			return false;
+		}
+
+		cur = filled.front();
+		filled.pop_front();
+		return true;
+
+	}
+
+	/** the background thread: fill free buffers until EOF */
+	void run() {
+
+		while (true) {
+
+			// wait for a free buffer
+			Chunk* c;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (idle.empty() && !stopped) {
+					++stats.numProducerWaits;
+					cvFree.wait(lock, [this] {return !idle.empty() || stopped.load();});
+				}
+				if (stopped) {break;}
+				c = idle.front();
+				idle.pop_front();
+			}
+
+			// fill it completely, until EOF, or until the stream has nothing more available right now
+			c->pos = 0;
+			c->len = 0;
+			bool eof = false;
+			try {
+				while (c->len < c->data.size() && !stopped) {
+					const size_t want = c->data.size() - c->len;
+					const ssize_t num = is.read(c->data.data() + c->len, want);
+					if (num == 0 || num == ERR_TRY_AGAIN) {
+						if (c->len) {break;}				// hand over what we have
+						waitForData(); continue;
+					}
+					if (num < 0) {eof = true; break;}
+					c->len += (size_t) num;
+					if ((size_t) num < want) {break;}		// short read: hand over what we have
+				}
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				error = std::current_exception();
+				eof = true;
+			}
+
+			// publish
+			std::lock_guard<std::mutex> lock(mutex);
+			if (c->len) {filled.push_back(c); ++stats.numFilled;} else {idle.push_back(c);}
+			if (eof) {done = true;}
+			cvFilled.notify_one();
+			if (eof) {break;}
+
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+		cvFilled.notify_one();
+
+	}
+
+	/** nothing available right now (but maybe later): block for a moment instead of spinning. stop() wakes us up */
+	void waitForData() {
+		std::unique_lock<std::mutex> lock(mutex);
+		cvFree.wait_for(lock, std::chrono::milliseconds(1), [this] {return stopped.load();});
+	}
+
+	/** stop and join the background thread */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+			cvFree.notify_one();
+		}
+		if (thread.joinable()) {thread.join();}
+	}
+
+
+	/** the stream to read from (background thread only) */
+	InputStream& is;
+
+	/** all buffers */
+	std::vector<Chunk> chunks;
+
+	/** buffers ready to be filled / to be consumed (in order) */
+	std::deque<Chunk*> idle;
+	std::deque<Chunk*> filled;
+
+	/** the buffer currently consumed */
+	Chunk* cur = nullptr;
+
+	/** the background thread reached EOF (or an error) */
+	bool done = false;
+
+	/** the background thread is asked to stop */
+	std::atomic<bool> stopped{false};
+
+	/** error thrown by the underlying stream */
+	std::exception_ptr error;
+
+	ReadAheadStats stats;
+
+	mutable std::mutex mutex;
+	std::condition_variable cvFree;
+	std::condition_variable cvFilled;
+
+	std::thread thread;
+
+};
+
+}
+
+#endif // K_STREAMS_READAHEADINPUTSTREAM_H
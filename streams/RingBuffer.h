@@ -0,0 +1,359 @@
+#ifndef K_STREAMS_RINGBUFFER_H
+#define K_STREAMS_RINGBUFFER_H
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../Exception.h"
+
+
+namespace K {
+
+	/**
+	 * FIFO ring buffer to store elements of a given type.
+	 *
+	 * in contrast to Buffer, consumed entries are never reclaimed by moving
+	 * the remaining ones to the front. read- and write-position simply wrap
+	 * around within a power-of-two sized region. memory is only copied
+	 * when the buffer has to grow.
+	 *
+	 * as the used region may wrap around, it is described by (up to) two
+	 * spans. see getReadSpans() and getWriteSpans().
+	 *
+	 * in mirrored mode (linux only), the region is mapped twice, back to back,
+	 * into the virtual address space. thus, the used region (and the free region)
+	 * is always contiguous and getData() / getFirstFree() may be used just like
+	 * with Buffer. the capacity is then a multiple of the page size.
+	 *
+	 * only use this buffer with trivially copyable types.
+	 */
+	template <typename T> class RingBuffer {
+
+	public:
+
+		/** one contiguous part of the buffer */
+		struct Span {
+			T* data;
+			size_t len;
+			Span() : data(nullptr), len(0) {;}
+			Span(T* data, const size_t len) : data(data), len(len) {;}
+		};
+
+	private:
+
+		/** the internal buffer */
+		T* _buf;
+
+		/** the total number of slots within the buffer. always a power of two */
+		size_t totalEntries;
+
+		/** totalEntries - 1 */
+		size_t mask;
+
+		/** (unwrapped) index of the oldest entry */
+		size_t readPos;
+
+		/** (unwrapped) index of the next free slot */
+		size_t writePos;
+
+		/** map the buffer twice into the address space? */
+		const bool mirrored;
+
+	public:
+
+		/**
+		 * ctor
+		 * @param minEntries allocate space for (at least) this number of entries
+		 * @param mirrored mirror the memory to always provide contiguous regions
+		 */
+		RingBuffer(const size_t minEntries = 0, const bool mirrored = false) :
+			_buf(nullptr), totalEntries(0), mask(0), readPos(0), writePos(0), mirrored(mirrored) {
+
+			#ifndef __linux__
+			if (mirrored) {throw Exception("mirrored RingBuffer is only supported on linux");}
+			#endif
+
+			if (minEntries) {ensureMinSize(minEntries);}
+
+		}
+
+		/** dtor */
+		~RingBuffer() {
+			release(_buf, totalEntries);
+			_buf = nullptr;
+		}
+
+		/** no copy */
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator = (const RingBuffer&) = delete;
+
+
+		/** add the given elements */
+		void add(const T* elems, const size_t numElems) {
+			if (numElems == 0) {return;}
+			ensureSpace(numElems);
+			Span s1, s2;
+			getWriteSpans(s1, s2);
+			const size_t n1 = (numElems < s1.len) ? (numElems) : (s1.len);
+			memcpy(s1.data, elems, n1 * sizeof(T));
+			memcpy(s2.data, elems + n1, (numElems - n1) * sizeof(T));
+			writePos += numElems;
+		}
+
+		/** add the given element */
+		void add(T elem) {
+			ensureSpace(1);
+			_buf[writePos & mask] = elem;
+			++writePos;
+		}
+
+		/** get the first entry from the buffer and remove it */
+		T get() {
+			T ret = _buf[readPos & mask];
+			remove(1);
+			return ret;
+		}
+
+		/**
+		 * copy (at most) the given number of entries into dst and remove them.
+		 * returns the number of copied entries.
+		 */
+		size_t get(T* dst, const size_t numElems) {
+			const size_t num = (numElems < getNumUsed()) ? (numElems) : (getNumUsed());
+			if (num == 0) {return 0;}
+			Span s1, s2;
+			getReadSpans(s1, s2);
+			const size_t n1 = (num < s1.len) ? (num) : (s1.len);
+			memcpy(dst, s1.data, n1 * sizeof(T));
+			memcpy(dst + n1, s2.data, (num - n1) * sizeof(T));
+			remove(num);
+			return num;
+		}
+
+		/** peek into the next entry */
+		T peek() const {
+			return _buf[readPos & mask];
+		}
+
+		/**
+		 * remove the given number of entries from
+		 * the front of the buffer
+		 */
+		void remove(const size_t numEntries) {
+			if (getNumUsed() < numEntries) { throw Exception("out of bounds during RingBuffer.remove()"); }
+			readPos += numEntries;
+		}
+
+		/**
+		 * mark the given number of entries as written, e.g.
+		 * after writing to the region(s) provided by getWriteSpans()
+		 */
+		void commit(const size_t numEntries) {
+			if (getNumFree() < numEntries) {throw Exception("out of bounds during RingBuffer.commit()");}
+			writePos += numEntries;
+		}
+
+		/** get the number of used entries */
+		size_t getNumUsed() const {
+			return writePos - readPos;
+		}
+
+		/** is the buffer currently empty? */
+		bool empty() const {
+			return writePos == readPos;
+		}
+
+		/** get the number of free entries available for writing */
+		size_t getNumFree() const {
+			return totalEntries - getNumUsed();
+		}
+
+		/**
+		 * get the used region as (up to) two spans.
+		 * the second span is empty, if the region does not wrap around
+		 */
+		void getReadSpans(Span& first, Span& second) const {
+			const size_t used = getNumUsed();
+			const size_t start = readPos & mask;
+			const size_t len1 = (mirrored || start + used <= totalEntries) ? (used) : (totalEntries - start);
+			first = Span(_buf + start, len1);
+			second = Span(_buf, used - len1);
+		}
+
+		/**
+		 * get the free region as (up to) two spans.
+		 * the second span is empty, if the region does not wrap around
+		 */
+		void getWriteSpans(Span& first, Span& second) const {
+			const size_t free = getNumFree();
+			const size_t start = writePos & mask;
+			const size_t len1 = (mirrored || start + free <= totalEntries) ? (free) : (totalEntries - start);
+			first = Span(_buf + start, len1);
+			second = Span(_buf, free - len1);
+		}
+
+		/** get the first contiguous part of the used region */
+		Span getReadSpan() const {
+			Span s1, s2;
+			getReadSpans(s1, s2);
+			return s1;
+		}
+
+		/** get the first contiguous part of the free region */
+		Span getWriteSpan() const {
+			Span s1, s2;
+			getWriteSpans(s1, s2);
+			return s1;
+		}
+
+		/**
+		 * get a pointer to the oldest entry.
+		 * only the first getReadSpan().len entries are contiguous,
+		 * in mirrored mode these are all getNumUsed() entries
+		 */
+		T* getData() const {
+			return _buf + (readPos & mask);
+		}
+
+		/**
+		 * get a pointer to the first free entry.
+		 * only the first getWriteSpan().len entries are contiguous,
+		 * in mirrored mode these are all getNumFree() entries
+		 */
+		T* getFirstFree() const {
+			return _buf + (writePos & mask);
+		}
+
+		/** is the buffer mirrored? */
+		bool isMirrored() const {
+			return mirrored;
+		}
+
+		/** get the memory consumption (in bytes) */
+		size_t getMemoryConsumption() const {
+			return totalEntries * sizeof(T);
+		}
+
+		/** get the number of allocated entries */
+		size_t getSize() const {
+			return totalEntries;
+		}
+
+		/**
+		 * ensure the buffer can hold at least the given number of elements.
+		 * if the buffer is smaller, it will grow to the next power of two.
+		 * the contents are kept.
+		 */
+		void ensureMinSize(const size_t numElements) {
+
+			// already large enough?
+			if (totalEntries >= numElements) {return;}
+
+			// next power of two (and page multiple when mirrored)
+			size_t newSize = (mirrored) ? (getPageSize() / sizeof(T)) : (16);
+			while (newSize < numElements) {newSize *= 2;}
+
+			// allocate and move the used region to the front of the new buffer
+			T* newBuf = allocate(newSize);
+			const size_t used = getNumUsed();
+			if (used) {
+				Span s1, s2;
+				getReadSpans(s1, s2);
+				memcpy(newBuf, s1.data, s1.len * sizeof(T));
+				memcpy(newBuf + s1.len, s2.data, s2.len * sizeof(T));
+			}
+			release(_buf, totalEntries);
+
+			_buf = newBuf;
+			totalEntries = newSize;
+			mask = newSize - 1;
+			readPos = 0;
+			writePos = used;
+
+		}
+
+		/** access elements by array index (relative to the oldest entry) */
+		T& operator[] (const size_t index) {
+			return _buf[(readPos + index) & mask];
+		}
+
+		/**
+		 * clear the buffer.
+		 * the allocated memory will not be changed at all.
+		 */
+		void clear() {
+			readPos = 0;
+			writePos = 0;
+		}
+
+	private:
+
+		/** ensure the buffer can pack the given number of additional elements */
+		void ensureSpace(const size_t numElems) {
+			if (getNumFree() >= numElems) {return;}
+			ensureMinSize(getNumUsed() + numElems);
+		}
+
+		static size_t getPageSize() {
+			#ifdef __linux__
+			return (size_t) sysconf(_SC_PAGESIZE);
+			#else
+			return 4096;
+			#endif
+		}
+
+		/** allocate memory for the given number of entries */
+		T* allocate(const size_t numElements) {
+
+			if (!mirrored) {
+				T* ptr = (T*) malloc(numElements * sizeof(T));
+				if (!ptr) {throw Exception("out of memory");}
+				return ptr;
+			}
+
+			#ifdef __linux__
+
+			const size_t bytes = numElements * sizeof(T);
+			if (bytes % getPageSize() != 0) {throw Exception("mirrored RingBuffer: element size does not match the page size");}
+
+			// anonymous memory-file used for both mappings
+			const int fd = (int) syscall(SYS_memfd_create, "K::RingBuffer", 0);
+			if (fd < 0) {throw Exception("mirrored RingBuffer: memfd_create() failed");}
+			if (ftruncate(fd, (off_t) bytes) != 0) {::close(fd); throw Exception("mirrored RingBuffer: ftruncate() failed");}
+
+			// reserve twice the address space, then map the file into both halves
+			uint8_t* base = (uint8_t*) mmap(nullptr, 2*bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (base == MAP_FAILED) {::close(fd); throw Exception("mirrored RingBuffer: mmap() failed");}
+			void* m1 = mmap(base,		bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			void* m2 = mmap(base+bytes,	bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+			::close(fd);
+			if (m1 == MAP_FAILED || m2 == MAP_FAILED) {munmap(base, 2*bytes); throw Exception("mirrored RingBuffer: mmap() failed");}
+			return (T*) base;
+
+			#else
+			throw Exception("mirrored RingBuffer is only supported on linux");
+			#endif
+
+		}
+
+		/** free memory obtained from allocate() */
+		void release(T* ptr, const size_t numElements) {
+			if (!ptr) {return;}
+			if (!mirrored) {free(ptr); return;}
+			#ifdef __linux__
+			munmap(ptr, 2 * numElements * sizeof(T));
+			#endif
+		}
+
+	};
+
+}
+
+#endif // K_STREAMS_RINGBUFFER_H
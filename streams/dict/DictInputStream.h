@@ -18,36 +18,37 @@ namespace K {
 		std::string lastEntry;
 		std::string readBuf;
 
+		/** the number of bytes within readBuf that have already been sent */
+		size_t readPos;
+
 	public:
 
 		/** ctor */
-		DictInputStream(InputStream* is) : is(is) {
+		DictInputStream(InputStream* is) : is(is), readPos(0) {
 
 		}
 
-		int read() {
-
-			// does the buffer contain some bytes to send?
-			if (readBuf.empty()) {
+		int read() override {
 
-				// try to get the next word by its index
-				if (!getNextWord()) {return -1;}
+			// ensure we have something to read
+			if (!fillIfNeeded()) {return -1;}
 
-				if (!lastEntry.empty()) {
-					std::string next = lastEntry + readBuf[0];
-					std::cout << "new: " << next << std::endl;
-					dictDecomp.add(next);
-				}
+			// send the buffer's next byte
+			return (uint8_t) readBuf[readPos++];
 
-				lastEntry = readBuf;
+		}
 
-			}
+		ssize_t read(uint8_t* data, const size_t len) override {
 
-			// send the buffer's next byte and remove it from the buffer
-			int out = readBuf[0];
-			readBuf = readBuf.substr(1);
+			// ensure we have something to read
+			if (!fillIfNeeded()) {return -1;}
 
-			return out;
+			// send (a part of) the current word
+			const size_t avail = readBuf.size() - readPos;
+			const size_t toRead = (len < avail) ? (len) : (avail);
+			memcpy(data, readBuf.data() + readPos, toRead);
+			readPos += toRead;
+			return toRead;
 
 		}
 
@@ -63,6 +64,26 @@ namespace K {
 
 	private:
 
+		/** ensure the buffer contains some bytes to send */
+		bool fillIfNeeded() {
+
+			// does the buffer still contain some bytes to send?
+			if (readPos < readBuf.size()) {return true;}
+
+			// try to get the next word by its index
+			if (!getNextWord()) {return false;}
+			readPos = 0;
+
+			if (!lastEntry.empty()) {
+				std::string next = lastEntry + readBuf[0];
+				dictDecomp.add(next);
+			}
+
+			lastEntry = readBuf;
+			return true;
+
+		}
+
 		/** read the next index from the underlying input stream */
 		int32_t readIdx() {
 			return DictHelper::readVarLength(is);
@@ -0,0 +1,235 @@
+#ifndef K_STREAMS_LZ4_LZ4FRAME_H
+#define K_STREAMS_LZ4_LZ4FRAME_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace K {
+
+	/**
+	 * xxHash32 as used by the LZ4 frame format
+	 * for header-, block- and content-checksums.
+	 * supports both, one-shot and streaming usage.
+	 */
+	class XXH32 {
+
+	private:
+
+		static constexpr uint32_t P1 = 2654435761U;
+		static constexpr uint32_t P2 = 2246822519U;
+		static constexpr uint32_t P3 = 3266489917U;
+		static constexpr uint32_t P4 =  668265263U;
+		static constexpr uint32_t P5 =  374761393U;
+
+		uint32_t v1, v2, v3, v4;
+		uint32_t seed;
+		uint64_t totalLen;
+
+		/** not yet processed bytes (less than one 16 byte stripe) */
+		uint8_t mem[16];
+		uint32_t memSize;
+
+	public:
+
+		/** ctor */
+		XXH32(const uint32_t seed = 0) {
+			reset(seed);
+		}
+
+		/** restart hashing */
+		void reset(const uint32_t seed = 0) {
+			this->seed = seed;
+			v1 = seed + P1 + P2;
+			v2 = seed + P2;
+			v3 = seed;
+			v4 = seed - P1;
+			totalLen = 0;
+			memSize = 0;
+		}
+
+		/** append the given data */
+		void update(const uint8_t* data, size_t len) {
+
+			totalLen += len;
+
+			// complete the pending stripe first
+			if (memSize) {
+				const uint32_t toCopy = (len < 16 - memSize) ? ((uint32_t) len) : (16 - memSize);
+				memcpy(mem + memSize, data, toCopy);
+				memSize += toCopy;
+				data += toCopy;
+				len -= toCopy;
+				if (memSize < 16) {return;}
+				stripe(mem);
+				memSize = 0;
+			}
+
+			// all complete stripes
+			while (len >= 16) {
+				stripe(data);
+				data += 16;
+				len -= 16;
+			}
+
+			// keep the rest for later
+			memcpy(mem, data, len);
+			memSize = (uint32_t) len;
+
+		}
+
+		/** get the hash of all data appended so far */
+		uint32_t digest() const {
+
+			uint32_t h;
+			if (totalLen >= 16) {
+				h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			} else {
+				h = seed + P5;
+			}
+			h += (uint32_t) totalLen;
+
+			const uint8_t* p = mem;
+			const uint8_t* end = mem + memSize;
+			while (p + 4 <= end) {
+				h += read32(p) * P3;
+				h = rotl(h, 17) * P4;
+				p += 4;
+			}
+			while (p < end) {
+				h += (*p) * P5;
+				h = rotl(h, 11) * P1;
+				++p;
+			}
+
+			h ^= h >> 15;
+			h *= P2;
+			h ^= h >> 13;
+			h *= P3;
+			h ^= h >> 16;
+			return h;
+
+		}
+
+		/** one-shot hashing */
+		static uint32_t hash(const uint8_t* data, const size_t len, const uint32_t seed = 0) {
+			XXH32 x(seed);
+			x.update(data, len);
+			return x.digest();
+		}
+
+	private:
+
+		static inline uint32_t rotl(const uint32_t x, const int r) {
+			return (x << r) | (x >> (32 - r));
+		}
+
+		static inline uint32_t round(uint32_t v, const uint32_t input) {
+			v += input * P2;
+			v = rotl(v, 13);
+			return v * P1;
+		}
+
+		/** little endian read */
+		static inline uint32_t read32(const uint8_t* p) {
+			return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+		}
+
+		inline void stripe(const uint8_t* p) {
+			v1 = round(v1, read32(p+0));
+			v2 = round(v2, read32(p+4));
+			v3 = round(v3, read32(p+8));
+			v4 = round(v4, read32(p+12));
+		}
+
+	};
+
+
+	/**
+	 * constants and helpers for the (standard) LZ4 frame format
+	 * see: https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+	 */
+	struct LZ4Frame {
+
+		/** magic number starting each frame */
+		static constexpr uint32_t MAGIC = 0x184D2204;
+
+		/** magic number of skippable frames (lower 4 bits are user-defined) */
+		static constexpr uint32_t MAGIC_SKIPPABLE = 0x184D2A50;
+
+		/**
+		 * tag at the very end of the (skippable) block index frame written
+		 * behind the LZ4 frame, see LZ4FrameSettings::blockIndex.
+		 *
+		 * layout: [MAGIC_SKIPPABLE][u32 payload size]
+		 *         numBlocks * [u64 uncompressed offset][u64 compressed offset]
+		 *         [u64 content size][u32 numBlocks][u32 INDEX_TAG]
+		 *
+		 * compressed offsets are relative to the frame's magic and point
+		 * to the block's size field. all values are little endian.
+		 */
+		static constexpr uint32_t INDEX_TAG = 0x58444E49;		// "INDX"
+
+		/** size of the block index frame's fixed trailer */
+		static constexpr size_t INDEX_TRAILER_SIZE = 8 + 4 + 4;
+
+		/** size of one block index entry */
+		static constexpr size_t INDEX_ENTRY_SIZE = 8 + 8;
+
+		/** block-size marker: highest bit set -> block is stored uncompressed */
+		static constexpr uint32_t BLOCK_UNCOMPRESSED = 0x80000000;
+
+		/** FLG bits */
+		static constexpr uint8_t FLG_VERSION = 0x40;
+		static constexpr uint8_t FLG_BLOCK_INDEPENDENT = 0x20;
+		static constexpr uint8_t FLG_BLOCK_CHECKSUM = 0x10;
+		static constexpr uint8_t FLG_CONTENT_SIZE = 0x08;
+		static constexpr uint8_t FLG_CONTENT_CHECKSUM = 0x04;
+		static constexpr uint8_t FLG_DICT_ID = 0x01;
+
+		/** supported maximum block sizes */
+		enum class BlockSize : uint8_t {
+			KB_64 = 4,
+			KB_256 = 5,
+			MB_1 = 6,
+			MB_4 = 7,
+		};
+
+		/** get the number of bytes for the given block-size id (4-7) */
+		static uint32_t getBlockBytes(const uint8_t id) {
+			return 1u << (8 + 2 * id);
+		}
+
+		/** write a 32 bit little endian value */
+		static inline void write32(uint8_t* dst, const uint32_t val) {
+			dst[0] = (uint8_t) (val >>  0);
+			dst[1] = (uint8_t) (val >>  8);
+			dst[2] = (uint8_t) (val >> 16);
+			dst[3] = (uint8_t) (val >> 24);
+		}
+
+		/** read a 32 bit little endian value */
+		static inline uint32_t read32(const uint8_t* src) {
+			return (uint32_t) src[0] | ((uint32_t) src[1] << 8) | ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+		}
+
+		/** write a 64 bit little endian value */
+		static inline void write64(uint8_t* dst, const uint64_t val) {
+			write32(dst+0, (uint32_t) (val >>  0));
+			write32(dst+4, (uint32_t) (val >> 32));
+		}
+
+		/** read a 64 bit little endian value */
+		static inline uint64_t read64(const uint8_t* src) {
+			return (uint64_t) read32(src) | ((uint64_t) read32(src+4) << 32);
+		}
+
+		/** the header checksum byte for the given frame descriptor (FLG ...) */
+		static inline uint8_t getHeaderChecksum(const uint8_t* descriptor, const size_t len) {
+			return (uint8_t) ((XXH32::hash(descriptor, len) >> 8) & 0xFF);
+		}
+
+	};
+
+}
+
+#endif // K_STREAMS_LZ4_LZ4FRAME_H
@@ -18,6 +18,9 @@ namespace K {
 		//std::string curWord;
 		std::vector<uint8_t> curWord;
 
+		/** the number of bytes within curWord that have already been sent */
+		size_t curPos = 0;
+
 		int debug = 0;
 
 	public:
@@ -30,15 +33,27 @@ namespace K {
 		int read() override {
 
 			// buffer empty? -> fetch next word
-			if (curWord.empty()) {
+			if (curPos >= curWord.size()) {
 				if (!getNextWord()) {return -1;}
 			}
 
-			uint8_t out = curWord[0];
-			//curWord = curWord.substr(1);
-			curWord.erase(curWord.begin());
+			return curWord[curPos++];
+
+		}
+
+		ssize_t read(uint8_t* data, const size_t len) override {
+
+			// buffer empty? -> fetch next word
+			if (curPos >= curWord.size()) {
+				if (!getNextWord()) {return -1;}
+			}
 
-			return out;
+			// send (a part of) the current word
+			const size_t avail = curWord.size() - curPos;
+			const size_t toRead = (len < avail) ? (len) : (avail);
+			memcpy(data, curWord.data() + curPos, toRead);
+			curPos += toRead;
+			return toRead;
 
 		}
 
@@ -86,6 +101,7 @@ namespace K {
 
 			}
 
+			curPos = 0;
 			return true;
 
 		}
@@ -0,0 +1,163 @@
+
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/Bitmap.h"
+#include "../../cv/filter/Dilate.h"
+
+#include <vector>
+
+using namespace K;
+using namespace K::CV;
+
+static Bitmap getRandomBitmap(const int w, const int h, const int border = 0) {
+	Bitmap b(w, h);
+	const ImageChannel img = TestHelper::getPatternImage(w, h, 11);
+	for (int y = border; y < h - border; ++y) {
+		for (int x = border; x < w - border; ++x) {
+			if (img.get(x, y) == 0) {b.set(x, y);}
+		}
+	}
+	return b;
+}
+
+TEST(Bitmap, access) {
+
+	// several words per row, last word partially used
+	Bitmap b(130, 3);
+	ASSERT_EQ(3, b.getStride());
+	ASSERT_FALSE(b.any());
+
+	b.set(0, 0);
+	b.set(63, 1);
+	b.set(64, 1);
+	b.set(Point2i(129, 2));
+	ASSERT_TRUE(b.isSet(63, 1));
+	ASSERT_TRUE(b.isSet(64, 1));
+	ASSERT_FALSE(b.isSet(65, 1));
+	ASSERT_TRUE(b.get(129, 2));
+	ASSERT_EQ(4u, b.count());
+
+	b.clear(63, 1);
+	ASSERT_FALSE(b.isSet(63, 1));
+	ASSERT_EQ(3u, b.count());
+
+	ASSERT_THROW(b.set(130, 0), Exception);
+
+	// the padding is never set
+	b.setAll(true);
+	ASSERT_EQ(130u * 3u, b.count());
+	ASSERT_EQ(0u, (~b).count());
+
+	// from image
+	ImageChannel img(3, 1);
+	img << 0.2f, 0.8f, 0.5f;
+	const Bitmap bi(img, 0.5f);
+	ASSERT_FALSE(bi.isSet(0, 0));
+	ASSERT_TRUE(bi.isSet(1, 0));
+	ASSERT_FALSE(bi.isSet(2, 0));
+
+}
+
+TEST(Bitmap, scan) {
+
+	const Bitmap b = getRandomBitmap(150, 20);
+
+	// findNext and forEachSet visit the same pixels as a per-pixel scan
+	std::vector<Point2i> exp;
+	for (int y = 0; y < b.getHeight(); ++y) {
+		for (int x = 0; x < b.getWidth(); ++x) {
+			if (b.isSet(x, y)) {exp.push_back(Point2i(x, y));}
+		}
+	}
+	ASSERT_EQ(exp.size(), b.count());
+
+	std::vector<Point2i> found;
+	int x = 0;
+	int y = 0;
+	while (b.findNext(x, y)) {found.push_back(Point2i(x, y)); ++x;}
+	ASSERT_EQ(exp, found);
+
+	std::vector<Point2i> each;
+	b.forEachSet([&] (const int x, const int y) {each.push_back(Point2i(x, y));});
+	ASSERT_EQ(exp, each);
+
+	Bitmap empty(70, 4);
+	x = 0; y = 0;
+	ASSERT_FALSE(empty.findNext(x, y));
+
+}
+
+TEST(Bitmap, logic) {
+
+	const Bitmap a = getRandomBitmap(100, 9);
+	Bitmap b(100, 9);
+	for (int i = 0; i < 9; ++i) {b.set(i * 11, i); b.set(99 - i, i);}
+
+	const Bitmap rAnd = a & b;
+	const Bitmap rOr = a | b;
+	const Bitmap rXor = a ^ b;
+	const Bitmap rNot = ~a;
+	for (int y = 0; y < 9; ++y) {
+		for (int x = 0; x < 100; ++x) {
+			ASSERT_EQ(a.isSet(x,y) && b.isSet(x,y), rAnd.isSet(x,y));
+			ASSERT_EQ(a.isSet(x,y) || b.isSet(x,y), rOr.isSet(x,y));
+			ASSERT_EQ(a.isSet(x,y) != b.isSet(x,y), rXor.isSet(x,y));
+			ASSERT_EQ(!a.isSet(x,y), rNot.isSet(x,y));
+		}
+	}
+	ASSERT_EQ(a.count() + rNot.count(), 900u);
+	ASSERT_THROW(a & Bitmap(99, 9), Exception);
+
+}
+
+TEST(Bitmap, dilateMatchesImageDilate) {
+
+	// set pixels keep a distance to the border: the image version skips pixels near the border
+	const Bitmap b = getRandomBitmap(140, 30, 3);
+	ImageChannel img(140, 30);
+	img.zero();
+	b.forEachSet([&] (const int x, const int y) {img.set(x, y, 1.0f);});
+
+	for (const Dilate::Shape shape : {Dilate::SQUARE_45, Dilate::CIRCLE}) {
+		for (int r = 1; r <= 3; ++r) {
+			const Bitmap res = Dilate::apply(b, r, shape);
+			const Bitmap exp(Dilate::apply(img, r, shape), 0.5f);
+			ASSERT_EQ(exp, res) << "radius " << r;
+		}
+	}
+
+}
+
+TEST(Bitmap, dilateEmptyElement) {
+
+	// no pixel within any row of the element
+	const Bitmap b = getRandomBitmap(70, 9);
+	ASSERT_TRUE(b.any());
+	ASSERT_EQ(0u, b.dilate({-1}).count());
+	ASSERT_EQ(0u, b.dilate({-1, -1, -1}).count());
+
+}
+
+TEST(Bitmap, erode) {
+
+	const Bitmap b = ~getRandomBitmap(90, 25);
+	const std::vector<int> elem = Dilate::getElement(2, Dilate::CIRCLE);
+	const Bitmap res = Dilate::erode(b, 2, Dilate::CIRCLE);
+
+	// brute force: all pixels of the element (within the bitmap) must be set
+	for (int y = 0; y < 25; ++y) {
+		for (int x = 0; x < 90; ++x) {
+			bool all = true;
+			for (int dy = -2; dy <= 2; ++dy) {
+				for (int dx = -elem[2+dy]; dx <= elem[2+dy]; ++dx) {
+					if (b.isWithin(x+dx, y+dy) && !b.isSet(x+dx, y+dy)) {all = false;}
+				}
+			}
+			ASSERT_EQ(all, res.isSet(x, y)) << x << ":" << y;
+		}
+	}
+
+}
+
+#endif
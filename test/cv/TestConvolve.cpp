@@ -49,6 +49,55 @@ TEST(Convolve, Gauss2D) {
 
 }
 
+/** reference: the generic (per-pixel, bound-checked) implementation */
+static ImageChannel convolveRef(const ImageChannel& src, const Kernel& k, const bool normalize) {
+	ImageChannel dst(src.getWidth(), src.getHeight());
+	Convolve::convolve<ImageChannel>(src, dst, k, normalize);
+	return dst;
+}
+
+static void assertConvolveNear(const ImageChannel& a, const ImageChannel& b) {
+	ASSERT_EQ(a.getWidth(), b.getWidth());
+	ASSERT_EQ(a.getHeight(), b.getHeight());
+	for (int i = 0; i < a.getWidth()*a.getHeight(); ++i) {
+		ASSERT_NEAR(a.getData()[i], b.getData()[i], 1e-5);
+	}
+}
+
+TEST(Convolve, fastPathMatchesGeneric) {
+
+	Kernel kH = KernelFactory::gauss1D(2.0);
+	Kernel kV = KernelFactory::gauss1D(1.5); kV.tilt();
+	Kernel k2 = KernelFactory::gauss2D(1.0, 5);
+	float sobel[9] = {-1,0,1, -2,0,2, -1,0,1};
+	Kernel kS(sobel, 3, 3);
+
+	// including images smaller than the kernel and widths not matching the SIMD size
+	const int sizes[][2] = {{1,1}, {3,2}, {11,7}, {13,13}, {37,29}, {130,300}};
+
+	for (const auto& s : sizes) {
+		const ImageChannel img = TestHelper::getPatternImage(s[0], s[1]);
+		for (const bool norm : {true, false}) {
+			assertConvolveNear(convolveRef(img, kH, norm), Convolve::run(img, kH, norm));
+			assertConvolveNear(convolveRef(img, kV, norm), Convolve::run(img, kV, norm));
+			assertConvolveNear(convolveRef(img, k2, norm), Convolve::run(img, k2, norm));
+			assertConvolveNear(convolveRef(img, kS, norm), Convolve::run(img, kS, norm));
+		}
+	}
+
+}
+
+TEST(Convolve, separableMatchesTwoPasses) {
+
+	Kernel kH = KernelFactory::gauss1D(3.0);
+	Kernel kV = KernelFactory::gauss1D(1.0); kV.tilt();
+
+	const ImageChannel img = TestHelper::getPatternImage(257, 400);
+	const ImageChannel ref = convolveRef(convolveRef(img, kH, true), kV, true);
+	assertConvolveNear(ref, ConvolveSeparable::run(img, kH, kV));
+
+}
+
 #endif
 
 
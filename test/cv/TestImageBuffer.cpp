@@ -0,0 +1,164 @@
+
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/ImageBuffer.h"
+#include "../../cv/filter/Minimum.h"
+#include "../../cv/filter/Maximum.h"
+#include "../../cv/filter/Threshold.h"
+
+#include <cmath>
+
+using namespace K;
+using namespace K::CV;
+
+TEST(ImageBuffer, alignedRows) {
+
+	ImageU8 u8(13, 5);
+	ImageU16 u16(40, 3);
+	ImageF32 f32(17, 2);
+	ASSERT_EQ(64, u8.getStride());
+	ASSERT_EQ(64, u16.getStride());
+	ASSERT_EQ(32, f32.getStride());
+	for (int y = 0; y < 5; ++y) {ASSERT_EQ(0u, ((size_t) u8.getRow(y)) % 64);}
+	for (int y = 0; y < 3; ++y) {ASSERT_EQ(0u, ((size_t) u16.getRow(y)) % 64);}
+	ASSERT_EQ(0, u8.get(12, 4));
+
+}
+
+TEST(ImageBuffer, regionSharesPixels) {
+
+	ImageU8 img(10, 8);
+	img.set(3, 4, 42);
+
+	const ImageU8 reg = img.region(2, 3, 6, 7);
+	ASSERT_EQ(4, reg.getWidth());
+	ASSERT_EQ(4, reg.getHeight());
+	ASSERT_TRUE(reg.sharesWith(img));
+	ASSERT_EQ(42, reg.get(1, 1));
+
+	// writes are visible in both directions
+	reg.set(0, 0, 7);
+	ASSERT_EQ(7, img.get(2, 3));
+
+	// nested regions
+	ASSERT_EQ(42, reg.region(1, 1, 3, 3).get(0, 0));
+
+	// the original outlives the view (and vice versa)
+	ImageU8 keep;
+	{
+		ImageU8 tmp(4, 4);
+		tmp.set(1, 1, 9);
+		keep = tmp.region(1, 1, 3, 3);
+	}
+	ASSERT_EQ(9, keep.get(0, 0));
+
+	// clone: deep copy
+	const ImageU8 copy = reg.clone();
+	ASSERT_FALSE(copy.sharesWith(img));
+	ASSERT_EQ(reg, copy);
+	img.set(3, 4, 0);
+	ASSERT_EQ(42, copy.get(1, 1));
+
+}
+
+TEST(ImageBuffer, wrapChannel) {
+
+	ImageChannel img = TestHelper::getPatternImage(9, 7);
+	const ImageF32 view = ImageF32::wrap(img.getData(), img.getWidth(), img.getHeight(), img.getWidth());
+	ASSERT_TRUE(view.isContiguous());
+	view.region(2, 2, 5, 5).setAll(0.5f);
+	ASSERT_EQ(0.5f, img.get(4, 3));
+	ASSERT_EQ(img, view.toChannel());
+
+}
+
+TEST(ImageBuffer, convert) {
+
+	const ImageChannel img = TestHelper::getPatternImage(31, 9);
+
+	const ImageU8 u8 = ImageU8::fromChannel(img);
+	for (int i = 0; i < 31*9; ++i) {
+		const int x = i % 31;
+		const int y = i / 31;
+		ASSERT_EQ((i * 7919) % 256, u8.get(x, y));
+	}
+	ASSERT_EQ(img, u8.toChannel());
+
+	const ImageChannel u16 = ImageU16::fromChannel(img).toChannel();
+	const ImageChannel f16 = ImageF16::fromChannel(img).toChannel();
+	for (int i = 0; i < 31*9; ++i) {
+		ASSERT_NEAR(img.getData()[i], u16.getData()[i], 1.0 / 65535);
+		ASSERT_NEAR(img.getData()[i], f16.getData()[i], 1.0 / 2048);
+	}
+
+	// clamping
+	ImageChannel out(3, 1);
+	out << -1, 0.5f, 2;
+	const ImageU8 c = ImageU8::fromChannel(out);
+	ASSERT_EQ(0, c.get(0, 0));
+	ASSERT_EQ(128, c.get(1, 0));
+	ASSERT_EQ(255, c.get(2, 0));
+
+}
+
+TEST(ImageBuffer, float16) {
+
+	// all non-nan halfs survive the round-trip
+	for (uint32_t h = 0; h < 65536; ++h) {
+		const float f = Float16::toFloat((uint16_t) h);
+		if (std::isnan(f)) {ASSERT_TRUE(std::isnan(Float16::toFloat(Float16::fromFloat(f)))); continue;}
+		ASSERT_EQ(h, Float16::fromFloat(f));
+	}
+
+	ASSERT_EQ(1.0f, (float) Float16(1.0f));
+	ASSERT_EQ(65504.0f, (float) Float16(65504.0f));
+	ASSERT_TRUE(std::isinf((float) Float16(1e6f)));
+	ASSERT_EQ(0x3C00, Float16(1.0f + 1.0f / 4096).bits);			// tie -> even
+	ASSERT_EQ(0x3C01, Float16(1.0f + 3.0f / 4096).bits);			// tie -> even (up)
+	ASSERT_EQ(0x0001, Float16(std::ldexp(1.0f, -24)).bits);			// smallest subnormal
+
+	// the bulk (F16C) conversion matches the scalar one
+	std::vector<float> src(1003);
+	for (size_t i = 0; i < src.size(); ++i) {src[i] = std::ldexp((float) (i * 7919 % 1000) - 500.0f, (int) (i % 40) - 30) / 3.0f;}
+	std::vector<Float16> dst(src.size());
+	Float16::fromFloat(src.data(), dst.data(), src.size());
+	std::vector<float> back(src.size());
+	Float16::toFloat(dst.data(), back.data(), src.size());
+	for (size_t i = 0; i < src.size(); ++i) {
+		ASSERT_EQ(Float16::fromFloat(src[i]), dst[i].bits);
+		ASSERT_EQ(Float16::toFloat(dst[i].bits), back[i]);
+	}
+
+}
+
+TEST(ImageBuffer, nativeFilters) {
+
+	const ImageChannel img = TestHelper::getPatternImage(23, 17);
+	const ImageU8 u8 = ImageU8::fromChannel(img);
+	const ImageU8 dst(img.getWidth(), img.getHeight());
+
+	MinimumRegion::apply(u8, dst, 3, 5);
+	ASSERT_EQ(MinimumRegion::apply(img, 3, 5), dst.toChannel());
+
+	MaximumRegion::apply(u8, dst, 5, 3);
+	ASSERT_EQ(MaximumRegion::apply(img, 5, 3), dst.toChannel());
+
+	// on a region (view) of a 16 bit image
+	const ImageU16 u16 = ImageU16::fromChannel(img);
+	const ImageU16 reg = u16.region(3, 2, 20, 15);
+	const ImageU16 dst16(reg.getWidth(), reg.getHeight());
+	MinimumRegion::apply(reg, dst16, 5, 5);
+	ASSERT_EQ(MinimumRegion::apply(reg.toChannel(), 5, 5), dst16.toChannel());
+
+	const Bitmap b1 = Threshold::bitmap(u8, (uint8_t) 127);
+	const Bitmap b2 = Threshold::bitmap(img, 127.5f / 255.0f);
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+			ASSERT_EQ(b2.get(x, y), b1.get(x, y));
+		}
+	}
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/ImageDecoder.h"
+#include "../../cv/ImageBatchLoader.h"
+#include "../../cv/ImageFactory.h"
+
+using namespace K;
+
+#if defined(WITH_PNG) && defined(WITH_JPEG)
+
+TEST(ImageDecoder, png) {
+
+	const ImageChannel src = TestHelper::getPatternImage(37, 21);
+	const std::string file = getTempFile("decoder.png");
+	ImageFactory::writePNG(file, src);
+	const DataMatrix<uint8_t> ref = ImageFactory::to8(src);
+
+	ImageDecoder dec;
+	ImageChannel img;
+	ImageBuffer<uint8_t> img8;
+	ImageBuffer<float> imgF;
+	dec.decodePNG(file, img);
+	dec.decode(file, img8);
+	dec.decode(file, imgF);
+
+	ASSERT_EQ(37, img.getWidth());
+	ASSERT_EQ(21, img.getHeight());
+	for (int y = 0; y < 21; ++y) {
+		for (int x = 0; x < 37; ++x) {
+			ASSERT_EQ(ref.get(x, y), img8.get(x, y));
+			ASSERT_EQ((float) ref.get(x, y) / 255.0f, img.get(x, y));
+			ASSERT_EQ(img.get(x, y), imgF.get(x, y));
+		}
+	}
+
+	// same size: the pixels are reused
+	const float* data = img.getData();
+	const uint8_t* data8 = img8.getData();
+	dec.decode(file, img);
+	dec.decode(file, img8);
+	ASSERT_EQ(data, img.getData());
+	ASSERT_EQ(data8, img8.getData());
+
+}
+
+TEST(ImageDecoder, rgb) {
+
+	// RGB files are averaged
+	const std::string file = getDataFile("sudoku_transformed.png");
+	ImageDecoder dec;
+	ImageChannel img;
+	ImageBuffer<uint16_t> img16;
+	dec.decode(file, img);
+	dec.decode(file, img16);
+	ASSERT_EQ(img16, ImageBuffer<uint16_t>::fromChannel(img));
+
+}
+
+TEST(ImageDecoder, jpeg) {
+
+	const std::string file = getDataFile("stereo1.jpg");
+	ImageDecoder dec;
+	ImageChannel img;
+	ImageBuffer<uint8_t> img8;
+	dec.decodeJPEG(file, img);
+	dec.decode(file, img8);
+
+	ASSERT_EQ(img.getWidth(), img8.getWidth());
+	ASSERT_EQ(img.getHeight(), img8.getHeight());
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+			ASSERT_EQ((float) img8.get(x, y) / 255.0f, img.get(x, y));
+		}
+	}
+
+}
+
+/** the former ImageFactory::readJPEG: first (red) component */
+static ImageChannel readJPEGRef(const std::string& file) {
+	FILE* fp = fopen(file.c_str(), "rb");
+	if (!fp) {throw Exception("could not open " + file);}
+	jpeg_decompress_struct cinfo;
+	jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_decompress(&cinfo);
+	jpeg_stdio_src(&cinfo, fp);
+	jpeg_read_header(&cinfo, TRUE);
+	jpeg_start_decompress(&cinfo);
+	const int w = (int) cinfo.output_width;
+	ImageChannel img(w, (int) cinfo.output_height);
+	std::vector<uint8_t> row((size_t) w * (size_t) cinfo.output_components);
+	JSAMPROW ptr = row.data();
+	for (int y = 0; y < img.getHeight(); ++y) {
+		jpeg_read_scanlines(&cinfo, &ptr, 1);
+		for (int x = 0; x < w; ++x) {img.set(x, y, row[(size_t) (x * cinfo.output_components)] / 255.0f);}
+	}
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	fclose(fp);
+	return img;
+}
+
+TEST(ImageDecoder, jpegComponent) {
+
+	// colored JPEGs: first (red) component by default, luminance on request
+	const std::string file = getDataFile("stereo1.jpg");
+	const ImageChannel ref = readJPEGRef(file);
+	ImageDecoder dec;
+	ImageChannel img;
+	dec.decodeJPEG(file, img);
+	ASSERT_EQ(ref, img);
+	ASSERT_EQ(ref, ImageFactory::readJPEG(file));
+
+	dec.setJPEGLuminance(true);
+	dec.decodeJPEG(file, img);
+	ASSERT_EQ(ref.getWidth(), img.getWidth());
+	ASSERT_EQ(ref.getHeight(), img.getHeight());
+	ASSERT_FALSE(ref == img);
+
+}
+
+TEST(ImageDecoder, invalid) {
+
+	ImageDecoder dec;
+	ImageChannel img;
+	ASSERT_THROW(dec.decode(getTempFile("doesNotExist.png"), img), Exception);
+	ASSERT_THROW(dec.decode(getDataFile("cylinder.obj"), img), Exception);
+	ASSERT_THROW(dec.decodePNG(getDataFile("stereo1.jpg"), img), Exception);
+	ASSERT_THROW(dec.decodeJPEG(getDataFile("blur.png"), img), Exception);
+
+	// still usable
+	dec.decode(getDataFile("blur.png"), img);
+	ASSERT_EQ(ImageFactory::readPNG(getDataFile("blur.png")), img);
+
+}
+
+TEST(ImageBatchLoader, ordered) {
+
+	const std::vector<std::string> names = {"blur.png", "stereo1.jpg", "ellipse1.png", "stereo2.jpg", "ellipses.png", "sudoku_transformed.png"};
+	std::vector<std::string> files;
+	for (int i = 0; i < 3; ++i) {
+		for (const std::string& n : names) {files.push_back(getDataFile(n));}
+	}
+
+	// sequential reference
+	std::vector<ImageBuffer<uint8_t>> ref(files.size());
+	ImageDecoder dec;
+	for (size_t i = 0; i < files.size(); ++i) {dec.decode(files[i], ref[i]);}
+
+	for (const int threads : {1, 3}) {
+		for (const int depth : {1, 2, 5}) {
+			size_t cnt = 0;
+			ImageBatchLoader<ImageBuffer<uint8_t>> loader(threads, depth);
+			loader.run(files, [&] (const size_t idx, ImageBuffer<uint8_t>& img) {
+				ASSERT_EQ(cnt, idx);
+				ASSERT_EQ(ref[idx], img);
+				++cnt;
+			});
+			ASSERT_EQ(files.size(), cnt);
+		}
+	}
+
+}
+
+TEST(ImageBatchLoader, error) {
+
+	std::vector<std::string> files = {getDataFile("blur.png"), getDataFile("doesNotExist.png"), getDataFile("stereo1.jpg"), getDataFile("blur.png")};
+	size_t cnt = 0;
+	ImageBatchLoader<> loader(2, 2);
+	ASSERT_THROW(loader.run(files, [&] (const size_t, ImageChannel&) {++cnt;}), Exception);
+	ASSERT_EQ(1u, cnt);
+
+	// exceptions thrown by the consumer
+	files.erase(files.begin() + 1);
+	ASSERT_THROW(loader.run(files, [&] (const size_t idx, ImageChannel&) {if (idx == 1) {throw Exception("stop");}}), Exception);
+
+}
+
+#endif
+
+#endif
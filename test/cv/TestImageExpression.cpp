@@ -0,0 +1,111 @@
+
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/ImageChannel.h"
+
+using namespace K;
+
+TEST(ImageExpression, matchesElementWise) {
+
+	// odd size: packets + remainder. values within [-1:+1]
+	const ImageChannel a = TestHelper::getPatternImage(13, 7, 201) * 2 - 1;
+	const ImageChannel b = TestHelper::getPatternImage(13, 7, 201, 5) * 2 - 1;
+	const float max = 3.0f;
+
+	const ImageChannel r1 = (1 - a) * 0.5f / max;
+	const ImageChannel r2 = (a + b) * (a - b) / (b.abs() + 1);
+	const ImageChannel r3 = -a + 2 * b - 1.5f;
+	const ImageChannel r4 = (a * b).abs();
+
+	// packets and scalars may round differently
+	for (int i = 0; i < 13*7; ++i) {
+		const float va = a.getData()[i];
+		const float vb = b.getData()[i];
+		ASSERT_NEAR((1 - va) * 0.5f / max, r1.getData()[i], 1e-6);
+		ASSERT_NEAR((va + vb) * (va - vb) / (std::abs(vb) + 1), r2.getData()[i], 1e-6);
+		ASSERT_NEAR(-va + 2 * vb - 1.5f, r3.getData()[i], 1e-6);
+		ASSERT_NEAR(std::abs(va * vb), r4.getData()[i], 1e-6);
+	}
+
+	// no size mismatch
+	const ImageChannel c(3, 3);
+	ASSERT_THROW(ImageChannel d = a + c, Exception);
+
+}
+
+TEST(ImageExpression, assign) {
+
+	const ImageChannel a = TestHelper::getPatternImage(10, 10, 201, 1);
+	ImageChannel img = a;
+
+	// the image itself may be part of the expression
+	const float* buf = img.getData();
+	img = 1 - img;
+	ASSERT_EQ(buf, img.getData());
+	for (int i = 0; i < 100; ++i) {ASSERT_FLOAT_EQ(1 - a.getData()[i], img.getData()[i]);}
+
+	// other size
+	ImageChannel other(3, 2);
+	other = a * 2;
+	ASSERT_EQ(10, other.getWidth());
+	ASSERT_EQ(10, other.getHeight());
+	ASSERT_FLOAT_EQ(a.get(4,5) * 2, other.get(4,5));
+
+	// temporaries are kept within the expression
+	const ImageChannel t = TestHelper::getPatternImage(10, 10, 201, 2) * 3 + a;
+	ASSERT_FLOAT_EQ(TestHelper::getPatternImage(10, 10, 201, 2).get(3,3) * 3 + a.get(3,3), t.get(3,3));
+
+}
+
+TEST(ImageExpression, compound) {
+
+	const ImageChannel a = TestHelper::getPatternImage(9, 5, 201, 1);
+	const ImageChannel b = TestHelper::getPatternImage(9, 5, 201, 2);
+
+	ImageChannel img = a;
+	img += b * 2;
+	img -= 0.5f;
+	img *= (a - b).abs();
+	img /= b + 3;
+
+	for (int i = 0; i < 9*5; ++i) {
+		const float va = a.getData()[i];
+		const float vb = b.getData()[i];
+		const float exp = (va + vb * 2 - 0.5f) * std::abs(va - vb) / (vb + 3);
+		ASSERT_NEAR(exp, img.getData()[i], 1e-6);
+	}
+
+	// plain images still use the DataMatrix operators
+	ImageChannel img2 = a;
+	img2 += b;
+	img2 *= 2.0f;
+	ASSERT_FLOAT_EQ((a.get(2,3) + b.get(2,3)) * 2.0f, img2.get(2,3));
+
+}
+
+TEST(ImageExpression, storedAsAuto) {
+
+	ImageChannel a = TestHelper::getPatternImage(9, 5, 201, 1);
+	const ImageChannel b = TestHelper::getPatternImage(9, 5, 201, 2);
+
+	// abs() and + - * / yield a lazy expression, not an image
+	const auto expr = (a - b).abs() * 2;
+	static_assert(!std::is_same<std::decay_t<decltype(expr)>, ImageChannel>::value, "expected an expression");
+
+	// named images are referenced: evaluated when materialized, not when built
+	a.set(3, 2, 5.0f);
+	const ImageChannel res = expr;
+	ASSERT_EQ(a.getWidth(), res.getWidth());
+	ASSERT_EQ(a.getHeight(), res.getHeight());
+	ASSERT_FLOAT_EQ(std::abs(5.0f - b.get(3,2)) * 2, res.get(3,2));
+	ASSERT_FLOAT_EQ(std::abs(a.get(1,4) - b.get(1,4)) * 2, res.get(1,4));
+
+	// temporaries are moved into the expression and may thus be kept
+	const auto expr2 = TestHelper::getPatternImage(9, 5) + 1;
+	const ImageChannel res2 = expr2;
+	ASSERT_FLOAT_EQ(TestHelper::getPatternImage(9, 5).get(4,4) + 1, res2.get(4,4));
+
+}
+
+#endif
@@ -40,7 +40,8 @@ TEST(ImagePyramid, create) {
 	omp_set_num_threads(3);
 
 	ImagePyramid pyr(img);
-	for (int i = 0; i < pyr.size(); ++i) {
+	ASSERT_EQ(12u, pyr.size());
+	for (int i = 0; i < (int) pyr.size(); ++i) {
 		std::string file = "/tmp/" + std::to_string(i) + ".png";
 #ifdef WITH_PNG
 		ImageFactory::writePNG(file, pyr.get(i));
@@ -50,6 +51,78 @@ TEST(ImagePyramid, create) {
 
 }
 
+/** reference: 2D [1 4 6 4 1] kernel with bound checks, evaluated at every second pixel */
+static ImageChannel getReduceRef(const ImageChannel& prev) {
+	const float k[5] = {1, 4, 6, 4, 1};
+	ImageChannel cur(prev.getWidth() / 2, prev.getHeight() / 2);
+	for (int y = 0; y < cur.getHeight(); ++y) {
+		for (int x = 0; x < cur.getWidth(); ++x) {
+			double val = 0;
+			double sum = 0;
+			for (int j = 0; j < 5; ++j) {
+				for (int i = 0; i < 5; ++i) {
+					const int ix = x*2 + i - 2;
+					const int iy = y*2 + j - 2;
+					if (ix < 0 || ix >= prev.getWidth() || iy < 0 || iy >= prev.getHeight()) {continue;}
+					val += k[i] * k[j] * prev.get(ix, iy);
+					sum += k[i] * k[j];
+				}
+			}
+			cur.set(x, y, (float) (val / sum));
+		}
+	}
+	return cur;
+}
+
+TEST(ImagePyramid, reduce) {
+
+	// odd and even sizes, including images too small for the interior (SIMD) path
+	const int sizes[][2] = {{1,1}, {2,2}, {3,5}, {6,4}, {23,17}, {64,48}, {101,77}};
+	for (const auto& s : sizes) {
+		const ImageChannel img = TestHelper::getPatternImage(s[0], s[1], 251);
+		ImagePyramid pyr(img);
+		for (int i = 1; i < (int) pyr.size(); ++i) {
+			const ImageChannel ref = getReduceRef(pyr.get(i-1));
+			const ImageChannel& cur = pyr.get(i);
+			ASSERT_EQ(ref.getWidth(), cur.getWidth());
+			ASSERT_EQ(ref.getHeight(), cur.getHeight());
+			for (int j = 0; j < ref.getWidth()*ref.getHeight(); ++j) {
+				ASSERT_NEAR(ref.getData()[j], cur.getData()[j], 1e-5);
+			}
+		}
+	}
+
+}
+
+TEST(ImagePyramid, lazyAndReuse) {
+
+	const ImageChannel img1 = TestHelper::getPatternImage(64, 32, 251, 1);
+	const ImageChannel img2 = TestHelper::getPatternImage(64, 32, 251, 2);
+
+	// borrowed base image: no copy
+	ImagePyramid pyr(img1, true);
+	ASSERT_EQ(6u, pyr.size());
+	ASSERT_EQ(&img1, &pyr.get(0));
+
+	// same size -> same buffers, but new content
+	const float* buf = pyr.get(3).getData();
+	pyr.set(img2, true);
+	ASSERT_EQ(buf, pyr.get(3).getData());
+	ImagePyramid ref(img2);
+	for (int i = 0; i < (int) pyr.size(); ++i) {
+		ASSERT_EQ(ref.get(i), pyr.get(i));
+	}
+
+	// other size -> other number of levels
+	const ImageChannel img3 = TestHelper::getPatternImage(20, 40, 251, 3);
+	pyr.set(img3);
+	ASSERT_EQ(5u, pyr.size());
+	ASSERT_NE(&img3, &pyr.get(0));
+	ASSERT_EQ(img3, pyr.get(0));
+	ASSERT_EQ(ImagePyramid::reduce(ImagePyramid::reduce(img3)), pyr.get(2));
+
+}
+
 
 #endif
 
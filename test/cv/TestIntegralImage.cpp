@@ -0,0 +1,106 @@
+
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/IntegralImage.h"
+#include "../../cv/filter/Box.h"
+#include "../../cv/filter/Threshold.h"
+#include "../../cv/features/Moments.h"
+
+using namespace K;
+
+TEST(IntegralImage, sums) {
+
+	const ImageChannel img = TestHelper::getPatternImage(23, 17);
+	const IntegralImage ii(img, true);
+
+	// compare against brute force for many rectangles (including clamped ones)
+	for (int y1 = -2; y1 < 19; y1 += 3) {
+		for (int x1 = -2; x1 < 25; x1 += 4) {
+			for (const int s : {1, 2, 5, 30}) {
+
+				double sum = 0, sum2 = 0; int cnt = 0;
+				for (int y = y1; y < y1+s; ++y) {
+					for (int x = x1; x < x1+s+1; ++x) {
+						if (!img.contains(x,y)) {continue;}
+						const double v = img.get(x,y); sum += v; sum2 += v*v; ++cnt;
+					}
+				}
+
+				ASSERT_EQ(cnt, ii.getCount(x1, y1, x1+s+1, y1+s));
+				ASSERT_NEAR(sum, ii.getSum(x1, y1, x1+s+1, y1+s), 1e-9);
+				ASSERT_NEAR(sum2, ii.getSumSquared(x1, y1, x1+s+1, y1+s), 1e-9);
+				if (cnt) {
+					const double mean = sum/cnt;
+					ASSERT_NEAR(mean, ii.getMean(x1, y1, x1+s+1, y1+s), 1e-6);
+					ASSERT_NEAR(sum2/cnt - mean*mean, ii.getVariance(x1, y1, x1+s+1, y1+s), 1e-5);
+				}
+
+			}
+		}
+	}
+
+	// empty rectangles
+	ASSERT_EQ(0, ii.getSum(5, 5, 5, 9));
+	ASSERT_EQ(0, ii.getSum(30, 0, 40, 10));
+	ASSERT_EQ(0, ii.getMean(-5, -5, 0, 0));
+
+}
+
+TEST(IntegralImage, box) {
+
+	const ImageChannel img = TestHelper::getPatternImage(31, 20);
+	const ImageChannel res = CV::Box::apply(img, 5, 3);
+
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+			float sum = 0; int cnt = 0;
+			for (int oy = -1; oy <= 1; ++oy) {
+				for (int ox = -2; ox <= 2; ++ox) {
+					if (!img.contains(x+ox, y+oy)) {continue;}
+					sum += img.get(x+ox, y+oy); ++cnt;
+				}
+			}
+			ASSERT_NEAR(sum/(float)cnt, res.get(x,y), 1e-5);
+		}
+	}
+
+}
+
+TEST(IntegralImage, thresholdLocal) {
+
+	// gradient background with a brighter spot: a global threshold fails, a local one does not
+	ImageChannel img(40, 10);
+	img.setEach([] (const int x, const int y) {(void) y; return (float) x / 40.0f;});
+	img.set(5, 5, 0.4f);
+	img.set(35, 5, 1.0f);
+
+	const ImageChannel res = CV::Threshold::local(img, 3, 0.0f, 0.1f);
+	ASSERT_EQ(1.0f, res.get(5, 5));
+	ASSERT_EQ(1.0f, res.get(35, 5));
+	ASSERT_EQ(0.0f, res.get(20, 5));
+	ASSERT_EQ(0.0f, res.get(36, 5));
+
+	// with standard deviation
+	const ImageChannel res2 = CV::Threshold::local(img, 3, 1.0f);
+	ASSERT_EQ(1.0f, res2.get(5, 5));
+
+}
+
+TEST(IntegralImage, moments) {
+
+	const ImageChannel img = TestHelper::getPatternImage(40, 30);
+	const MomentsIntegral mi(img);
+
+	for (const Point2i c : {Point2i(0,0), Point2i(10,12), Point2i(39,29), Point2i(20,1)}) {
+		for (const Size2i s : {Size2i(9,9), Size2i(4,7)}) {
+			ASSERT_NEAR((Moments::get<0,0>(img, c, s)), (mi.get<0,0>(c, s)), 1e-3);
+			ASSERT_NEAR((Moments::get<1,0>(img, c, s)), (mi.get<1,0>(c, s)), 1e-3);
+			ASSERT_NEAR((Moments::get<0,1>(img, c, s)), (mi.get<0,1>(c, s)), 1e-3);
+			ASSERT_NEAR((Moments::get<1,1>(img, c, s)), (mi.get<1,1>(c, s)), 1e-3);
+		}
+	}
+
+}
+
+#endif
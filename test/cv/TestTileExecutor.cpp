@@ -0,0 +1,106 @@
+
+#ifdef WITH_TESTS
+
+#include "../Test.h"
+#include "../../cv/TileExecutor.h"
+#include "../../cv/filter/Sobel.h"
+#include "../../cv/filter/Gauss.h"
+#include "../../cv/filter/Median.h"
+#include "../../cv/filter/Minimum.h"
+#include "../../cv/filter/Maximum.h"
+#include "../../cv/filter/Dilate.h"
+#include "../../cv/filter/Normalize.h"
+#include "../../cv/filter/Resize.h"
+#include "../../cv/filter/Rotate.h"
+
+using namespace K;
+using namespace K::CV;
+
+static void assertTileEq(const ImageChannel& a, const ImageChannel& b) {
+	ASSERT_EQ(a.getWidth(), b.getWidth());
+	ASSERT_EQ(a.getHeight(), b.getHeight());
+	for (int i = 0; i < a.getWidth()*a.getHeight(); ++i) {
+		ASSERT_FLOAT_EQ(a.getData()[i], b.getData()[i]);
+	}
+}
+
+TEST(TileExecutor, bands) {
+
+	TileExecutor exec(4, 10);
+	const std::vector<TileBand> bands = exec.getBands(35, 2);
+	ASSERT_EQ(4u, bands.size());
+
+	ASSERT_EQ(0, bands[0].y0);	ASSERT_EQ(10, bands[0].y1);
+	ASSERT_EQ(0, bands[0].in0);	ASSERT_EQ(12, bands[0].in1);
+
+	ASSERT_EQ(10, bands[1].y0);	ASSERT_EQ(20, bands[1].y1);
+	ASSERT_EQ(8, bands[1].in0);	ASSERT_EQ(22, bands[1].in1);
+
+	ASSERT_EQ(30, bands[3].y0);	ASSERT_EQ(35, bands[3].y1);
+	ASSERT_EQ(28, bands[3].in0);ASSERT_EQ(35, bands[3].in1);
+	ASSERT_EQ(3, bands[3].idx);
+
+	// auto band size covers everything
+	int rows = 0;
+	for (const TileBand& b : TileExecutor().getBands(1001, 3)) {rows += b.y1 - b.y0;}
+	ASSERT_EQ(1001, rows);
+
+}
+
+TEST(TileExecutor, forEach) {
+
+	// every index exactly once
+	std::vector<int> cnt(101, 0);
+	TileExecutor(3).forEach(101, [&] (const int i) {++cnt[i];});
+	for (const int c : cnt) {ASSERT_EQ(1, c);}
+
+	// every pixel exactly once
+	std::vector<int> px(13*29, 0);
+	TileExecutor(3, 4).forEachPixel(13, 29, 1, [&] (const int x, const int y) {++px[y*13+x];});
+	for (const int c : px) {ASSERT_EQ(1, c);}
+
+}
+
+TEST(TileExecutor, filtersMatchSerial) {
+
+	// small bands -> many band borders
+	const TileExecutor exec(4, 7);
+	// pseudo random image with some saturated pixels (for dilation)
+	const ImageChannel img = TestHelper::getPatternImage(53, 61, 97);
+	ImageChannel dst(img.getWidth(), img.getHeight());
+
+	Sobel::apply(img, dst, exec);
+	ImageChannel tmp = img;
+	assertTileEq(Sobel::apply(tmp), dst);
+
+	Gauss g(1.5f);
+	g.filter(img, dst, exec);
+	assertTileEq(g.filter(img), dst);
+
+	CV::Median::apply(img, dst, exec, 5, 5);
+	assertTileEq(CV::Median::apply(img, 5, 5), dst);
+
+	MinimumRegion::apply(img, dst, exec, 3, 5);
+	assertTileEq(MinimumRegion::apply(img, 3, 5), dst);
+
+	MaximumRegion::apply(img, dst, exec, 5, 3);
+	assertTileEq(MaximumRegion::apply(img, 5, 3), dst);
+
+	for (int r = 1; r <= 3; ++r) {
+		Dilate::apply(img, dst, exec, r, Dilate::CIRCLE, 1.0f, 0.2f);
+		assertTileEq(Dilate::apply(img, r, Dilate::CIRCLE, 1.0f, 0.2f), dst);
+	}
+
+	Normalize::run(img * 3.0f, dst, exec);
+	assertTileEq(Normalize::run(img * 3.0f), dst);
+
+	Rotate::apply<Interpolation::Bilinear>(img, dst, Point2f(20, 30), 0.3f, exec);
+	assertTileEq(Rotate::apply<Interpolation::Bilinear>(img, Point2f(20, 30), 0.3f), dst);
+
+	ImageChannel small(20, 25);
+	Resize::apply<Interpolation::Bilinear>(img, small, exec);
+	assertTileEq(Resize::apply<Interpolation::Bilinear>(img, 20, 25), small);
+
+}
+
+#endif
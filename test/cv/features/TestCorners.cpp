@@ -5,6 +5,9 @@
 
 #include "../../Test.h"
 #include "../../../cv/features/CornerDetectorHarris.h"
+#include "../../../cv/Derivative.h"
+#include "../../../cv/filter/Gauss.h"
+#include "../../../cv/ImageFactory.h"
 #include "../../../cv/features/HOG.h"
 #include <sstream>
 using namespace K;
@@ -77,7 +80,111 @@ TEST(Corners, Harris) {
 
 }
 
+static ImageChannel getCornerImage(const int w, const int h) {
+	ImageChannel img = TestHelper::getPatternImage(w, h, 97) * 0.05f;		// some noise
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) {
+			const float v = ((x / 12 + y / 9) % 2) ? (0.8f) : (0.1f);		// checkerboard -> corners
+			img.set(x, y, img.get(x, y) + v);
+		}
+	}
+	return img;
+}
+
+TEST(Corners, HarrisResponse) {
+
+	const ImageChannel img = getCornerImage(61, 47);
+
+	// reference: the multi-pass variant using full intermediate images
+	ImageChannel imgX = Derivative::getX(img);
+	ImageChannel imgY = Derivative::getY(img);
+	ImageChannel imgXY(img.getWidth(), img.getHeight());
+	imgXY.setEach([&] (const int x, const int y) {return imgX.get(x,y) * imgY.get(x,y);});
+	imgX.forEachModify([] (const int, const int, const float v) {return v*v;});
+	imgY.forEachModify([] (const int, const int, const float v) {return v*v;});
+	CV::Gauss g(1.5f);
+	imgX = g.filter(imgX);
+	imgY = g.filter(imgY);
+	imgXY = g.filter(imgXY);
+
+	CornerDetectorHarris cdh;
+	cdh.setBlurSigma(1.5f);
+	cdh.setThreshold(0.0001f);
+
+	// several (small) bands -> the strips must overlap correctly
+	cdh.setExecutor(TileExecutor(3, 5));
+	const ImageChannel imgR = cdh.getResponse(img);
+
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+			const float a = imgX.get(x,y);
+			const float b = imgXY.get(x,y);
+			const float c = imgY.get(x,y);
+			const float r = (a*c - b*b) / (a+c);
+			const float exp = (r == r && r > 0.0001f) ? (r) : (0);
+			ASSERT_NEAR(exp, imgR.get(x,y), 1e-5f + std::abs(exp) * 1e-3f) << x << ":" << y;
+		}
+	}
+
+}
+
+TEST(Corners, HarrisParallel) {
+
+	const ImageChannel img = getCornerImage(80, 70);
 
+	CornerDetectorHarris cdh;
+	cdh.setExecutor(TileExecutor(1, 1000));
+	const std::vector<Corner> c1 = cdh.getCorners(img);
+	cdh.setExecutor(TileExecutor(4, 7));
+	const std::vector<Corner> c2 = cdh.getCorners(img);
+
+	ASSERT_FALSE(c1.empty());
+	ASSERT_EQ(c1.size(), c2.size());
+	for (size_t i = 0; i < c1.size(); ++i) {
+		ASSERT_EQ(c1[i].x, c2[i].x);
+		ASSERT_EQ(c1[i].y, c2[i].y);
+		ASSERT_EQ(c1[i].strength, c2[i].strength);
+	}
+
+	// the parallel search yields the same maxima as forEach
+	LocalMaxima lMax(2, 0.001f);
+	const ImageChannel imgR = cdh.getResponse(img);
+	std::vector<ImagePoint> exp;
+	lMax.forEach(imgR, [&] (const int x, const int y) {exp.push_back(ImagePoint(x,y));});
+	const std::vector<ImagePoint> res = lMax.getAll(imgR, TileExecutor(3, 4));
+	ASSERT_EQ(exp.size(), res.size());
+	for (size_t i = 0; i < exp.size(); ++i) {
+		ASSERT_EQ(exp[i].x, res[i].x);
+		ASSERT_EQ(exp[i].y, res[i].y);
+	}
+
+}
+
+TEST(Corners, HarrisMaxCorners) {
+
+	const ImageChannel img = getCornerImage(120, 90);
+
+	CornerDetectorHarris cdh;
+	const std::vector<Corner> all = cdh.getCorners(img);
+	ASSERT_GT(all.size(), 20u);
+
+	cdh.setMaxCorners(10);
+	const std::vector<Corner> best = cdh.getCorners(img);
+	ASSERT_EQ(10u, best.size());
+
+	// the strongest corner is never suppressed and comes first
+	float max = 0;
+	for (const Corner& c : all) {max = std::max(max, c.strength);}
+	ASSERT_EQ(max, best.front().strength);
+
+	// no duplicates
+	for (size_t i = 0; i < best.size(); ++i) {
+		for (size_t j = i+1; j < best.size(); ++j) {
+			ASSERT_FALSE(best[i].x == best[j].x && best[i].y == best[j].y);
+		}
+	}
+
+}
 
 #endif
 
@@ -206,32 +206,136 @@ TEST(HOG2, pattern) {
 
 	K::ImageChannel img(8,8);
 
-	{
-		K::Size2i bs(8,8);
-		K::Size2i cs(8,8);
-		K::HOG2 hog(img, cs, 9, bs);
-		std::vector<K::HOG2::CellPoint> pts = hog.getCellPoints(K::HOG2::RECTANGULAR);
-		ASSERT_EQ(8*8, pts.size());
-		ASSERT_EQ(pts[0].impact, pts[7].impact); // symmetric
+	for (const int cs : {8, 4, 3}) {
+		K::HOG2 hog(img, K::Size2i(cs,cs), 9, K::Size2i(cs,cs));
+		const std::vector<float> impact = hog.getCellImpact(cs);
+		ASSERT_EQ((size_t) cs, impact.size());
+		ASSERT_EQ(impact[0], impact[cs-1]);	// symmetric
+		ASSERT_LT(impact[0], impact[cs/2]);	// edge-pixels are downweighted
 	}
 
-	{
-		K::Size2i bs(4,4);
-		K::Size2i cs(4,4);
-		K::HOG2 hog(img, cs, 9, bs);
-		std::vector<K::HOG2::CellPoint> pts = hog.getCellPoints(K::HOG2::RECTANGULAR);
-		ASSERT_EQ(4*4, pts.size());
-		ASSERT_EQ(pts[0].impact, pts[3].impact); // symmetric
+}
+
+/** reference: the histogram of one cell, examining each of its pixels */
+static K::HOG2::Vector getCellRef(const K::HOG2& hog, const K::ImageChannel& img, const int x, const int y, const int csw, const int csh, const int bins) {
+	K::HOG2::Vector res;
+	res.resize(bins);
+	const K::ImageChannel imgX = K::Derivative::getXcen(img);
+	const K::ImageChannel imgY = K::Derivative::getYcen(img);
+	for (int oy = -csh/2; oy < csh - csh/2; ++oy) {
+		for (int ox = -csw/2; ox < csw - csw/2; ++ox) {
+			const int x1 = x + ox;
+			const int y1 = y + oy;
+			if (x1 < 0 || x1 >= img.getWidth() || y1 < 0 || y1 >= img.getHeight()) {continue;}
+			const float fx = (float) ox + ((csw % 2 == 0) ? 0.5f : 0.0f);
+			const float fy = (float) oy + ((csh % 2 == 0) ? 0.5f : 0.0f);
+			const float impact = std::exp( -(fx*fx + fy*fy) / (2.0f*5.0f*5.0f) );
+			const float dx = imgX.get(x1, y1);
+			const float dy = imgY.get(x1, y1);
+			float rad = std::atan2(dy, dx);
+			if (rad < 0) {rad += 2.0f*(float)M_PI;}
+			const K::HOG2::Contributions c = hog.getContribution(rad * 180.0f / (float)M_PI, std::sqrt(dx*dx + dy*dy) * impact);
+			res[c.c1.bin] += c.c1.weight;
+			res[c.c2.bin] += c.c2.weight;
+		}
 	}
+	return res;
+}
 
-	{
-		K::Size2i bs(3,3);
-		K::Size2i cs(3,3);
-		K::HOG2 hog(img, cs, 9, bs);
-		std::vector<K::HOG2::CellPoint> pts = hog.getCellPoints(K::HOG2::RECTANGULAR);
-		ASSERT_EQ(3*3, pts.size());
-		ASSERT_EQ(pts[0].impact, pts[2].impact); // symmetric
+static K::ImageChannel getHOGImage(const int w, const int h) {
+	K::ImageChannel img(w, h);
+	img.setEach([] (const int x, const int y) {return (float) ((x*x*7 + y*y*13 + x*y*3) % 23) / 22.0f;});
+	return img;
+}
+
+TEST(HOG2, denseCellsMatchReference) {
+
+	for (const int cs : {3, 4, 8}) {
+
+		const K::ImageChannel img = getHOGImage(37, 29);
+		const K::HOG2 hog(img, K::Size2i(cs,cs), 9, K::Size2i(2*cs,2*cs));
+
+		for (int y = cs/2; y <= img.getHeight() - cs/2; ++y) {
+			for (int x = cs/2; x <= img.getWidth() - cs/2; ++x) {
+				const K::HOG2::Vector ref = getCellRef(hog, img, x, y, cs, cs, 9);
+				const K::HOG2::Vector cell = hog.getCell(x, y);
+				for (int b = 0; b < 9; ++b) {ASSERT_NEAR(ref[b], cell[b], 1e-4f * (1 + ref[b]));}
+			}
+		}
+
+	}
+
+}
+
+TEST(HOG2, denseCellsNonSquare) {
+
+	// cells use their own height vertically (the former per-pixel pattern used the width for both)
+	for (const K::Size2i cs : {K::Size2i(4,8), K::Size2i(6,3)}) {
+
+		const K::ImageChannel img = getHOGImage(37, 29);
+		const int bs = std::max(cs.w, cs.h);
+		const K::HOG2 hog(img, cs, 9, K::Size2i(bs,bs));
+
+		for (int y = cs.h/2; y <= img.getHeight() - cs.h/2; ++y) {
+			for (int x = cs.w/2; x <= img.getWidth() - cs.w/2; ++x) {
+				const K::HOG2::Vector ref = getCellRef(hog, img, x, y, cs.w, cs.h, 9);
+				const K::HOG2::Vector cell = hog.getCell(x, y);
+				for (int b = 0; b < 9; ++b) {ASSERT_NEAR(ref[b], cell[b], 1e-4f * (1 + ref[b]));}
+			}
+		}
+
+	}
+
+}
+
+TEST(HOG2, edgeBins) {
+
+	// vertical edge: only the 0 degree bin is set, also after the separable accumulation
+	K::ImageChannel img(24, 24);
+	img.setEach([] (const int x, const int y) {(void) y; return (x < 12) ? 0.0f : 1.0f;});
+	const K::HOG2 hog(img, K::Size2i(6,6), 9, K::Size2i(6,6));
+
+	ASSERT_EQ(0, hog.getCell(5, 8).length());
+	const K::HOG2::Vector vec = hog.getCell(12, 8);
+	ASSERT_NE(0, vec.length());
+	ASSERT_EQ(vec.length(), vec[0]);
+
+}
+
+TEST(HOG2, batchFeatures) {
+
+	const K::ImageChannel img = getHOGImage(80, 72);
+	const K::HOG2 hog(img, K::Size2i(8,8), 9, K::Size2i(16,16));
+	const K::Size2i winSize(32, 48);
+
+	const std::vector<K::Point2i> pos = hog.getWindowCenters(winSize, K::Size2i(4,4));
+	ASSERT_EQ((size_t) ((80-32)/4+1) * ((72-48)/4+1), pos.size());
+
+	const K::DataMatrix<float> feats = hog.getFeatures(pos, winSize);
+	ASSERT_EQ(hog.getFeatureLength(winSize), feats.getWidth());
+	ASSERT_EQ((int) pos.size(), feats.getHeight());
+
+	for (size_t i = 0; i < pos.size(); ++i) {
+		const K::HOG2::Vector feat = hog.getFeature(pos[i], winSize);
+		ASSERT_EQ(0, memcmp(feat.data(), feats.getData() + i * feat.size(), feat.size() * sizeof(float)));
+	}
+
+	// blocks are normalized views into the cell grid
+	const K::HOG2::Vector block = hog.getBlock(20, 20);
+	K::HOG2::Vector cells;
+	for (const K::Point2i c : {K::Point2i(16,16), K::Point2i(24,16), K::Point2i(16,24), K::Point2i(24,24)}) {
+		const K::HOG2::Vector cell = hog.getCell(c.x, c.y);
+		cells.insert(cells.end(), cell.begin(), cell.end());
 	}
+	cells.normalize();
+	ASSERT_EQ(cells.size(), block.size());
+	for (size_t i = 0; i < block.size(); ++i) {ASSERT_FLOAT_EQ(cells[i], block[i]);}
+
+	// windows (and cells) exceeding the image
+	ASSERT_THROW(hog.getFeatures({K::Point2i(79, 40)}, winSize), K::Exception);
+	ASSERT_THROW(hog.getFeature(K::Point2i(79, 40), winSize), K::Exception);
+	ASSERT_THROW(hog.getCellData(80, 10), K::Exception);
+	ASSERT_THROW(hog.getCellData(10, -1), K::Exception);
 
 }
 
@@ -45,4 +45,52 @@ TEST(FilterMedian, whole) {
 
 }
 
+/** reference: examine each neighborhood */
+static ImageChannel getMedianRef(const ImageChannel& img, const int sx, const int sy) {
+	ImageChannel res(img.getWidth(), img.getHeight());
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+			res.set(x, y, K::CV::Median::get(img, x, y, sx, sy));
+		}
+	}
+	return res;
+}
+
+TEST(FilterMedian, sortingNetwork) {
+
+	// including images smaller than the window
+	const int sizes[][2] = {{1,1}, {2,7}, {4,4}, {5,5}, {17,9}, {40,33}};
+	for (const auto& s : sizes) {
+		const ImageChannel img = TestHelper::getPatternImage(s[0], s[1]);
+		for (const int size : {3, 5}) {
+			ASSERT_EQ(getMedianRef(img, size, size), K::CV::Median::apply(img, size, size));
+		}
+	}
+
+}
+
+TEST(FilterMedian, histogram) {
+
+	const int sizes[][2] = {{1,1}, {3,8}, {16,16}, {37,29}};
+	for (const auto& s : sizes) {
+		const ImageChannel img = TestHelper::getPatternImage(s[0], s[1]);
+		for (const int r : {0, 1, 2, 4, 7}) {
+			const ImageChannel ref = getMedianRef(img, 2*r+1, 2*r+1);
+			const ImageChannel res = K::CV::Median::applyHistogram(img, r);
+			for (int i = 0; i < s[0]*s[1]; ++i) {
+				ASSERT_NEAR(ref.getData()[i], res.getData()[i], 1e-5);
+			}
+		}
+	}
+
+	// values outside of [min:max] are clamped
+	ImageChannel img(3,1);
+	img << -1, 0.5, 2;
+	const ImageChannel res = K::CV::Median::applyHistogram(img, 1);
+	ASSERT_NEAR(0.25f, res.get(0,0), 0.01);
+	ASSERT_NEAR(0.5f, res.get(1,0), 0.01);
+	ASSERT_NEAR(0.75f, res.get(2,0), 0.01);
+
+}
+
 #endif
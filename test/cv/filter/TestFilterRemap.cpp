@@ -0,0 +1,110 @@
+#ifdef WITH_TESTS
+
+#include "../../Test.h"
+#include "../../../cv/filter/Remap.h"
+#include "../../../cv/filter/Rotate.h"
+#include "../../../cv/filter/Transform.h"
+#include "../../../cv/camera/Homography.h"
+#include "../../../cv/camera/lens/LensDistortionRadial.h"
+
+using namespace K;
+using namespace K::CV;
+
+/** equal up to rounding: the per-pixel interpolation blends a clamped pixel with itself */
+static void assertRemapEq(const ImageChannel& a, const ImageChannel& b) {
+	ASSERT_EQ(a.getWidth(), b.getWidth());
+	ASSERT_EQ(a.getHeight(), b.getHeight());
+	for (int i = 0; i < a.getWidth()*a.getHeight(); ++i) {
+		ASSERT_FLOAT_EQ(a.getData()[i], b.getData()[i]);
+	}
+}
+
+TEST(FilterRemap, rotate) {
+
+	// same as the per-pixel rotation, including the clamped border
+	const ImageChannel img = TestHelper::getPatternImage(53, 37);
+	const Remap::Plan plan = Rotate::getPlan(53, 37, Point2f(20.5f, 15), 0.7f);
+	const ImageChannel exp = Rotate::apply<Interpolation::Bilinear>(img, Point2f(20.5f, 15), 0.7f);
+	assertRemapEq(exp, plan.apply(img));
+
+	// the plan does not depend on the image. bands do not change the result
+	const ImageChannel img2 = TestHelper::getPatternImage(53, 37) * 0.5f;
+	ImageChannel out(53, 37);
+	plan.apply(img2, out, TileExecutor(3, 2));
+	assertRemapEq(Rotate::apply<Interpolation::Bilinear>(img2, Point2f(20.5f, 15), 0.7f), out);
+
+}
+
+TEST(FilterRemap, skip) {
+
+	// shift by (2.25, -1.5): pixels mapped outside the source remain untouched
+	const ImageChannel img = TestHelper::getPatternImage(30, 20);
+	const Remap::Plan plan(30, 20, 25, 22, [] (const int x, const int y) {return Point2f((float) x + 2.25f, (float) y - 1.5f);}, Remap::SKIP);
+
+	ImageChannel out(25, 22);
+	out.setAll(-1);
+	plan.apply(img, out);
+
+	for (int y = 0; y < 22; ++y) {
+		for (int x = 0; x < 25; ++x) {
+			const float sx = (float) x + 2.25f;
+			const float sy = (float) y - 1.5f;
+			if (sy < 0 || sy > 19) {
+				ASSERT_EQ(-1, out.get(x, y));
+			} else {
+				ASSERT_EQ(Interpolation::bilinear(img, sx, sy), out.get(x, y)) << x << ":" << y;
+			}
+		}
+	}
+
+	ASSERT_THROW(plan.apply(TestHelper::getPatternImage(20, 20), out), Exception);
+
+}
+
+TEST(FilterRemap, lens) {
+
+	const ImageChannel img = TestHelper::getPatternImage(64, 48);
+	const float params[2] = {0.3f, -0.1f};
+
+	// reference: evaluate the polynomial for each pixel
+	ImageChannel exp(64, 48);
+	exp.zero();
+	const Point2f size(64, 48);
+	const Point2f offset(0.5f, 0.5f);
+	for (int y = 0; y < 48; ++y) {
+		for (int x = 0; x < 64; ++x) {
+			const Point2f p1 = Point2f((float)x, (float)y) / size - offset;
+			const Point2f p2 = (LensDistortionRadial::undistort(p1, params, 2) + offset) * size;
+			if (std::ceil(p2.x) >= 64 || std::ceil(p2.y) >= 48 || p2.x < 0 || p2.y < 0) {continue;}
+			exp.set(x, y, Interpolation::bilinear(img, p2.x, p2.y));
+		}
+	}
+
+	const Remap::Plan plan = LensDistortionRadial::getUndistortPlan(64, 48, params, 2);
+	ASSERT_EQ(exp, plan.apply(img));
+	ASSERT_EQ(exp, LensDistortionRadial::undistort(img, params, 2));
+
+}
+
+TEST(FilterRemap, homography) {
+
+	// world = 2 * img
+	Homography h;
+	h.addCorrespondence(0, 0,		0, 0);
+	h.addCorrespondence(1, 0,		2, 0);
+	h.addCorrespondence(1, 1,		2, 2);
+	h.addCorrespondence(0, 1,		0, 2);
+	h.estimate();
+
+	const ImageChannel img = TestHelper::getPatternImage(40, 40);
+	const Remap::Plan plan = h.getUndoPlan(40, 40, 20, 20);
+	const ImageChannel out = plan.apply(img);
+	for (int y = 0; y < 20; ++y) {
+		for (int x = 0; x < 20; ++x) {
+			ASSERT_NEAR(img.get(x*2, y*2), out.get(x, y), 1e-4);
+		}
+	}
+
+}
+
+#endif
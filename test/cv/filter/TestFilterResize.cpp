@@ -0,0 +1,110 @@
+#ifdef WITH_TESTS
+
+#include "../../Test.h"
+#include "../../../cv/filter/Resize.h"
+#include "../../../cv/filter/Interpolation.h"
+#include "../../../geo/Point2.h"
+
+using namespace K;
+using namespace K::CV;
+
+TEST(FilterResize, identity) {
+
+	const ImageChannel img = TestHelper::getPatternImage(37, 21);
+	for (const Resize::Filter f : {Resize::NEAREST, Resize::BILINEAR, Resize::BICUBIC, Resize::LANCZOS3, Resize::AREA}) {
+		const ImageChannel out = Resize::apply(img, 37, 21, f);
+		for (int i = 0; i < 37*21; ++i) {ASSERT_NEAR(img.getData()[i], out.getData()[i], 1e-5);}
+	}
+
+}
+
+TEST(FilterResize, constant) {
+
+	// normalized weights: a constant image remains constant (also along the edges)
+	ImageChannel img(50, 40);
+	img.setAll(0.25f);
+	for (const Resize::Filter f : {Resize::NEAREST, Resize::BILINEAR, Resize::BICUBIC, Resize::LANCZOS3, Resize::AREA}) {
+		for (const Point2i size : {Point2i(13, 7), Point2i(23, 31), Point2i(111, 97)}) {
+			const ImageChannel out = Resize::apply(img, size.x, size.y, f);
+			ASSERT_EQ(size.x, out.getWidth());
+			ASSERT_EQ(size.y, out.getHeight());
+			for (int i = 0; i < size.x*size.y; ++i) {ASSERT_NEAR(0.25f, out.getData()[i], 1e-5);}
+		}
+	}
+
+	// resizing by a factor rounds the new size
+	const ImageChannel third = Resize::apply(img, 1.0f / 3.0f, Resize::BILINEAR);
+	ASSERT_EQ(17, third.getWidth());
+	ASSERT_EQ(13, third.getHeight());
+
+}
+
+TEST(FilterResize, area) {
+
+	// integer factor: the average of each 4x3 block
+	const ImageChannel img = TestHelper::getPatternImage(48, 30);
+	const ImageChannel out = Resize::apply(img, 12, 10, Resize::AREA);
+	for (int y = 0; y < 10; ++y) {
+		for (int x = 0; x < 12; ++x) {
+			float sum = 0;
+			for (int dy = 0; dy < 3; ++dy) {
+				for (int dx = 0; dx < 4; ++dx) {sum += img.get(x*4+dx, y*3+dy);}
+			}
+			ASSERT_NEAR(sum / 12, out.get(x, y), 1e-5);
+		}
+	}
+
+	// non-integer factor: the mean is kept
+	const ImageChannel out2 = Resize::apply(img, 7, 9, Resize::AREA);
+	double sumIn = 0;
+	double sumOut = 0;
+	for (int i = 0; i < 48*30; ++i) {sumIn += img.getData()[i];}
+	for (int i = 0; i < 7*9; ++i) {sumOut += out2.getData()[i];}
+	ASSERT_NEAR(sumIn / (48*30), sumOut / (7*9), 1e-4);
+
+}
+
+TEST(FilterResize, bilinear) {
+
+	// upscaling a linear ramp yields a linear ramp (pixel centers aligned), except for the clamped edges
+	ImageChannel img(20, 10);
+	img.setEach([] (const int x, const int y) {return (float) (x + 2*y);});
+	const ImageChannel out = Resize::apply(img, 40, 20, Resize::BILINEAR);
+	for (int y = 1; y < 19; ++y) {
+		for (int x = 1; x < 39; ++x) {
+			const float sx = ((float) x + 0.5f) / 2 - 0.5f;
+			const float sy = ((float) y + 0.5f) / 2 - 0.5f;
+			ASSERT_NEAR(sx + 2*sy, out.get(x, y), 1e-4);
+		}
+	}
+
+	// same as the interpolator for pixel centers
+	const ImageChannel img2 = TestHelper::getPatternImage(30, 30);
+	const ImageChannel out2 = Resize::apply(img2, 20, 20, Resize::NEAREST);
+	ASSERT_EQ(Interpolation::None::get(img2, 1.5f * 3 + 0.75f, 1.5f * 7 + 0.75f), out2.get(3, 7));
+
+}
+
+TEST(FilterResize, planCache) {
+
+	const std::shared_ptr<const Resize::Plan> p1 = Resize::getPlan(400, 300, 100, 75, Resize::LANCZOS3);
+	const std::shared_ptr<const Resize::Plan> p2 = Resize::getPlan(400, 300, 100, 75, Resize::BICUBIC);
+	ASSERT_NE(p1, p2);
+	ASSERT_EQ(p1, Resize::getPlan(400, 300, 100, 75, Resize::LANCZOS3));
+	ASSERT_EQ(100, p1->getDstWidth());
+	ASSERT_EQ(75, p1->getDstHeight());
+
+	// bands and threads do not change the result
+	const ImageChannel img = TestHelper::getPatternImage(400, 300);
+	ImageChannel o1(100, 75);
+	ImageChannel o2(100, 75);
+	p1->run(img, o1, TileExecutor(1, 1000));
+	p1->run(img, o2, TileExecutor(4, 3));
+	ASSERT_EQ(o1, o2);
+
+	ImageChannel wrong(10, 10);
+	ASSERT_THROW(p1->run(img, wrong), Exception);
+
+}
+
+#endif
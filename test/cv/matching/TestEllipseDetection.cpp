@@ -0,0 +1,150 @@
+#ifdef WITH_TESTS
+
+#include "../../Test.h"
+#include "../../../cv/matching/EllipseDetection.h"
+
+#include <random>
+#include <set>
+#include <mutex>
+#include <thread>
+
+using namespace K;
+
+/** the former O(n^2) implementation */
+static std::vector<Ellipse::GeometricParams> filterDuplicatesRef(const std::vector<Ellipse::GeometricParams>& src) {
+	std::vector<Ellipse::GeometricParams> filtered;
+	for (const Ellipse::GeometricParams& e1 : src) {
+		bool unique = true;
+		for (Ellipse::GeometricParams& e2 : filtered) {
+			const float dCenterDiff = e1.center.getDistance(e2.center);
+			const float dAxis = std::sqrt(  ((e1.a - e2.a) * (e1.a - e2.a)) + ((e1.b - e2.b) * (e1.b - e2.b))  );
+			if ((dCenterDiff < 16) && (dAxis < 6)) { unique = false; e2.mix(e1, 0.50f); break; }
+		}
+		if (unique) { filtered.push_back(e1); }
+	}
+	return filtered;
+}
+
+/** 1 pixel wide outlines of the given ellipses */
+static ImageChannel getEdgeImage(const int w, const int h, const std::vector<Ellipse::GeometricParams>& ellipses) {
+	ImageChannel img(w, h);
+	img.zero();
+	for (const Ellipse::GeometricParams& e : ellipses) {
+		for (int i = 0; i < 2000; ++i) {
+			const Point2f p = e.getPointFor((float) i / 2000.0f * 2 * (float) M_PI);
+			const int x = (int) std::round(p.x);
+			const int y = (int) std::round(p.y);
+			if (img.contains(x, y)) {img.set(x, y, 1.0f);}
+		}
+	}
+	return img;
+}
+
+TEST(EllipseDetection, detect) {
+
+	const std::vector<Ellipse::GeometricParams> ellipses = {
+		Ellipse::GeometricParams(Point2f(80, 70), 40, 32, 0.3f),
+		Ellipse::GeometricParams(Point2f(200, 90), 30, 25, 1.1f),
+		Ellipse::GeometricParams(Point2f(120, 180), 45, 35, 2.0f),
+	};
+	ImageChannel img = getEdgeImage(280, 260, ellipses);
+
+	// some straight lines and short noise segments
+	for (int i = 0; i < 200; ++i) {img.set(20 + i, 240, 1.0f); img.set(265, 10 + i, 1.0f);}
+	for (int i = 0; i < 8; ++i) {img.set(240 + i, 200, 1.0f);}
+
+	// the drawn ellipses are found. RANSAC needs the segment's points ordered along the edge
+	EllipseDetection det;
+	det.setCombineSimilar(true);
+	const std::vector<Ellipse::GeometricParams> found = det.getFromEdgeImage(img);
+	for (const Ellipse::GeometricParams& e : ellipses) {
+		bool ok = false;
+		for (const Ellipse::GeometricParams& f : found) {
+			ok |= f.center.getDistance(e.center) < 3 && std::abs(f.a - e.a) < 3 && std::abs(f.b - e.b) < 3;
+		}
+		ASSERT_TRUE(ok);
+	}
+
+}
+
+TEST(EllipseDetection, filterDuplicates) {
+
+	// clusters of similar ellipses, some far-off ones and NaNs
+	std::minstd_rand gen(1234);
+	std::uniform_real_distribution<float> dPos(0, 640);
+	std::normal_distribution<float> dNoise(0, 6);
+	std::uniform_real_distribution<float> dAxis(20, 60);
+	std::vector<Ellipse::GeometricParams> src;
+	for (int c = 0; c < 300; ++c) {
+		const Point2f center(dPos(gen), dPos(gen));
+		const float a = dAxis(gen);
+		for (int i = 0; i < 10; ++i) {
+			src.push_back(Ellipse::GeometricParams(center + Point2f(dNoise(gen), dNoise(gen)), a + dNoise(gen) * 0.3f, a * 0.8f, 0));
+		}
+	}
+	src.push_back(Ellipse::GeometricParams(Point2f(NAN, 10), 30, 20, 0));
+	src.push_back(Ellipse::GeometricParams(Point2f(1e30f, -1e30f), 30, 20, 0));
+	src.push_back(Ellipse::GeometricParams(Point2f(1e30f, -1e30f), 31, 20, 0));
+	std::shuffle(src.begin(), src.end(), gen);
+
+	const std::vector<Ellipse::GeometricParams> ref = filterDuplicatesRef(src);
+	const std::vector<Ellipse::GeometricParams> res = EllipseDetection::filterDuplicates(src);
+	ASSERT_EQ(ref.size(), res.size());
+	for (size_t i = 0; i < ref.size(); ++i) {
+		if (ref[i].center.x != ref[i].center.x) {ASSERT_NE(res[i].center.x, res[i].center.x); continue;}
+		ASSERT_EQ(ref[i].center, res[i].center);
+		ASSERT_EQ(ref[i].a, res[i].a);
+		ASSERT_EQ(ref[i].b, res[i].b);
+	}
+
+}
+
+TEST(EllipseDetection, parallel) {
+
+	const std::vector<Ellipse::GeometricParams> ellipses = {
+		Ellipse::GeometricParams(Point2f(80, 70), 40, 32, 0.3f),
+		Ellipse::GeometricParams(Point2f(200, 90), 30, 25, 1.1f),
+	};
+	ImageChannel img = getEdgeImage(280, 260, ellipses);
+	for (int i = 0; i < 200; ++i) {img.set(20 + i, 240, 1.0f);}
+
+	EllipseDetection det;
+	det.setExecutor(TileExecutor(1, 1000));
+	const std::vector<Ellipse::GeometricParams> serial = det.getFromEdgeImage(img);
+
+	// the same result, independent of the scheduling
+	det.setExecutor(TileExecutor(3, 1));
+	const std::vector<Ellipse::GeometricParams> parallel = det.getFromEdgeImage(img);
+	ASSERT_FALSE(serial.empty());
+	ASSERT_EQ(serial.size(), parallel.size());
+	for (size_t i = 0; i < serial.size(); ++i) {
+		ASSERT_EQ(serial[i].center, parallel[i].center);
+		ASSERT_EQ(serial[i].a, parallel[i].a);
+	}
+
+	// the debug callback is not called concurrently
+	std::mutex mutex;
+	std::set<std::thread::id> threads;
+	det.getRANSAC().callback = [&] (const Ellipse::GeometricParams&) {std::lock_guard<std::mutex> lock(mutex); threads.insert(std::this_thread::get_id());};
+	ASSERT_EQ(serial.size(), det.getFromEdgeImage(img).size());
+	ASSERT_EQ(1u, threads.size());
+	det.getRANSAC().callback = nullptr;
+
+	// the early rejects are a heuristic, the drawn ellipses are not affected
+	det.setEarlyReject(false);
+	ASSERT_LE(serial.size(), det.getFromEdgeImage(img).size());
+
+}
+
+TEST(EllipseDetection, ransacSamples) {
+
+	// each sample averages 3 adjacent points, all within the list
+	const ImageChannel img = getEdgeImage(64, 64, {Ellipse::GeometricParams(Point2f(32, 32), 20, 15, 0)});
+	EllipseEstimator::RANSACPixel ransac;
+	EllipseEstimator::ImageMatchStats stats;
+	ASSERT_THROW(ransac.get(std::vector<Point2i>{Point2i(1,1), Point2i(2,2)}, img, stats, 1), Exception);
+	ransac.get(std::vector<Point2i>{Point2i(1,1), Point2i(2,2), Point2i(3,3)}, img, stats, 1);
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "../../../cv/ImageChannel.h"
 #include "../../../cv/matching/MatchingSAD.h"
 #include "../../../cv/matching/Matching.h"
+#include "../../../cv/matching/MatchingNCC.h"
 
 using namespace K;
 
@@ -50,6 +51,51 @@ TEST(MatchingSAD, refine) {
 
 
 
+}
+
+TEST(MatchingSAD, errorMap) {
+
+	ImageChannel img1(20, 15);
+	ImageChannel img2(18, 16);
+	img1.setEach([] (const int x, const int y) {return (float) ((x*7 + y*13) % 11) / 10.0f;});
+	img2.setEach([] (const int x, const int y) {return (float) ((x*5 + y*3) % 7) / 6.0f;});
+
+	MatchingSAD sad(img1, img2, 5);
+	for (const Point2i o : {Point2i(0,0), Point2i(3,-2), Point2i(-25,4)}) {
+		const ImageChannel errors = sad.getErrors(o);
+		for (int y = 0; y < img1.getHeight(); ++y) {
+			for (int x = 0; x < img1.getWidth(); ++x) {
+				ASSERT_NEAR(sad.getError(Point2i(x,y), Point2i(x,y)+o), errors.get(x,y), 1e-4);
+			}
+		}
+	}
+
+}
+
+TEST(MatchingNCC, score) {
+
+	ImageChannel img1(20, 20);
+	img1.setEach([] (const int x, const int y) {return (float) ((x*x*7 + y*y*13 + x*y) % 17) / 16.0f;});
+
+	// brightness/contrast changed copy, shifted by (2,1)
+	ImageChannel img2(20, 20);
+	img2.setEach([&] (const int x, const int y) {return 0.2f + 0.5f * img1.getClamped(x-2, y-1);});
+
+	MatchingNCC ncc(img1, img2, 5);
+	ASSERT_NEAR(1.0f, ncc.getScore(Point2i(8,8), Point2i(10,9)), 1e-4);
+	ASSERT_GT(0.9f, ncc.getScore(Point2i(8,8), Point2i(9,9)));
+
+	// windows exceeding the image
+	ASSERT_NEAR(1.0f, ncc.getScore(Point2i(3,3), Point2i(5,4)), 1e-4);
+
+	// uniform region
+	ImageChannel img3(10, 10); img3.ones();
+	MatchingNCC ncc2(img1, img3, 3);
+	ASSERT_EQ(0, ncc2.getScore(Point2i(5,5), Point2i(5,5)));
+
+	// refine towards the true shift
+	ASSERT_EQ(Point2i(10,9), Matching::refine(ncc, Point2i(8,8), Point2i(7,7)));
+
 }
 
 #endif
@@ -0,0 +1,150 @@
+#ifdef WITH_TESTS
+
+#include "../../Test.h"
+#include "../../../cv/segmentation/ConnectedComponents.h"
+#include "../../../cv/segmentation/RegionGrowing.h"
+
+using namespace K;
+
+/** random blobs: few distinct values and some gradients that chain values together */
+static ImageChannel getLabelImage(const int w, const int h) {
+	ImageChannel img = TestHelper::getPatternImage(w, h, 23);
+	for (int i = 0; i < w*h; ++i) {
+		const int r = (int) std::round(img.getData()[i] * 22);
+		img.getData()[i] = (float) (r % 4) * 0.25f + ((r > 18) ? (0.08f) : (0.0f));
+	}
+	return img;
+}
+
+/** compare against RegionGrowing, started at the first (row by row) unused pixel */
+static void checkAgainstRegionGrowing(const ImageChannel& img, const ConnectedComponents& cc, const Bitmap* excluded) {
+
+	Bitmap used(img.getWidth(), img.getHeight());
+	if (excluded) {used = *excluded;}
+
+	int label = 0;
+	for (int y = 0; y < img.getHeight(); ++y) {
+		for (int x = 0; x < img.getWidth(); ++x) {
+
+			if (used.isSet(x, y)) {
+				if (excluded && excluded->isSet(x, y)) {ASSERT_EQ(-1, cc.getLabel(x, y));}
+				continue;
+			}
+
+			const Segment<float> seg = RegionGrowing::get(img, Point2i(x, y), used, 0.1f);
+			const ConnectedComponents::Stats& s = cc.getStats(label);
+			ASSERT_EQ((int) seg.points.size(), s.area);
+			ASSERT_EQ(x, s.first.x);
+			ASSERT_EQ(y, s.first.y);
+			ASSERT_NEAR(seg.avg, s.getAvg(), 1e-4);
+
+			BBox2i bb;
+			Point2f sum(0, 0);
+			for (const Point2i& p : seg.points) {
+				ASSERT_EQ(label, cc.getLabel(p.x, p.y));
+				bb.add(p);
+				sum += Point2f((float) p.x, (float) p.y);
+			}
+			ASSERT_EQ(bb.getMin(), s.bbox.getMin());
+			ASSERT_EQ(bb.getMax(), s.bbox.getMax());
+			ASSERT_NEAR(sum.x / (float) seg.points.size(), s.getCentroid().x, 1e-3);
+			ASSERT_NEAR(sum.y / (float) seg.points.size(), s.getCentroid().y, 1e-3);
+			++label;
+
+		}
+	}
+	ASSERT_EQ(label, cc.getNumComponents());
+
+}
+
+TEST(ConnectedComponents, matchesRegionGrowing) {
+
+	const ImageChannel img = getLabelImage(57, 43);
+
+	// single band, several bands (borders to merge) and single-row bands
+	ConnectedComponents cc;
+	for (const TileExecutor& exec : {TileExecutor(1, 1000), TileExecutor(4, 5), TileExecutor(3, 1)}) {
+		cc.run(img, 0.1f, nullptr, exec);
+		checkAgainstRegionGrowing(img, cc, nullptr);
+	}
+
+}
+
+TEST(ConnectedComponents, excluded) {
+
+	const ImageChannel img = getLabelImage(40, 30);
+	Bitmap used(40, 30);
+	for (int i = 0; i < 30; ++i) {used.set(i, i); used.set(39-i, i);}
+
+	ConnectedComponents cc;
+	cc.run(img, 0.1f, &used, TileExecutor(2, 4));
+	checkAgainstRegionGrowing(img, cc, &used);
+
+}
+
+TEST(ConnectedComponents, points) {
+
+	// two diagonal lines (8-neighborhood) and the background (first pixel: (1,0))
+	ImageChannel img(10, 10);
+	img.zero();
+	for (int i = 0; i < 5; ++i) {img.set(i, i, 1); img.set(9-i, i+5, 1);}
+
+	ConnectedComponents cc;
+	cc.run(img, 0.1f);
+	ASSERT_EQ(3, cc.getNumComponents());
+	ASSERT_EQ(5, cc.getStats(0).area);
+	ASSERT_EQ(100-10, cc.getStats(1).area);
+	ASSERT_EQ(5, cc.getStats(2).area);
+	ASSERT_EQ(Point2f(2, 2), cc.getStats(0).getCentroid());
+	ASSERT_EQ(0, cc.getStats(1).getAvg());
+
+	const std::vector<std::vector<Point2i>> pts = cc.getPoints([] (const ConnectedComponents::Stats& s) {return s.getAvg() > 0;});
+	ASSERT_EQ(2u, pts.size());
+	ASSERT_EQ(Point2i(0,0), pts[0].front());
+	ASSERT_EQ(Point2i(4,4), pts[0].back());
+	ASSERT_EQ(Point2i(9,5), pts[1].front());
+	ASSERT_EQ(Point2i(5,9), pts[1].back());
+
+}
+
+/** compare getPointsTraced() against RegionGrowing, started at each unused pixel, column by column */
+static void checkTracedAgainstRegionGrowing(const ImageChannel& img, const float threshold) {
+
+	ConnectedComponents cc;
+	cc.run(img, threshold, nullptr, TileExecutor(2, 4));
+	const std::vector<std::vector<Point2i>> pts = cc.getPointsTraced(img, [] (const ConnectedComponents::Stats& s) {return s.area > 1;});
+
+	Bitmap used(img.getWidth(), img.getHeight());
+	size_t idx = 0;
+	for (int x = 0; x < img.getWidth(); ++x) {
+		for (int y = 0; y < img.getHeight(); ++y) {
+			if (used.isSet(x, y)) {continue;}
+			const Segment<float> seg = RegionGrowing::get(img, Point2i(x, y), used, threshold);
+			if (seg.points.size() <= 1) {continue;}
+			ASSERT_LT(idx, pts.size());
+			ASSERT_EQ(seg.points, pts[idx]);
+			++idx;
+		}
+	}
+	ASSERT_EQ(pts.size(), idx);
+
+}
+
+TEST(ConnectedComponents, pointsTraced) {
+
+	// same segments and point order as RegionGrowing
+	checkTracedAgainstRegionGrowing(getLabelImage(31, 27), 0.1f);
+
+	// a smooth ring: the walk must follow RegionGrowing's neighbor test, not just the label
+	ImageChannel ring(40, 36);
+	for (int y = 0; y < ring.getHeight(); ++y) {
+		for (int x = 0; x < ring.getWidth(); ++x) {
+			const float d = std::sqrt((float) ((x-20)*(x-20) + (y-18)*(y-18)));
+			ring.set(x, y, (d > 6 && d < 13) ? (0.06f * (float) (x + y)) : (0.0f));
+		}
+	}
+	checkTracedAgainstRegionGrowing(ring, 0.1f);
+
+}
+
+#endif
@@ -64,6 +64,22 @@ TEST(JSON, read_err) {
 	ASSERT_ANY_THROW(reader.parse("[,]"));
 	ASSERT_ANY_THROW(reader.parse("[],"));
 	ASSERT_ANY_THROW(reader.parse("{a:1}"));
+	ASSERT_ANY_THROW(reader.parse("{\"a"));
+	ASSERT_ANY_THROW(reader.parse("[\"abc"));
+
+}
+
+TEST(JSON, read_region) {
+
+	// the input is not null-terminated. only the first 9 bytes are valid
+	const char data[] = {'{','"','a','"',':','[','1',']','}', '#', '#'};
+
+	JSONReader reader;
+	JSONValue val = reader.parse(data, 9);
+	ASSERT_EQ(1, val.asObject()->getArray("a")->get(0).asInt());
+
+	ASSERT_ANY_THROW(reader.parse(data, 8));
+	ASSERT_ANY_THROW(reader.parse(data, 10));
 
 }
 
@@ -82,6 +98,75 @@ TEST(JSON, read) {
 	ASSERT_EQ("xyz", obj->getObject("e")->getString("abc"));
 }
 
+TEST(JSON, read_arena) {
+
+	Arena arena(1024);
+	std::stringstream ss;
+	JSONWriter writer(ss, false);
+	size_t reserved = 0;
+
+	for (int run = 0; run < 3; ++run) {
+
+		{
+			JSONReader reader(&arena);
+			JSONValue e = reader.parse("[ {\"xyz\":133.7, \"abc\":\"11\\\"1\"},	[ { }, [ {},{},{} ] ]	,	[{\"a\":true}], [{\"b\":true}, {\"b\":\"a rather long string value, not fitting into the buffer\"}] ]");
+			ss.str(""); writer.write(e);
+			ASSERT_EQ("[{\"abc\":\"11\\\"1\",\"xyz\":133.7},[{},[{},{},{}]],[{\"a\":true}],[{\"b\":true},{\"b\":\"a rather long string value, not fitting into the buffer\"}]]", ss.str());
+			ASSERT_EQ(133.7, e.asArray()->get(0).asObject()->getDouble("xyz"));
+			ASSERT_GT(arena.getNumBytesUsed(), 0);
+		}
+
+		// a failed parse leaves its partial graph within the arena only
+		const size_t used = arena.getNumBytesUsed();
+		JSONReader reader(&arena);
+		ASSERT_THROW(reader.parse("[{\"a\":[1,2,}]"), JSONReaderException);
+		ASSERT_GT(arena.getNumBytesUsed(), used);
+
+		// the whole graph is dropped at once and the blocks are reused by the next run
+		arena.reset();
+		ASSERT_EQ(0u, arena.getNumBytesUsed());
+		if (run > 0) {ASSERT_EQ(reserved, arena.getNumBytesReserved());}
+		reserved = arena.getNumBytesReserved();
+
+	}
+
+}
+
+/** counts the allocations passed on to the default resource */
+class JSONCountingResource : public std::pmr::memory_resource {
+public:
+	int numAllocs = 0;
+private:
+	void* do_allocate(size_t bytes, size_t align) override {++numAllocs; return std::pmr::new_delete_resource()->allocate(bytes, align);}
+	void do_deallocate(void* p, size_t bytes, size_t align) override {std::pmr::new_delete_resource()->deallocate(p, bytes, align);}
+	bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override {return this == &o;}
+};
+
+TEST(JSON, lookup_noalloc) {
+
+	Arena arena(1024);
+	JSONObject obj(arena.getResource());
+	const std::string key = "a key too long for the small string buffer";
+	obj.put(key, 1337L);
+	obj.put(key, 1338L);
+	const size_t used = arena.getNumBytesUsed();
+
+	// lookups neither copy the key into a temporary nor into the arena
+	JSONCountingResource counting;
+	std::pmr::memory_resource* old = std::pmr::set_default_resource(&counting);
+	const bool contained = obj.containsValue(key);
+	const int64_t val = obj.getInt(key);
+	const bool missing = obj.containsValue(key + "?");
+	std::pmr::set_default_resource(old);
+
+	ASSERT_TRUE(contained);
+	ASSERT_EQ(1338, val);
+	ASSERT_FALSE(missing);
+	ASSERT_EQ(0, counting.numAllocs);
+	ASSERT_EQ(used, arena.getNumBytesUsed());
+
+}
+
 TEST(JSON, create) {
 
 	JSONArray arr;
@@ -369,6 +369,43 @@ TEST(KDTree, remove) {
 }
 
 
+TEST(KDTree, arena) {
+
+	std::minstd_rand gen(1234);
+	std::uniform_real_distribution<float> dist(-1, +1);
+
+	KDPointCloud vals;
+	for (int i = 0; i < 10000; ++i) {
+		vals.push_back( KDPoint3(dist(gen), dist(gen), dist(gen)) );
+	}
+
+	Arena arena;
+	KDTree<CFG> heap(10, 8);
+	heap.setDataSource(&vals);
+	heap.addAll((KDIdx)vals.size());
+
+	for (int run = 0; run < 3; ++run) {
+
+		// same tree, allocated from the arena
+		{
+			KDTree<CFG> tree(10, 8, &arena);
+			tree.setDataSource(&vals);
+			tree.addAll((KDIdx)vals.size());
+			for (int i = 0; i < 100; ++i) {tree.addByID(i, true);}
+			ASSERT_EQ((int)vals.size() + 100, tree.getNumElementsBelow(tree.getRoot()));
+			ASSERT_GT(arena.getNumBytesUsed(), 0);
+
+			const float pt[3] = {0.1f, 0.2f, 0.3f};
+			ASSERT_EQ(heap.getLeafFor(pt)->entries.size(), tree.getLeafFor(pt)->entries.size());
+		}
+
+		// tear down everything at once
+		arena.reset();
+
+	}
+
+}
+
 TEST(KDTree, addManySingleNoBalance) {
 
 	KDTree<CFG> tree(10);
@@ -0,0 +1,77 @@
+
+#ifdef WITH_TESTS
+#include "../Test.h"
+#include "../../memory/Arena.h"
+
+#include <vector>
+#include <string>
+
+using namespace K;
+
+TEST(Arena, alloc) {
+
+	Arena arena(256);
+
+	// alignment is respected
+	for (int i = 0; i < 100; ++i) {
+		uint8_t* b = (uint8_t*) arena.alloc(1, 1);
+		*b = 1;
+		double* d = arena.create<double>(1.5);
+		ASSERT_EQ(0, ((uintptr_t) d) % alignof(double));
+		ASSERT_EQ(1.5, *d);
+	}
+
+	// larger than one block
+	uint8_t* big = (uint8_t*) arena.alloc(10000);
+	memset(big, 0xAB, 10000);
+	ASSERT_EQ(100 * (1 + 8) + 10000, arena.getNumBytesUsed());
+
+	// reset keeps the memory and starts over at the first block
+	const size_t reserved = arena.getNumBytesReserved();
+	uint8_t* first = (uint8_t*) arena.alloc(1, 1);
+	arena.reset();
+	ASSERT_EQ(0, arena.getNumBytesUsed());
+	ASSERT_NE(first, arena.alloc(1, 1));
+	arena.reset();
+	for (int i = 0; i < 100; ++i) {arena.alloc(16);}
+	ASSERT_EQ(reserved, arena.getNumBytesReserved());
+
+	arena.release();
+	ASSERT_EQ(0, arena.getNumBytesReserved());
+
+}
+
+static int arenaDtorCalls = 0;
+struct ArenaDtorCounter {
+	~ArenaDtorCounter() {++arenaDtorCalls;}
+};
+
+TEST(Arena, owned) {
+
+	Arena arena;
+	arenaDtorCalls = 0;
+	arena.create<ArenaDtorCounter>();
+	arena.createOwned<ArenaDtorCounter>();
+	arena.createOwned<ArenaDtorCounter>();
+	ASSERT_EQ(0, arenaDtorCalls);
+	arena.reset();
+	ASSERT_EQ(2, arenaDtorCalls);
+	arena.reset();
+	ASSERT_EQ(2, arenaDtorCalls);
+
+}
+
+TEST(Arena, pmr) {
+
+	Arena arena;
+	std::pmr::vector<int> vec(arena.getResource());
+	for (int i = 0; i < 1000; ++i) {vec.push_back(i);}
+	ASSERT_EQ(999, vec.back());
+	ASSERT_GE(arena.getNumBytesUsed(), 1000 * sizeof(int));
+
+	std::pmr::string str("a string that is too long for the small string optimization", arena.getResource());
+	ASSERT_EQ('a', str[0]);
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+
+#ifdef WITH_TESTS
+#include "../Test.h"
+#include "../../memory/ConcurrentFixedPool.h"
+
+#include <thread>
+#include <set>
+
+using namespace K;
+
+struct PoolDummy {
+	uint64_t id;
+	float val;
+};
+
+TEST(ConcurrentFixedPool, allocFree) {
+
+	ConcurrentFixedPool<PoolDummy> pool(128, 16);
+
+	// all entries are distinct
+	std::set<PoolDummy*> used;
+	for (int i = 0; i < 1000; ++i) {
+		PoolDummy* d = pool.alloc();
+		d->id = i;
+		ASSERT_TRUE(used.insert(d).second);
+	}
+
+	ConcurrentFixedPool<PoolDummy>::Stats s = pool.getStats();
+	ASSERT_EQ(1000, s.numLive);
+	ASSERT_EQ((1000 + 127) / 128, s.numChunks);
+
+	// freed entries are reused
+	PoolDummy* d = *used.begin();
+	pool.free(d);
+	ASSERT_EQ(d, pool.alloc());
+
+	for (PoolDummy* p : used) {pool.free(p);}
+	s = pool.getStats();
+	ASSERT_EQ(0, s.numLive);
+	ASSERT_EQ(1001, s.numAllocs);
+	ASSERT_GT(s.getHitRate(), 0.8);
+
+}
+
+TEST(ConcurrentFixedPool, trim) {
+
+	ConcurrentFixedPool<PoolDummy> pool(64, 8);
+
+	std::vector<PoolDummy*> used;
+	for (int i = 0; i < 640; ++i) {used.push_back(pool.alloc());}
+	ASSERT_EQ(10, pool.getStats().numChunks);
+
+	// nothing to release while everything is in use
+	ASSERT_EQ(0, pool.trim());
+
+	// keep one entry alive -> its chunk must stay
+	PoolDummy* keep = used[300];
+	keep->id = 1234;
+	for (PoolDummy* p : used) {if (p != keep) {pool.free(p);}}
+	ASSERT_EQ(9, pool.trim());
+	ASSERT_EQ(1, pool.getStats().numChunks);
+	ASSERT_EQ(1234, keep->id);
+
+	// the pool remains usable
+	std::set<PoolDummy*> again;
+	for (int i = 0; i < 200; ++i) {
+		PoolDummy* p = pool.alloc();
+		ASSERT_NE(keep, p);
+		ASSERT_TRUE(again.insert(p).second);
+	}
+	for (PoolDummy* p : again) {pool.free(p);}
+	pool.free(keep);
+	pool.trim();
+	ASSERT_EQ(0, pool.getStats().numChunks);
+
+}
+
+TEST(ConcurrentFixedPool, threads) {
+
+	ConcurrentFixedPool<PoolDummy> pool(256, 32);
+	const int numThreads = 4;
+	const int numIter = 20000;
+
+	// every thread allocates, writes, verifies and frees. half of the
+	// entries are handed to the next thread to free them there
+	std::vector<std::vector<PoolDummy*>> handOver(numThreads);
+	std::vector<std::thread> threads;
+	std::atomic<int> errors(0);
+
+	for (int t = 0; t < numThreads; ++t) {
+		threads.emplace_back([&, t] () {
+			std::vector<PoolDummy*> mine;
+			for (int i = 0; i < numIter; ++i) {
+				PoolDummy* d = pool.alloc();
+				d->id = ((uint64_t) t << 32) | (uint64_t) i;
+				mine.push_back(d);
+				if (mine.size() > 100) {
+					for (PoolDummy* p : mine) {
+						if ((p->id >> 32) != (uint64_t) t) {++errors;}
+						pool.free(p);
+					}
+					mine.clear();
+				}
+			}
+			handOver[(t + 1) % numThreads] = mine;
+		});
+	}
+	for (std::thread& t : threads) {t.join();}
+	ASSERT_EQ(0, errors);
+
+	// free entries allocated by other threads
+	threads.clear();
+	for (int t = 0; t < numThreads; ++t) {
+		threads.emplace_back([&, t] () {
+			for (PoolDummy* p : handOver[t]) {pool.free(p);}
+		});
+	}
+	for (std::thread& t : threads) {t.join();}
+
+	ConcurrentFixedPool<PoolDummy>::Stats s = pool.getStats();
+	ASSERT_EQ(0, s.numLive);
+	ASSERT_EQ((uint64_t) numThreads * numIter, s.numAllocs);
+
+	// all threads are gone: their caches are adopted and everything is released
+	pool.trim();
+	ASSERT_EQ(0, pool.getStats().numChunks);
+	ASSERT_EQ((uint64_t) numThreads * numIter, pool.getStats().numAllocs);
+
+}
+
+#endif
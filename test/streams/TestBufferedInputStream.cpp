@@ -65,4 +65,57 @@ TEST(BufferedInputStream, readBlocks) {
 
 }
 
+TEST(BufferedInputStream, borrow) {
+
+	const char* data = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam";
+	unsigned int len = (unsigned int)  strlen(data);
+
+	for (unsigned int size = 1; size < 127; ++size) {
+
+		ByteArrayInputStream bais((uint8_t*) data, len);
+		BufferedInputStream bis(&bais, size);
+
+		// alternate between borrowing and reading
+		unsigned int pos = 0;
+		uint8_t buf[7];
+		while (pos < len) {
+
+			const uint8_t* ptr;
+			const ssize_t borrowed = bis.borrow(ptr, 5);
+			ASSERT_TRUE(borrowed > 0);
+			ASSERT_TRUE(borrowed <= 5);
+			ASSERT_BYTE_EQ(data+pos, ptr, borrowed);
+			pos += (unsigned int) borrowed;
+
+			if (pos == len) {break;}
+			const ssize_t read = bis.read(buf, 7);
+			ASSERT_TRUE(read > 0);
+			ASSERT_BYTE_EQ(data+pos, buf, read);
+			pos += (unsigned int) read;
+
+		}
+
+		const uint8_t* ptr;
+		ASSERT_EQ(-1, bis.borrow(ptr, 5));
+
+	}
+
+}
+
+TEST(BufferedInputStream, skip) {
+
+	const char* data = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam";
+	unsigned int len = (unsigned int)  strlen(data);
+
+	ByteArrayInputStream bais((uint8_t*) data, len);
+	BufferedInputStream bis(&bais, 8);
+
+	ASSERT_EQ('L', bis.read());
+	bis.skip(5);
+	ASSERT_EQ('i', bis.read());
+	bis.skip(20);
+	ASSERT_EQ(data[27], bis.read());
+
+}
+
 #endif
@@ -55,4 +55,25 @@ TEST(ByteArrayInputStream, readBlocks) {
 }
 
 
+TEST(ByteArrayInputStream, borrow) {
+
+	const char* data = "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam";
+	size_t len = strlen(data);
+	ByteArrayInputStream bais((uint8_t*) data, (unsigned int) len);
+
+	// borrowing returns pointers into the source array
+	const uint8_t* ptr;
+	ASSERT_EQ(11, bais.borrow(ptr, 11));
+	ASSERT_EQ((const uint8_t*) data, ptr);
+	ASSERT_EQ(11, bais.borrow(ptr, 11));
+	ASSERT_EQ((const uint8_t*) data + 11, ptr);
+
+	ASSERT_EQ(43, bais.borrow(ptr, 100));
+	ASSERT_EQ((const uint8_t*) data + 22, ptr);
+
+	ASSERT_EQ(-1, bais.borrow(ptr, 100));
+
+}
+
+
 #endif
@@ -14,6 +14,9 @@
 #include "../../streams/DataInputStream.h"
 #include "../../streams/ByteArrayInOutStream.h"
 
+#include <vector>
+#include <algorithm>
+
 using namespace K;
 
 
@@ -61,4 +64,83 @@ TEST(DataStream, skip) {
 
 
 
+TEST(DataStream, endianArray) {
+
+	// odd lengths to cover the SIMD blocks and the scalar tail
+	for (size_t num : {1, 7, 8, 15, 16, 33, 1000}) {
+
+		std::vector<uint16_t> v16(num);	for (size_t i = 0; i < num; ++i) {v16[i] = (uint16_t) (i * 2654435761u);}
+		std::vector<uint32_t> v32(num);	for (size_t i = 0; i < num; ++i) {v32[i] = (uint32_t) (i * 2654435761u);}
+		std::vector<uint64_t> v64(num);	for (size_t i = 0; i < num; ++i) {v64[i] = (uint64_t) i * 0x9E3779B97F4A7C15ull;}
+
+		std::vector<uint16_t> s16(num);	Endian::swapArray(v16.data(), s16.data(), num, 2);
+		std::vector<uint32_t> s32(num);	Endian::swapArray(v32.data(), s32.data(), num, 4);
+		std::vector<uint64_t> s64(num);	Endian::swapArray(v64.data(), s64.data(), num, 8);
+
+		for (size_t i = 0; i < num; ++i) {
+			ASSERT_EQ(K_SWAP_16(v16[i]), s16[i]);
+			ASSERT_EQ(K_SWAP_32(v32[i]), s32[i]);
+			ASSERT_EQ(K_SWAP_64(v64[i]), s64[i]);
+		}
+
+		// in-place twice = identity
+		Endian::swapArray(s32.data(), s32.data(), num, 4);
+		ASSERT_EQ(v32, s32);
+
+	}
+
+}
+
+TEST(DataStream, readWriteArray) {
+
+	const size_t num = 5000;
+	std::vector<int16_t> shorts(num);
+	std::vector<float> floats(num);
+	std::vector<double> doubles(num);
+	for (size_t i = 0; i < num; ++i) {
+		shorts[i] = (int16_t) (i * 31 - 20000);
+		floats[i] = (float) i * 1.337f;
+		doubles[i] = (double) i * -13.37;
+	}
+
+	for (ByteOrder order : {ByteOrder::LITTLE, ByteOrder::BIG}) {
+
+		ByteArrayInOutStream baios;
+		DataOutputStream dos(baios);
+		DataInputStream dis(baios);
+
+		dos.writeArray(shorts.data(), num, order);
+		dos.writeArray(floats.data(), num, order);
+		dos.writeArray(doubles.data(), num, order);
+
+		// check the wire format of the first value
+		if (order == ByteOrder::BIG) {
+			uint8_t p[2];
+			ASSERT_EQ(2, dis.readFully(p, 2));
+			ASSERT_EQ((uint8_t) ((uint16_t) shorts[0] >> 8), p[0]);
+			ASSERT_EQ((uint8_t) ((uint16_t) shorts[0] >> 0), p[1]);
+			std::vector<int16_t> rest(num - 1);
+			dis.readArray(rest.data(), num - 1, order);
+			ASSERT_TRUE(std::equal(rest.begin(), rest.end(), shorts.begin() + 1));
+		} else {
+			std::vector<int16_t> s(num);
+			dis.readArray(s.data(), num, order);
+			ASSERT_EQ(shorts, s);
+		}
+
+		std::vector<float> f(num);
+		dis.readArray(f.data(), num, order);
+		ASSERT_EQ(floats, f);
+
+		std::vector<double> d(num);
+		dis.readArray(d.data(), num, order);
+		ASSERT_EQ(doubles, d);
+
+		// not enough data left
+		ASSERT_THROW(dis.readArray(d.data(), 1, order), StreamException);
+
+	}
+
+}
+
 #endif
@@ -22,6 +22,9 @@
 #include "../../streams/BufferedInputStream.h"
 #include "../../streams/BufferedOutputStream.h"
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <random>
 
 using namespace K;
 
@@ -272,6 +275,117 @@ TEST(GzipStream, compressDecompressFlush) {
 
 }
 
+
+/** compress the given data in parallel mode and ensure GzipInputStream restores it */
+static void checkParallel(const std::vector<uint8_t>& src, GzipOutputStreamHeader header, const GzipParallelSettings& par, const size_t writeSize) {
+
+	ByteArrayOutputStream baos;
+	GzipOutputStream gos(baos, header, 6, par);
+	for (size_t i = 0; i < src.size(); i += writeSize) {
+		const size_t len = (src.size() - i < writeSize) ? (src.size() - i) : (writeSize);
+		gos.write(src.data() + i, len);
+	}
+	gos.close();
+
+	ByteArrayInputStream bais(baos.getData(), baos.getDataLength());
+	GzipInputStream gis(bais, header);
+	std::vector<uint8_t> dst(src.size() + 16);
+	const ssize_t read = (src.empty()) ? (gis.read(dst.data(), 16)) : (gis.readFully(dst.data(), src.size()));
+	ASSERT_EQ((src.empty()) ? (-1) : ((ssize_t) src.size()), read);
+	ASSERT_EQ(-1, gis.read());
+	ASSERT_TRUE(std::equal(src.begin(), src.end(), dst.begin()));
+
+}
+
+TEST(GzipStream, parallel) {
+
+	// compressible text plus some random noise
+	std::vector<uint8_t> src;
+	const std::string str = TestHelper::getLoremIpsum();
+	for (int i = 0; i < 2000; ++i) {
+		src.insert(src.end(), str.begin(), str.end());
+		if (i % 7 == 0) {src.push_back((uint8_t) ::rand());}
+	}
+
+	for (GzipOutputStreamHeader header : {GzipOutputStreamHeader::MODE_GZIP, GzipOutputStreamHeader::MODE_DEFLATE}) {
+
+		// default settings
+		checkParallel(src, header, GzipParallelSettings(), 4096);
+
+		// blocks smaller than the dictionary, several batches, odd write sizes
+		GzipParallelSettings par;
+		par.blockSize = 10000;
+		par.numParallel = 3;
+		checkParallel(src, header, par, 1337);
+		checkParallel(src, header, par, src.size());
+
+		// empty input still yields a valid stream
+		checkParallel(std::vector<uint8_t>(), header, par, 1);
+
+	}
+
+}
+
+TEST(GzipStream, parallelRatio) {
+
+	// priming each block with its predecessor's tail keeps the ratio close to single-threaded
+	std::vector<uint8_t> src;
+	const std::string str = TestHelper::getLoremIpsum();
+	std::minstd_rand gen(1234);
+	while (src.size() < 1024*1024) {
+		src.insert(src.end(), str.begin(), str.end());
+		for (int i = 0; i < 8; ++i) {src.push_back((uint8_t) gen());}
+	}
+
+	ByteArrayOutputStream serial;
+	GzipOutputStream gos1(serial, GzipOutputStreamHeader::MODE_GZIP, 6);
+	gos1.write(src.data(), src.size());
+	gos1.close();
+
+	ByteArrayOutputStream parallel;
+	GzipOutputStream gos2(parallel, GzipOutputStreamHeader::MODE_GZIP, 6, GzipParallelSettings());
+	gos2.write(src.data(), src.size());
+	gos2.close();
+
+	// the parallel output is valid
+	ByteArrayInputStream bais(parallel.getData(), parallel.getDataLength());
+	GzipInputStream gis(bais, GzipOutputStreamHeader::MODE_GZIP);
+	std::vector<uint8_t> dst(src.size());
+	ASSERT_EQ((ssize_t) src.size(), gis.readFully(dst.data(), dst.size()));
+	ASSERT_EQ(-1, gis.read());
+	ASSERT_EQ(src, dst);
+
+	// and at most 5% larger
+	ASSERT_LE((double) parallel.getDataLength(), (double) serial.getDataLength() * 1.05);
+
+}
+
+TEST(GzipStream, parallelFlush) {
+
+	ByteArrayInOutStream baios;
+	GzipParallelSettings par;
+	par.blockSize = 1000;
+	GzipOutputStream gos(baios, GzipOutputStreamHeader::MODE_GZIP, Z_DEFAULT_COMPRESSION, par);
+	GzipInputStream gis(baios, GzipOutputStreamHeader::MODE_GZIP);
+
+	for (unsigned int i = 0; i < 16; ++i) {
+
+		std::string srcStr = TestHelper::getLoremIpsum();
+		uint8_t* srcData = (uint8_t*) srcStr.data();
+		unsigned int len = (unsigned int) srcStr.length();
+
+		// every flush ends on a byte boundary -> everything is readable
+		gos.write(srcData, len);
+		gos.flush();
+
+		uint8_t buf[len];
+		ASSERT_EQ(len, gis.readFully(buf, len));
+		ASSERT_BYTE_EQ(srcData, buf, (int) len);
+
+	}
+
+}
+
 #endif
 
 #endif
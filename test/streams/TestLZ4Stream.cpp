@@ -12,6 +12,8 @@
 #include "../Test.h"
 #include "../../streams/LZ4OutputStream.h"
 #include "../../streams/LZ4InputStream.h"
+#include "../../streams/LZ4SeekableInputStream.h"
+#include "../../streams/FileOutputStream.h"
 #include "../../streams/ByteArrayOutputStream.h"
 #include "../../streams/ByteArrayInputStream.h"
 using namespace K;
@@ -74,4 +76,193 @@ TEST(LZ4Stream, compressDecompress) {
 }
 
 
+TEST(LZ4Stream, xxh32) {
+
+	// reference values
+	ASSERT_EQ(0x02CC5D05u, XXH32::hash(nullptr, 0));
+	ASSERT_EQ(0x32D153FFu, XXH32::hash((const uint8_t*) "abc", 3));
+
+	// streaming equals one-shot
+	std::string lipsum = TestHelper::getLoremIpsum();
+	XXH32 x;
+	for (size_t i = 0; i < lipsum.size(); i += 7) {
+		x.update((const uint8_t*) lipsum.data() + i, (lipsum.size() - i < 7) ? (lipsum.size() - i) : (7));
+	}
+	ASSERT_EQ(XXH32::hash((const uint8_t*) lipsum.data(), lipsum.size()), x.digest());
+
+}
+
+TEST(LZ4Stream, frameCompressDecompress) {
+
+	// demo text followed by some random (incompressible) data
+	std::string data = TestHelper::getLoremIpsum(64);
+	for (int i = 0; i < 100000; ++i) {data += (char) rand();}
+	const uint8_t* src = (const uint8_t*) data.data();
+
+	for (unsigned int numParallel = 1; numParallel <= 4; ++numParallel) {
+		for (int checksums = 0; checksums <= 1; ++checksums) {
+
+			LZ4FrameSettings settings;
+			settings.blockSize = LZ4Frame::BlockSize::KB_64;
+			settings.numParallel = numParallel;
+			settings.contentChecksum = checksums;
+			settings.blockChecksum = checksums;
+
+			ByteArrayOutputStream baos;
+			LZ4OutputStream los(baos, settings);
+			los.write(src, 1000);
+			los.flush();
+			los.write(src + 1000, data.size() - 1000);
+			los.close();
+
+			// standard frame magic
+			ASSERT_EQ(LZ4Frame::MAGIC, LZ4Frame::read32(baos.getData()));
+			ASSERT_TRUE(baos.getDataLength() < data.size());
+
+			ByteArrayInputStream bais(baos.getData(), baos.getDataLength());
+			LZ4InputStream lis(bais, numParallel);
+
+			uint8_t buf[3000];
+			size_t cnt = 0;
+			while(true) {
+				const ssize_t read = lis.read(buf, 3000);
+				if (read == -1) {break;}
+				ASSERT_EQ(0, memcmp(src + cnt, buf, read));
+				cnt += read;
+			}
+			ASSERT_EQ(data.size(), cnt);
+
+		}
+	}
+
+}
+
+TEST(LZ4Stream, frameCorrupted) {
+
+	std::string data = TestHelper::getLoremIpsum(4);
+
+	LZ4FrameSettings settings;
+	ByteArrayOutputStream baos;
+	LZ4OutputStream los(baos, settings);
+	los.write((const uint8_t*) data.data(), data.size());
+	los.close();
+
+	// flip one byte of the content checksum
+	std::vector<uint8_t> comp(baos.getData(), baos.getData() + baos.getDataLength());
+	comp.back() ^= 0xFF;
+
+	ByteArrayInputStream bais(comp.data(), comp.size());
+	LZ4InputStream lis(bais);
+	uint8_t buf[1024];
+	ASSERT_THROW(while (lis.read(buf, 1024) != -1) {;}, StreamException);
+
+}
+
+TEST(LZ4Stream, frameEmpty) {
+
+	LZ4FrameSettings settings;
+	ByteArrayOutputStream baos;
+	LZ4OutputStream los(baos, settings);
+	los.close();
+
+	ByteArrayInputStream bais(baos.getData(), baos.getDataLength());
+	LZ4InputStream lis(bais);
+	ASSERT_EQ(-1, lis.read());
+
+}
+
+TEST(LZ4Stream, frameBlockIndex) {
+
+	std::string data = TestHelper::getLoremIpsum(256);
+	for (int i = 0; i < 50000; ++i) {data += (char) rand();}
+	const uint8_t* src = (const uint8_t*) data.data();
+
+	LZ4FrameSettings settings;
+	settings.blockSize = LZ4Frame::BlockSize::KB_64;
+	settings.numParallel = 3;
+	settings.blockChecksum = true;
+	settings.blockIndex = true;
+
+	// the flush yields one short block in between
+	ByteArrayOutputStream baos;
+	LZ4OutputStream los(baos, settings);
+	los.write(src, 1000);
+	los.flush();
+	los.write(src + 1000, data.size() - 1000);
+	los.close();
+
+	// sequential readers skip the index
+	{
+		ByteArrayInputStream bais(baos.getData(), baos.getDataLength());
+		LZ4InputStream lis(bais);
+		std::vector<uint8_t> buf(data.size());
+		ASSERT_EQ((ssize_t) data.size(), lis.readFully(buf.data(), data.size()));
+		ASSERT_EQ(-1, lis.read());
+		ASSERT_EQ(0, memcmp(src, buf.data(), data.size()));
+	}
+
+	LZ4SeekableInputStream lsis(baos.getData(), baos.getDataLength());
+	ASSERT_EQ(data.size(), lsis.getLength());
+	ASSERT_EQ(1 + (data.size() - 1000 + 65535) / 65536, lsis.getNumBlocks());
+
+	// random windows
+	uint8_t buf[5000];
+	for (int i = 0; i < 100; ++i) {
+		const size_t offset = rand() % data.size();
+		lsis.seek(offset);
+		const ssize_t read = lsis.readFully(buf, 5000);
+		ASSERT_EQ((ssize_t) std::min((size_t) 5000, data.size() - offset), read);
+		ASSERT_EQ(0, memcmp(src + offset, buf, read));
+		ASSERT_EQ(offset + read, lsis.getPosition());
+	}
+
+	// single bytes across block boundaries
+	lsis.seek(65536 + 1000 - 2);
+	for (size_t i = 65536 + 1000 - 2; i < 65536 + 1000 + 2; ++i) {
+		ASSERT_EQ(src[i], lsis.read());
+	}
+
+	lsis.seek(0);
+	lsis.skip(999);
+	ASSERT_EQ(src[999], lsis.read());
+	ASSERT_EQ(src[1000], lsis.read());
+
+	lsis.seek(data.size());
+	ASSERT_EQ(-1, lsis.read());
+	ASSERT_THROW(lsis.seek(data.size() + 1), StreamException);
+
+}
+
+TEST(LZ4Stream, frameBlockIndexFile) {
+
+	const std::string file = getTempFile("indexed.lz4");
+	const std::string data = TestHelper::getLoremIpsum(64);
+
+	LZ4FrameSettings settings;
+	settings.blockSize = LZ4Frame::BlockSize::KB_64;
+	settings.blockIndex = true;
+	FileOutputStream fos(file);
+	LZ4OutputStream los(fos, settings);
+	los.write((const uint8_t*) data.data(), data.size());
+	los.close();
+
+	LZ4SeekableInputStream lsis(file);
+	ASSERT_EQ(data.size(), lsis.getLength());
+	lsis.seek(data.size() / 2);
+	ASSERT_EQ(data[data.size() / 2], lsis.read());
+
+}
+
+TEST(LZ4Stream, frameWithoutBlockIndex) {
+
+	LZ4FrameSettings settings;
+	ByteArrayOutputStream baos;
+	LZ4OutputStream los(baos, settings);
+	los.write((const uint8_t*) "test", 4);
+	los.close();
+
+	ASSERT_THROW(LZ4SeekableInputStream(baos.getData(), baos.getDataLength()), StreamException);
+
+}
+
 #endif
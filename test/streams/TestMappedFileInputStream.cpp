@@ -0,0 +1,64 @@
+
+#ifdef WITH_TESTS
+#include "../Test.h"
+#include "../../streams/MappedFileInputStream.h"
+#include "../../streams/FileOutputStream.h"
+
+using namespace K;
+
+TEST(MappedFileInputStream, read) {
+
+	const std::string file = getTempFile("mapped.txt");
+	const std::string data = TestHelper::getLoremIpsum();
+
+	FileOutputStream fos(file);
+	fos.write((const uint8_t*) data.data(), data.length());
+	fos.close();
+
+	MappedFileInputStream mfis(file);
+	ASSERT_EQ(data.length(), mfis.getLength());
+	ASSERT_EQ(0, memcmp(data.data(), mfis.getData(), data.length()));
+
+	// single bytes
+	ASSERT_EQ(data[0], mfis.peek());
+	ASSERT_EQ(data[0], mfis.read());
+	ASSERT_EQ(data[1], mfis.read());
+
+	// blocks
+	uint8_t buf[11];
+	ASSERT_EQ(11, mfis.read(buf, 11));
+	ASSERT_BYTE_EQ(data.data() + 2, buf, 11);
+
+	// zero-copy: pointer into the mapped file
+	const uint8_t* ptr;
+	ASSERT_EQ(20, mfis.borrow(ptr, 20));
+	ASSERT_EQ(mfis.getData() + 13, ptr);
+
+	mfis.skip(100);
+	ASSERT_EQ(133, mfis.getPosition());
+	ASSERT_EQ(data[133], mfis.read());
+
+	// everything else
+	const ssize_t rest = (ssize_t) mfis.getNumAvailable();
+	ASSERT_EQ(rest, mfis.borrow(ptr, data.length()));
+	ASSERT_EQ(-1, mfis.borrow(ptr, 1));
+	ASSERT_EQ(-1, mfis.read());
+
+	mfis.seek(0);
+	ASSERT_EQ(data[0], mfis.read());
+
+}
+
+TEST(MappedFileInputStream, empty) {
+
+	const std::string file = getTempFile("mapped_empty.txt");
+	FileOutputStream fos(file);
+	fos.close();
+
+	MappedFileInputStream mfis(file);
+	ASSERT_EQ(0, mfis.getLength());
+	ASSERT_EQ(-1, mfis.read());
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifdef WITH_TESTS
+#include "../Test.h"
+#include "../../streams/ByteArrayInputStream.h"
+#include "../../streams/ReadAheadInputStream.h"
+
+#include <vector>
+
+using namespace K;
+
+static std::vector<uint8_t> getReadAheadData(const size_t len) {
+	std::vector<uint8_t> data(len);
+	for (size_t i = 0; i < len; ++i) {data[i] = (uint8_t) (i * 31 + i / 7);}
+	return data;
+}
+
+/** stream throwing after some bytes */
+class ReadAheadFailingStream : public InputStream {
+	size_t left;
+public:
+	ReadAheadFailingStream(const size_t left) : left(left) {;}
+	void skip(const size_t n) override {uint8_t b; for (size_t i = 0; i < n; ++i) {read(&b, 1);}}
+	int read() override {uint8_t b; return (read(&b, 1) == 1) ? (b) : (-1);}
+	ssize_t read(uint8_t* data, const size_t len) override {
+		if (left == 0) {throw StreamException("failed");}
+		const size_t num = (len < left) ? (len) : (left);
+		memset(data, 1, num);
+		left -= num;
+		return num;
+	}
+	void close() override {;}
+};
+
+/** stream having nothing available (returns 0) during its first milliseconds */
+class ReadAheadSlowStream : public InputStream {
+	const std::vector<uint8_t>& data;
+	const std::chrono::steady_clock::time_point start;
+	size_t pos = 0;
+public:
+	std::atomic<int> numReads{0};
+	ReadAheadSlowStream(const std::vector<uint8_t>& data) : data(data), start(std::chrono::steady_clock::now()) {;}
+	void skip(const size_t n) override {pos += n;}
+	int read() override {uint8_t b; return (read(&b, 1) == 1) ? (b) : (-1);}
+	ssize_t read(uint8_t* dst, const size_t len) override {
+		++numReads;
+		if (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50)) {return 0;}
+		if (pos == data.size()) {return ERR_FAILED;}
+		const size_t num = (len < data.size() - pos) ? (len) : (data.size() - pos);
+		memcpy(dst, data.data() + pos, num);
+		pos += num;
+		return (ssize_t) num;
+	}
+	void close() override {;}
+};
+
+/** stream delivering some bytes, then nothing (ERR_TRY_AGAIN) until released */
+class ReadAheadTrickleStream : public InputStream {
+	bool first = true;
+public:
+	std::atomic<bool> released{false};
+	void skip(const size_t n) override {uint8_t b; for (size_t i = 0; i < n; ++i) {read(&b, 1);}}
+	int read() override {uint8_t b; return (read(&b, 1) == 1) ? (b) : (-1);}
+	ssize_t read(uint8_t* data, const size_t len) override {
+		if (first) {first = false; memset(data, 7, 100); (void) len; return 100;}
+		return (released) ? (ERR_FAILED) : (ERR_TRY_AGAIN);
+	}
+	void close() override {;}
+};
+
+TEST(ReadAheadInputStream, read) {
+
+	const std::vector<uint8_t> data = getReadAheadData(100000);
+	ByteArrayInputStream bais(data.data(), data.size());
+	ReadAheadInputStream rais(bais, 1000, 3);
+
+	// single bytes
+	for (size_t i = 0; i < 10; ++i) {ASSERT_EQ(data[i], rais.read());}
+
+	// odd sized blocks across buffer borders
+	std::vector<uint8_t> out(data.begin(), data.begin() + 10);
+	uint8_t buf[777];
+	ssize_t num;
+	while ((num = rais.read(buf, sizeof(buf))) > 0) {out.insert(out.end(), buf, buf + num);}
+
+	ASSERT_EQ(-1, num);
+	ASSERT_EQ(-1, rais.read());
+	ASSERT_EQ(data, out);
+	ASSERT_EQ(100u, rais.getStats().numFilled);
+
+}
+
+TEST(ReadAheadInputStream, borrowAndSkip) {
+
+	const std::vector<uint8_t> data = getReadAheadData(10000);
+	ByteArrayInputStream bais(data.data(), data.size());
+	ReadAheadInputStream rais(bais, 1024, 2);
+
+	const uint8_t* ptr = nullptr;
+	ASSERT_EQ(100, rais.borrow(ptr, 100));
+	ASSERT_BYTE_EQ(data.data(), ptr, 100);
+
+	// limited to the current buffer
+	ASSERT_EQ(924, rais.borrow(ptr, 5000));
+	ASSERT_BYTE_EQ(data.data() + 100, ptr, 924);
+
+	rais.skip(3000);
+	ASSERT_EQ(data[4024], rais.read());
+
+	rais.skip(10000 - 4025);
+	ASSERT_EQ(-1, rais.read());
+	ASSERT_THROW(rais.skip(1), StreamException);
+
+}
+
+TEST(ReadAheadInputStream, nothingAvailable) {
+
+	const std::vector<uint8_t> data = getReadAheadData(5000);
+	ReadAheadSlowStream slow(data);
+	ReadAheadInputStream rais(slow, 1024, 2);
+
+	std::vector<uint8_t> out(data.size());
+	ASSERT_EQ((ssize_t) data.size(), rais.readFully(out.data(), out.size()));
+	ASSERT_EQ(data, out);
+
+	// the background thread waited instead of polling the stream in a busy loop
+	ASSERT_LT(slow.numReads.load(), 500);
+
+}
+
+TEST(ReadAheadInputStream, partial) {
+
+	// the consumer gets the available bytes without waiting for a full buffer
+	ReadAheadTrickleStream ts;
+	ReadAheadInputStream rais(ts, 4096, 2);
+	uint8_t buf[4096];
+	ASSERT_EQ(100, rais.read(buf, sizeof(buf)));
+	ASSERT_EQ(7, buf[99]);
+
+	ts.released = true;
+	ASSERT_EQ(-1, rais.read(buf, sizeof(buf)));
+
+}
+
+TEST(ReadAheadInputStream, error) {
+
+	ReadAheadFailingStream fs(2500);
+	ReadAheadInputStream rais(fs, 1000, 4);
+
+	// data before the error is delivered, then the error is re-thrown
+	uint8_t buf[1000];
+	ASSERT_EQ(1000, rais.read(buf, 1000));
+	ASSERT_EQ(1000, rais.read(buf, 1000));
+	ASSERT_EQ(500, rais.read(buf, 1000));
+	ASSERT_THROW(rais.read(buf, 1000), StreamException);
+
+}
+
+TEST(ReadAheadInputStream, closeEarly) {
+
+	const std::vector<uint8_t> data = getReadAheadData(1000000);
+
+	// background thread blocked on a full queue must stop
+	for (int i = 0; i < 10; ++i) {
+		ByteArrayInputStream bais(data.data(), data.size());
+		ReadAheadInputStream rais(bais, 4096, 2);
+		ASSERT_EQ(data[0], rais.read());
+		rais.close();
+		ASSERT_EQ(-1, rais.read());
+	}
+
+	// destruction without close
+	ByteArrayInputStream bais(data.data(), data.size());
+	{ReadAheadInputStream rais(bais, 4096, 4);}
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+
+#ifdef WITH_TESTS
+#include "../Test.h"
+#include <cstdint>
+#include "../../streams/RingBuffer.h"
+
+using namespace K;
+
+TEST(RingBuffer, insertByte) {
+
+	RingBuffer<uint8_t> buf;
+	for (unsigned int i = 0; i < 1024; ++i) {
+		buf.add((uint8_t) i);
+	}
+
+	ASSERT_EQ(1024, buf.getNumUsed());
+	ASSERT_EQ(1024, buf.getSize());
+
+	for (unsigned int i = 0; i < 1024; ++i) {
+		ASSERT_EQ((uint8_t)i, buf[i]);
+	}
+
+}
+
+TEST(RingBuffer, powerOfTwo) {
+
+	RingBuffer<int> buf(100);
+	ASSERT_EQ(128, buf.getSize());
+	ASSERT_EQ(128*sizeof(int), buf.getMemoryConsumption());
+
+}
+
+TEST(RingBuffer, wrapAround) {
+
+	RingBuffer<uint16_t> buf(16);
+	uint16_t in[16];
+	uint16_t out[16];
+	uint16_t next = 0;
+	uint16_t expected = 0;
+
+	// some backlog
+	for (size_t j = 0; j < 4; ++j) {buf.add(next++);}
+
+	// steady producer/consumer: the buffer must neither grow nor lose data
+	for (unsigned int i = 0; i < 1000; ++i) {
+
+		const size_t numIn = 1 + (i % 11);
+		for (size_t j = 0; j < numIn; ++j) {in[j] = next++;}
+		buf.add(in, numIn);
+
+		const size_t numOut = buf.get(out, numIn);
+		ASSERT_EQ(numIn, numOut);
+		for (size_t j = 0; j < numOut; ++j) {ASSERT_EQ(expected++, out[j]);}
+
+		// spans cover the whole used region
+		RingBuffer<uint16_t>::Span s1, s2;
+		buf.getReadSpans(s1, s2);
+		ASSERT_EQ(buf.getNumUsed(), s1.len + s2.len);
+		for (size_t j = 0; j < s1.len; ++j) {ASSERT_EQ((uint16_t)(expected + j), s1.data[j]);}
+		for (size_t j = 0; j < s2.len; ++j) {ASSERT_EQ((uint16_t)(expected + s1.len + j), s2.data[j]);}
+
+	}
+
+	ASSERT_EQ(16, buf.getSize());
+
+}
+
+TEST(RingBuffer, commit) {
+
+	RingBuffer<uint8_t> buf(16);
+
+	// move the write position near the end
+	uint8_t tmp[12] = {0};
+	buf.add(tmp, 12);
+	buf.remove(12);
+
+	// the free region wraps around
+	RingBuffer<uint8_t>::Span s1, s2;
+	buf.getWriteSpans(s1, s2);
+	ASSERT_EQ(4, s1.len);
+	ASSERT_EQ(12, s2.len);
+
+	for (size_t i = 0; i < s1.len; ++i) {s1.data[i] = (uint8_t) i;}
+	for (size_t i = 0; i < s2.len; ++i) {s2.data[i] = (uint8_t) (s1.len + i);}
+	buf.commit(16);
+
+	ASSERT_EQ(16, buf.getNumUsed());
+	ASSERT_EQ(0, buf.getNumFree());
+	for (unsigned int i = 0; i < 16; ++i) {ASSERT_EQ(i, buf.get());}
+
+}
+
+TEST(RingBuffer, growKeepsContent) {
+
+	RingBuffer<uint8_t> buf(16);
+	uint8_t tmp[10] = {0};
+	buf.add(tmp, 10);
+	buf.remove(10);
+
+	// wrapped content must survive growing
+	for (unsigned int i = 0; i < 100; ++i) {buf.add((uint8_t) i);}
+	for (unsigned int i = 0; i < 100; ++i) {ASSERT_EQ(i, buf.get());}
+	ASSERT_TRUE(buf.empty());
+
+}
+
+#ifdef __linux__
+TEST(RingBuffer, mirrored) {
+
+	RingBuffer<uint8_t> buf(1, true);
+	const size_t size = buf.getSize();
+	ASSERT_TRUE(size >= 4096);
+
+	// move near the end, then write across the boundary
+	std::vector<uint8_t> tmp(size - 10);
+	buf.add(tmp.data(), tmp.size());
+	buf.remove(tmp.size());
+	for (unsigned int i = 0; i < 100; ++i) {buf.add((uint8_t) i);}
+
+	// the used region is contiguous nevertheless
+	RingBuffer<uint8_t>::Span s1, s2;
+	buf.getReadSpans(s1, s2);
+	ASSERT_EQ(100, s1.len);
+	ASSERT_EQ(0, s2.len);
+	for (unsigned int i = 0; i < 100; ++i) {ASSERT_EQ(i, buf.getData()[i]);}
+
+}
+#endif
+
+#endif